@@ -34,12 +34,21 @@ public:
 		m_created = System::time();		// Capture the time at which this was created
 	}
 
-	bool draw(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer) {
+	/** Whether the text has timed out as of the time provided */
+	bool expired(RealTime now) const {
+		return static_cast<float>(now - m_created) > m_timeout;
+	}
+
+	/** Draw the text as of the time provided (e.g. the time of a delayed state), returns false once it has timed out */
+	bool draw(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, RealTime now = System::time()) {
 		// Abort if the timeout has expired (return false to remove this combat text from the tracked array)
-		float time_existing = static_cast<float>(System::time() - m_created);
+		float time_existing = static_cast<float>(now - m_created);
 		if (time_existing > m_timeout) {
 			return false;
 		}
+		if (time_existing < 0.0f) {
+			return true;							// Created after the (delayed) time being drawn
+		}
 
 		// Project entity position into image space
 		Rect2D viewport = Rect2D(framebuffer.vector2Bounds());
@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+
+/** A value that is shared between copies until one of them is modified
+
+	Copying a CopyOnWrite only copies a pointer, the value itself is only copied the first time a (shared) copy is
+	accessed through a non-const reference. Read through a const reference (or get()) to avoid detaching the value.
+*/
+template <class T>
+class CopyOnWrite {
+protected:
+	std::shared_ptr<T>	m_value;
+
+public:
+	CopyOnWrite() : m_value(std::make_shared<T>()) {}
+	CopyOnWrite(const T& value) : m_value(std::make_shared<T>(value)) {}
+
+	CopyOnWrite& operator=(const T& value) {
+		m_value = std::make_shared<T>(value);
+		return *this;
+	}
+
+	/** Read the (possibly shared) value, never copies */
+	const T& get() const { return *m_value; }
+
+	/** Get a modifiable value, copying it first if it is shared w/ another CopyOnWrite */
+	T& mutate() {
+		if (m_value.use_count() > 1) m_value = std::make_shared<T>(*m_value);
+		return *m_value;
+	}
+
+	/** True if this shares its value w/ the provided CopyOnWrite (i.e. neither has been modified since they were copied) */
+	bool shares(const CopyOnWrite& other) const { return m_value == other.m_value; }
+
+	const T* operator->() const { return m_value.get(); }
+	const T& operator*() const { return *m_value; }
+	T* operator->() { return &mutate(); }
+	T& operator*() { return mutate(); }
+};
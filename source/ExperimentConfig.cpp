@@ -1,4 +1,5 @@
 #include "ExperimentConfig.h"
+#include "TextLogSink.h"
 
 ExperimentConfig::ExperimentConfig(const Any& any) : FpsConfig(any) {
 	AnyTableReader reader(any);
@@ -58,13 +59,13 @@ void ExperimentConfig::init() {
 	}
 	else {
 		// Targets are present (make sure no 2 have the same ID)
-		Array<String> ids;
-		for (TargetConfig target : targets) {
-			if (!ids.contains(target.id)) { ids.append(target.id); }
-			else {
+		Set<String> ids;
+		for (const TargetConfig& target : targets) {
+			if (ids.contains(target.id)) {
 				// This is a repeat entry, throw an exception
 				throw format("Found duplicate target configuration for target: \"%s\"", target.id);
 			}
+			ids.insert(target.id);
 		}
 
 	}
@@ -73,7 +74,7 @@ void ExperimentConfig::init() {
 		SessionConfig sess60;
 		sess60.id = "60Hz";
 		sess60.description = "60Hz trials";
-		sess60.render.frameRate = 60.0f;
+		sess60.render->frameRate = 60.0f;
 		sess60.trials = Array<TrialCount>({ TrialCount(Array<String>({ "static", "moving", "jumping" }), 2) });
 
 		sessions.append(sess60);
@@ -81,11 +82,34 @@ void ExperimentConfig::init() {
 		SessionConfig sess30;
 		sess30.id = "30Hz";
 		sess30.description = "30Hz trials";
-		sess30.render.frameRate = 30.0f;
+		sess30.render->frameRate = 30.0f;
 		sess30.trials = Array<TrialCount>({ TrialCount(Array<String>({ "static", "moving", "jumping" }), 2) });
 
 		sessions.append(sess30);
 	}
+
+	reindex();
+}
+
+void ExperimentConfig::reindex() const {
+	// Sessions w/ duplicate IDs resolve to the first (as the previous linear search did)
+	m_sessionIndex.clear();
+	m_indexedSessions = sessions.size();
+	for (int i = 0; i < sessions.size(); i++) {
+		if (!m_sessionIndex.containsKey(sessions[i].id)) m_sessionIndex.set(sessions[i].id, i);
+	}
+	// Target configs are shared (read only) so lookups don't copy them
+	m_targetsById.clear();
+	m_sharedTargets.fastClear();
+	for (const TargetConfig& target : targets) {
+		const shared_ptr<const TargetConfig> shared = TargetConfig::createShared<TargetConfig>(target);
+		m_sharedTargets.append(shared);
+		if (!m_targetsById.containsKey(target.id)) m_targetsById.set(target.id, shared);
+	}
+}
+
+void ExperimentConfig::checkIndex() const {
+	if (m_indexedSessions != sessions.size() || m_sharedTargets.size() != targets.size()) reindex();
 }
 
 ExperimentConfig ExperimentConfig::load(const String& filename) {
@@ -107,59 +131,52 @@ void ExperimentConfig::getSessionIds(Array<String>& ids) const {
 }
 
 shared_ptr<SessionConfig> ExperimentConfig::getSessionConfigById(const String& id) const {
-	for (const SessionConfig& session : sessions) {
-		if (!session.id.compare(id)) {
-			return SessionConfig::createShared<SessionConfig>(session);
-		}
-	}
-	return nullptr;
+	checkIndex();
+	const int* idx = m_sessionIndex.getPointer(id);
+	if (isNull(idx)) return nullptr;
+	// Sessions are copied, since the current session config can be modified (e.g. from the developer menus)
+	return SessionConfig::createShared<SessionConfig>(sessions[*idx]);
 }
 
 int ExperimentConfig::getSessionIndex(const String& id) const {
-	debugAssert(sessions.size() >= 0 && sessions.size() < 100000);
-	for (int i = 0; i < sessions.size(); ++i) {
-		if (!sessions[i].id.compare(id)) {
-			return i;
-		}
-	}
-	throw format("Could not find session:\"%s\"", id);
+	checkIndex();
+	const int* idx = m_sessionIndex.getPointer(id);
+	if (isNull(idx)) throw format("Could not find session:\"%s\"", id);
+	return *idx;
 }
 
-shared_ptr<TargetConfig> ExperimentConfig::getTargetConfigById(const String& id) const {
-	for (const TargetConfig& target : targets) {
-		if (!target.id.compare(id)) {
-			return TargetConfig::createShared<TargetConfig>(target);
-		}
-	}
-	return nullptr;
+shared_ptr<const TargetConfig> ExperimentConfig::getTargetConfigById(const String& id) const {
+	checkIndex();
+	const shared_ptr<const TargetConfig>* target = m_targetsById.getPointer(id);
+	return isNull(target) ? nullptr : *target;
 }
 
-Array<Array<shared_ptr<TargetConfig>>> ExperimentConfig::getTargetsByTrial(const String& id) const {
+Array<Array<shared_ptr<const TargetConfig>>> ExperimentConfig::getTargetsByTrial(const String& id) const {
 	return getTargetsByTrial(getSessionIndex(id));
 }
 
-Array<Array<shared_ptr<TargetConfig>>> ExperimentConfig::getTargetsByTrial(int sessionIndex) const {
-	Array<Array<shared_ptr<TargetConfig>>> trials;
+Array<Array<shared_ptr<const TargetConfig>>> ExperimentConfig::getTargetsByTrial(int sessionIndex) const {
+	const Array<TrialCount>& sessionTrials = sessions[sessionIndex].trials;
+	Array<Array<shared_ptr<const TargetConfig>>> trials;
+	trials.resize(sessionTrials.size());
 	// Iterate through the trials
-	for (int i = 0; i < sessions[sessionIndex].trials.size(); i++) {
-		Array<shared_ptr<TargetConfig>> targets;
-		for (String id : sessions[sessionIndex].trials[i].ids) {
-			const shared_ptr<TargetConfig> t = getTargetConfigById(id);
-			targets.append(t);
+	for (int i = 0; i < sessionTrials.size(); i++) {
+		trials[i].reserve(sessionTrials[i].ids.size());
+		for (const String& id : sessionTrials[i].ids) {
+			trials[i].append(getTargetConfigById(id));
 		}
-		trials.append(targets);
 	}
 	return trials;
 }
 
-Array<shared_ptr<TargetConfig>> ExperimentConfig::getSessionTargets(const String& id) const {
+Array<shared_ptr<const TargetConfig>> ExperimentConfig::getSessionTargets(const String& id) const {
 	const int idx = getSessionIndex(id);		// Get session index
-	Array<shared_ptr<TargetConfig>> targets;
-	Array<String> loggedIds;
-	for (auto trial : sessions[idx].trials) {
-		for (String& id : trial.ids) {
+	Array<shared_ptr<const TargetConfig>> targets;
+	Set<String> loggedIds;
+	for (const TrialCount& trial : sessions[idx].trials) {
+		for (const String& id : trial.ids) {
 			if (!loggedIds.contains(id)) {
-				loggedIds.append(id);
+				loggedIds.insert(id);
 				targets.append(getTargetConfigById(id));
 			}
 		}
@@ -168,30 +185,47 @@ Array<shared_ptr<TargetConfig>> ExperimentConfig::getSessionTargets(const String
 }
 
 bool ExperimentConfig::validate(bool throwException) const {
+	checkIndex();
 	bool valid = true;
-	// Build list of valid target ids
-	Array<String> validTargetIds;
-	for (TargetConfig target : targets) { validTargetIds.append(target.id); }
 
 	// Validate session targets against provided experiment target list
-	for (SessionConfig session : sessions) {
-		Array<String> sessionTargetIds;
-		// Build a list of target ids used in this session
-		for (TrialCount trial : session.trials) {
-			for (String id : trial.ids) { if (!sessionTargetIds.contains(id)) sessionTargetIds.append(id); }
+	Table<String, int> lastSession;			// Last session (index) each target ID was seen in (to check each ID once per session)
+	Array<String> sessionTargetIds;
+	for (int s = 0; s < sessions.size(); s++) {
+		const SessionConfig& session = sessions[s];
+		// Build a list of (unique) target ids used in this session
+		sessionTargetIds.fastClear();
+		for (const TrialCount& trial : session.trials) {
+			for (const String& id : trial.ids) {
+				bool created = false;
+				int& seen = lastSession.getCreate(id, created);
+				if (created || seen != s) {
+					seen = s;
+					sessionTargetIds.append(id);
+				}
+			}
 		}
-		// Check each ID against the experiment targets array
-		for (String targetId : sessionTargetIds) {
-			if (!validTargetIds.contains(targetId)) {
+		// Check each ID against the experiment targets
+		for (const String& targetId : sessionTargetIds) {
+			if (!m_targetsById.containsKey(targetId)) {
 				if (throwException) {
 					throw format("Could not find target ID \"%s\" used in session \"%s\"!", targetId, session.id);
 				}
 				else {
-					logPrintf("  Could not find target ID \"%s\" used in session \"%s\"!\n", targetId, session.id);
+					logPrintfAsync("  Could not find target ID \"%s\" used in session \"%s\"!\n", targetId, session.id);
 				}
 				valid = false;
 			}
 		}
+		// Check the session's feedback messages and commands (these are compiled again, and cached, when the session is created)
+		try {
+			Session::validateTemplates(session);
+		}
+		catch (const String& error) {
+			if (throwException) throw;
+			logPrintfAsync("  %s\n", error.c_str());
+			valid = false;
+		}
 	}
 	return valid;
 }
@@ -209,26 +243,26 @@ Any ExperimentConfig::toAny(const bool forceAll) const {
 }
 
 void ExperimentConfig::printToLog() const{
-	logPrintf("\n-------------------\nExperiment Config\n-------------------\nappendingDescription = %s\nscene name = %s\nTrial Feedback Duration = %f\nPretrial Duration = %f\nMax Trial Task Duration = %f\nMax Clicks = %d\n",
-		description.c_str(), scene.name.c_str(), timing.trialFeedbackDuration, timing.pretrialDuration, timing.maxTrialDuration, weapon.maxAmmo);
+	logPrintfAsync("\n-------------------\nExperiment Config\n-------------------\nappendingDescription = %s\nscene name = %s\nTrial Feedback Duration = %f\nPretrial Duration = %f\nMax Trial Task Duration = %f\nMax Clicks = %d\n",
+		description.c_str(), scene->name.c_str(), timing->trialFeedbackDuration, timing->pretrialDuration, timing->maxTrialDuration, weapon->maxAmmo);
 	// Iterate through sessions and print them
 	for (int i = 0; i < sessions.size(); i++) {
-		SessionConfig sess = sessions[i];
-		logPrintf("\t-------------------\n\tSession Config\n\t-------------------\n\tID = %s\n\tFrame Rate = %f\n\tFrame Delay = %d\n",
-			sess.id.c_str(), sess.render.frameRate, sess.render.frameDelay);
+		const SessionConfig& sess = sessions[i];
+		logPrintfAsync("\t-------------------\n\tSession Config\n\t-------------------\n\tID = %s\n\tFrame Rate = %f\n\tFrame Delay = %d\n",
+			sess.id.c_str(), sess.render->frameRate, sess.render->frameDelay);
 		// Now iterate through each run
 		for (int j = 0; j < sess.trials.size(); j++) {
 			String ids;
-			for (String id : sess.trials[j].ids) { ids += format("%s, ", id.c_str()); }
+			for (const String& id : sess.trials[j].ids) { ids += format("%s, ", id.c_str()); }
 			if (ids.length() > 2) ids = ids.substr(0, ids.length() - 2);
-			logPrintf("\t\tTrial Run Config: IDs = [%s], Count = %d\n",
+			logPrintfAsync("\t\tTrial Run Config: IDs = [%s], Count = %d\n",
 				ids.c_str(), sess.trials[j].count);
 		}
 	}
 	// Iterate through trials and print them
 	for (int i = 0; i < targets.size(); i++) {
-		TargetConfig target = targets[i];
-		logPrintf("\t-------------------\n\tTarget Config\n\t-------------------\n\tID = %s\n\tMotion Change Period = [%f-%f]\n\tMin Speed = %f\n\tMax Speed = %f\n\tVisual Size = [%f-%f]\n\tUpper Hemisphere Only = %s\n\tJump Enabled = %s\n\tJump Period = [%f-%f]\n\tjumpSpeed = [%f-%f]\n\tAccel Gravity = [%f-%f]\n\tAxis Lock = [%s, %s, %s]\n",
+		const TargetConfig& target = targets[i];
+		logPrintfAsync("\t-------------------\n\tTarget Config\n\t-------------------\n\tID = %s\n\tMotion Change Period = [%f-%f]\n\tMin Speed = %f\n\tMax Speed = %f\n\tVisual Size = [%f-%f]\n\tUpper Hemisphere Only = %s\n\tJump Enabled = %s\n\tJump Period = [%f-%f]\n\tjumpSpeed = [%f-%f]\n\tAccel Gravity = [%f-%f]\n\tAxis Lock = [%s, %s, %s]\n",
 			target.id.c_str(), target.motionChangePeriod[0], target.motionChangePeriod[1], target.speed[0], target.speed[1], target.size[0], target.size[1], target.upperHemisphereOnly ? "True" : "False", target.jumpEnabled ? "True" : "False", target.jumpPeriod[0], target.jumpPeriod[1], target.jumpSpeed[0], target.jumpSpeed[1], target.accelGravity[0], target.accelGravity[1],
 			target.axisLock[0] ? "true" : "false", target.axisLock[1] ? "true" : "false", target.axisLock[2] ? "true" : "false");
 	}
@@ -4,8 +4,21 @@
 #include "TargetEntity.h"
 #include "Session.h"
 
-/** Experiment configuration */
+/** Experiment configuration
+
+	Sessions and targets are indexed by ID (in init()) so lookups don't scan the arrays. Call reindex() after modifying
+	the sessions or targets arrays (the index is also rebuilt if their sizes change).
+*/
 class ExperimentConfig : public FpsConfig {
+protected:
+	mutable Table<String, int>								m_sessionIndex;		///< Session index (in sessions) by ID
+	mutable Table<String, shared_ptr<const TargetConfig>>	m_targetsById;		///< Shared (immutable) target configs by ID
+	mutable Array<shared_ptr<const TargetConfig>>			m_sharedTargets;	///< Shared target configs (in targets order)
+	mutable int												m_indexedSessions = -1;	///< Size of the sessions array when indexed
+
+	/** Rebuild the index if the sessions/targets arrays have been resized since it was built */
+	void checkIndex() const;
+
 public:
 	String description = "Experiment";					///< Experiment description
 	Array<SessionConfig> sessions;						///< Array of sessions
@@ -16,17 +29,18 @@ public:
 	ExperimentConfig(const Any& any);
 
 	void init();
+	void reindex() const;														// Rebuild the session/target ID index
 	static ExperimentConfig load(const String& filename);	// Get the experiment config from file
 	Any toAny(const bool forceAll = false) const;
 
 	void getSessionIds(Array<String>& ids) const;								// Get an array of session IDs
-	shared_ptr<SessionConfig> getSessionConfigById(const String& id) const;		// Get a session config based on its ID
+	shared_ptr<SessionConfig> getSessionConfigById(const String& id) const;		// Get a (modifiable) copy of a session config based on its ID
 	int getSessionIndex(const String& id) const;								// Get the index of a session in the session array (by ID)
-	shared_ptr<TargetConfig> getTargetConfigById(const String& id) const;		// Get a pointer to a target config by ID
+	shared_ptr<const TargetConfig> getTargetConfigById(const String& id) const;	// Get a (shared) pointer to a target config by ID
 
-	Array<Array<shared_ptr<TargetConfig>>> getTargetsByTrial(const String& id) const;			// Get target configs by trial (not recommended for repeated calls)
-	Array<Array<shared_ptr<TargetConfig>>> getTargetsByTrial(int sessionIndex) const;			// Get target configs by trial (not recommended for repeated calls)
-	Array<shared_ptr<TargetConfig>> getSessionTargets(const String& id) const;					// Get all targets affiliated with a session (not recommended for repeated calls)
+	Array<Array<shared_ptr<const TargetConfig>>> getTargetsByTrial(const String& id) const;		// Get target configs by trial
+	Array<Array<shared_ptr<const TargetConfig>>> getTargetsByTrial(int sessionIndex) const;		// Get target configs by trial
+	Array<shared_ptr<const TargetConfig>> getSessionTargets(const String& id) const;			// Get all targets affiliated with a session
 
 	bool validate(bool throwException) const;									// Validate the session/target configuration
 
@@ -5,6 +5,8 @@
 #include "Session.h"
 #include "PhysicsScene.h"
 #include "WaypointManager.h"
+#include "TextLogSink.h"
+#include "TraceRecorder.h"
 #include <chrono>
 
 // Storage for configuration static vars
@@ -19,7 +21,13 @@ FPSciApp::FPSciApp(const GApp::Settings& settings) : GApp(settings) {}
 /** Initialize the app */
 void FPSciApp::onInit() {
 	// Seed random based on the time
-	Random::common().reset(uint32(time(0)));
+	m_randomSeed = uint32(time(0));
+	Random::common().reset(m_randomSeed);
+
+	// Move log.txt output off of the calling threads
+	TextLogSink::common().start();
+	TraceRecorder::common().setThreadName("Main");
+	TraceRecorder::common().setEnabled(startupConfig.developerMode);		// Always record profiler zones in developer mode (export w/ the exportTrace key)
 
 	GApp::onInit();			// Initialize the G3D application (one time)
 	startupConfig.validateExperiments();
@@ -52,7 +60,7 @@ void FPSciApp::initExperiment(){
 	scene()->registerEntitySubclass("PlayerEntity", &PlayerEntity::create);			// Register the player entity for creation
 	scene()->registerEntitySubclass("FlyingEntity", &FlyingEntity::create);			// Register the target entity for creation
 
-	weapon = Weapon::create(&experimentConfig.weapon, scene(), activeCamera());
+	weapon = Weapon::create(&*experimentConfig.weapon, scene(), activeCamera());
 	weapon->setHitCallback(std::bind(&FPSciApp::hitTarget, this, std::placeholders::_1));
 	weapon->setMissCallback(std::bind(&FPSciApp::missEvent, this));
 
@@ -70,7 +78,17 @@ void FPSciApp::initExperiment(){
 
 	updateMouseSensitivity();				// Update (apply) mouse sensitivity
 	const Array<String> sessions = m_userSettingsWindow->updateSessionDropDown();	// Update the session drop down to remove already completed sessions
-	updateSession(sessions[0], true);		// Update session to create results file/start collection
+
+	// Check the session journal for an interrupted session we can pick back up
+	m_resumeState = SessionJournal::load(sessionJournalFilename());
+	if (m_resumeState.resumable() && m_resumeState.userId == userStatusTable.currentUser && sessions.contains(m_resumeState.sessionId)) {
+		logPrintfAsync("Found interrupted session %s in the session journal, resuming...\n", m_resumeState.sessionId.c_str());
+		updateSession(m_resumeState.sessionId, true);
+	}
+	else {
+		m_resumeState = SessionJournal::State();
+		updateSession(sessions[0], true);		// Update session to create results file/start collection
+	}
 }
 
 void FPSciApp::toggleUserSettingsMenu() {
@@ -97,7 +115,7 @@ void FPSciApp::openUserSettingsWindow() {
 
 /** Handle the user settings window visibility */
 void FPSciApp::closeUserSettingsWindow() {
-	if (sessConfig->menu.allowUserSettingsSave) {		// If the user could have saved their settings
+	if (sessConfig->menu->allowUserSettingsSave) {		// If the user could have saved their settings
 		saveUserConfig(true);							// Save the user config (if it has changed) whenever this window is closed
 	}
 	if (!dialog) {										// Don't allow the user menu to hide the mouse when a dialog box is open
@@ -110,16 +128,20 @@ void FPSciApp::saveUserConfig(bool onDiff) {
 	// Check for save on diff, without mismatch
 	if (onDiff && m_lastSavedUser == *currentUser()) return;
 	if (notNull(sess->logger)) {
-		sess->logger->logUserConfig(*currentUser(), sessConfig->id, sessConfig->player.turnScale);
+		sess->logger->logUserConfig(*currentUser(), sessConfig->id, sessConfig->player->turnScale);
 	}
 	userTable.save(startupConfig.experimentList[experimentIdx].userConfigFilename);
 	m_lastSavedUser = *currentUser();			// Copy over this user
-	logPrintf("User table saved.\n");			// Print message to log
+	logPrintfAsync("User table saved.\n");			// Print message to log
 }
 
 void FPSciApp::saveUserStatus(void) {
 	userStatusTable.save(startupConfig.experimentList[experimentIdx].userStatusFilename);
-	logPrintf("User status saved.\n");
+	logPrintfAsync("User status saved.\n");
+}
+
+String FPSciApp::sessionJournalFilename() {
+	return startupConfig.experimentList[experimentIdx].resultsDirPath + userStatusTable.currentUser + "_session.journal";
 }
 
 /** Update the mouse mode/sensitivity */
@@ -164,7 +186,7 @@ void FPSciApp::loadConfigs(const ConfigFiles& configs) {
 	// Get hash for experimentconfig.Any file
 	const size_t hash = HashTrait<String>::hashCode(experimentConfig.toAny().unparse());		// Hash the serialized Any (don't consider formatting)
 	m_expConfigHash = format("%x", hash);														// Store the hash as a hex string
-	logPrintf("Experiment hash: %s\r\n", m_expConfigHash);										// Write to log
+	logPrintfAsync("Experiment hash: %s\r\n", m_expConfigHash);										// Write to log
 
 	Array<String> sessionIds;
 	experimentConfig.getSessionIds(sessionIds);
@@ -185,6 +207,20 @@ void FPSciApp::loadConfigs(const ConfigFiles& configs) {
 	// Get system configuration
 	systemConfig = SystemConfig::load(configs.systemConfigFilename);
 	systemConfig.printToLog();			// Print the latency logger config to log.txt	
+	m_framePacer.setMinSpinTime(systemConfig.framePacerSpinUs * 1e-6);
+
+	// Apply the thread policies, then restart the log.txt writer so it picks up the helper thread policy
+	systemConfig.applyThreadPolicies();
+	TextLogSink::common().stop();
+	TextLogSink::common().start();
+
+	// Start (or stop) reading timestamped mouse buttons on their own thread
+	if (systemConfig.rawInputThread) {
+		if (!m_rawInput.running()) m_rawInput.start(&m_timedInput);
+	}
+	else {
+		m_rawInput.stop();
+	}
 
 	// Load the key binds
 	keyMap = KeyMapping::load(configs.keymapConfigFilename);
@@ -192,7 +228,7 @@ void FPSciApp::loadConfigs(const ConfigFiles& configs) {
 }
 
 void FPSciApp::loadModels() {
-	if ((experimentConfig.weapon.renderModel || startupConfig.developerMode) && !experimentConfig.weapon.modelSpec.filename.empty()) {
+	if ((experimentConfig.weapon->renderModel || startupConfig.developerMode) && !experimentConfig.weapon->modelSpec.filename.empty()) {
 		// Load the model if we (might) need it
 		weapon->loadModels();
 	}
@@ -201,7 +237,7 @@ void FPSciApp::loadModels() {
 	Table<String, Any> targetsToBuild;
 	Table<String, String> explosionsToBuild;
 	Table<String, float> explosionScales;
-	for (TargetConfig target : experimentConfig.targets) {
+	for (const TargetConfig& target : experimentConfig.targets) {
 		targetsToBuild.set(target.id, target.modelSpec);
 		explosionsToBuild.set(target.id, target.destroyDecal);
 		explosionScales.set(target.id, target.destroyDecalScale);
@@ -245,7 +281,7 @@ void FPSciApp::loadModels() {
 		AABox bbox;
 		size_model->getBoundingBox(bbox);
 		Vector3 extent = bbox.extent();
-		logPrintf("%20s bounding box: [%2.2f, %2.2f, %2.2f]\n", id.c_str(), extent[0], extent[1], extent[2]);
+		logPrintfAsync("%20s bounding box: [%2.2f, %2.2f, %2.2f]\n", id.c_str(), extent[0], extent[1], extent[2]);
 		const float default_scale = 1.0f / extent[0];					// Setup scale so that default model is 1m across
 
 		// Create the target/explosion models for this target
@@ -265,7 +301,7 @@ void FPSciApp::loadModels() {
 	m_materials.clear();
 	for (int i = 0; i < m_MatTableSize; i++) {
 		float complete = (float)i / m_MatTableSize;
-		Color3 color = experimentConfig.targetView.healthColors[0] * complete + experimentConfig.targetView.healthColors[1] * (1.0f - complete);
+		Color3 color = experimentConfig.targetView->healthColors[0] * complete + experimentConfig.targetView->healthColors[1] * (1.0f - complete);
 		UniversalMaterial::Specification materialSpecification;
 		materialSpecification.setLambertian(Texture::Specification(color));
 		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
@@ -277,7 +313,7 @@ void FPSciApp::loadModels() {
 void FPSciApp::updateControls(bool firstSession) {
 	// Update the user settings window
 	updateUserMenu = true;
-	if(!firstSession) m_showUserMenu = sessConfig->menu.showMenuBetweenSessions;
+	if(!firstSession) m_showUserMenu = sessConfig->menu->showMenuBetweenSessions;
 
 	// Update the waypoint manager
 	if (startupConfig.waypointEditorMode) { waypointManager->updateControls(); }
@@ -316,7 +352,7 @@ void FPSciApp::updateControls(bool firstSession) {
 		rect = m_weaponControls->rect();
 		removeWidget(m_weaponControls);
 	}
-	m_weaponControls = WeaponControls::create(sessConfig->weapon, theme);
+	m_weaponControls = WeaponControls::create(*sessConfig->weapon, theme);
 	m_weaponControls->setVisible(visible);
 	if (!rect.isEmpty()) m_weaponControls->setRect(rect);
 	addWidget(m_weaponControls);
@@ -350,7 +386,7 @@ void FPSciApp::makeGUI() {
 
 	// Create the user settings window
 	if (notNull(m_userSettingsWindow)) { removeWidget(m_userSettingsWindow); }
-	m_userSettingsWindow = UserMenu::create(this, userTable, userStatusTable, sessConfig->menu, theme, Rect2D::xywh(0.0f, 0.0f, 10.0f, 10.0f));
+	m_userSettingsWindow = UserMenu::create(this, userTable, userStatusTable, *sessConfig->menu, theme, Rect2D::xywh(0.0f, 0.0f, 10.0f, 10.0f));
 	addWidget(m_userSettingsWindow);
 	openUserSettingsWindow();
 
@@ -361,13 +397,13 @@ void FPSciApp::makeGUI() {
 
 	// Add the control panes here
 	updateControls();
-	m_showUserMenu = experimentConfig.menu.showMenuOnStartup;
+	m_showUserMenu = experimentConfig.menu->showMenuOnStartup;
 }
 
 void FPSciApp::exportScene() {
 	CFrame frame = scene()->typedEntity<PlayerEntity>("player")->frame();
-	logPrintf("Player position is: [%f, %f, %f]\n", frame.translation.x, frame.translation.y, frame.translation.z);
-	String filename = Scene::sceneNameToFilename(sessConfig->scene.name);
+	logPrintfAsync("Player position is: [%f, %f, %f]\n", frame.translation.x, frame.translation.y, frame.translation.z);
+	String filename = Scene::sceneNameToFilename(sessConfig->scene->name);
 	scene()->toAny().save(filename);
 }
 
@@ -423,7 +459,7 @@ void FPSciApp::markSessComplete(String sessId) {
 	// Add the session id to completed session array and save the user status table
 	userStatusTable.addCompletedSession(userStatusTable.currentUser, sessId);
 	saveUserStatus();
-	logPrintf("Marked session: %s complete for user %s.\n", sessId, userStatusTable.currentUser);
+	logPrintfAsync("Marked session: %s complete for user %s.\n", sessId, userStatusTable.currentUser);
 
 	// Update the session drop-down to remove this session
 	m_userSettingsWindow->updateSessionDropDown();
@@ -433,6 +469,7 @@ void FPSciApp::updateParameters(int frameDelay, float frameRate) {
 	// Apply frame lag
 	displayLagFrames = frameDelay;
 	lastSetFrameRate = frameRate;
+	m_latencyTracker.setFrameDelay(frameDelay);
 	// Set a maximum *finite* frame rate
 	float dt = 0;
 	if (frameRate > 0) dt = 1.0f / frameRate;
@@ -446,11 +483,11 @@ void FPSciApp::initPlayer() {
 	shared_ptr<PhysicsScene> pscene = typedScene<PhysicsScene>();
 
 	// Set gravity and camera field of view
-	Vector3 grav = experimentConfig.player.gravity;
-	float FoV = experimentConfig.render.hFoV;
+	Vector3 grav = experimentConfig.player->gravity;
+	float FoV = experimentConfig.render->hFoV;
 	if (notNull(sessConfig)) {
-		grav = sessConfig->player.gravity;
-		FoV = sessConfig->render.hFoV;
+		grav = sessConfig->player->gravity;
+		FoV = sessConfig->render->hFoV;
 	}
 	pscene->setGravity(grav);
 	playerCamera->setFieldOfView(FoV * units::degrees(), FOVDirection::HORIZONTAL);
@@ -459,7 +496,7 @@ void FPSciApp::initPlayer() {
 	player->setVisible(false);
 
 	// Set the reset height
-	float resetHeight = sessConfig->scene.resetHeight;
+	float resetHeight = sessConfig->scene->resetHeight;
 	if (isnan(resetHeight)) {
 		float resetHeight = pscene->resetHeight();
 		if (isnan(resetHeight)) {
@@ -469,21 +506,21 @@ void FPSciApp::initPlayer() {
 	player->setRespawnHeight(resetHeight);
 
 	// Set player respawn location
-	Point3 spawnPosition = sessConfig->scene.spawnPosition;
+	Point3 spawnPosition = sessConfig->scene->spawnPosition;
 	if (isnan(spawnPosition.x)) {
 		spawnPosition = player->frame().translation;
 	}
 	player->setRespawnPosition(spawnPosition);
 
 	// Set player values from session config
-	player->moveRate = &sessConfig->player.moveRate;
-	player->moveScale = &sessConfig->player.moveScale;
-	player->axisLock = &sessConfig->player.axisLock;
-	player->jumpVelocity = &sessConfig->player.jumpVelocity;
-	player->jumpInterval = &sessConfig->player.jumpInterval;
-	player->jumpTouch = &sessConfig->player.jumpTouch;
-	player->height = &sessConfig->player.height;
-	player->crouchHeight = &sessConfig->player.crouchHeight;
+	player->moveRate = &sessConfig->player->moveRate;
+	player->moveScale = &sessConfig->player->moveScale;
+	player->axisLock = &sessConfig->player->axisLock;
+	player->jumpVelocity = &sessConfig->player->jumpVelocity;
+	player->jumpInterval = &sessConfig->player->jumpInterval;
+	player->jumpTouch = &sessConfig->player->jumpTouch;
+	player->height = &sessConfig->player->height;
+	player->crouchHeight = &sessConfig->player->crouchHeight;
 
 	// Respawn player
 	player->respawn();
@@ -494,13 +531,24 @@ void FPSciApp::initPlayer() {
 }
 
 void FPSciApp::updateSession(const String& id, bool forceReload) {
+	// Stop simulating (on another thread) while the scene/session are replaced
+	m_simThread.stop();
+	if (notNull(scene())) typedScene<PhysicsScene>()->setQueueChanges(false);		// Apply any queued inserts/removals
+
+	// Report frame pacing for the last session (if any)
+	m_framePacer.printStatsToLog();
+	m_framePacer.resetStats();
+
+	// Don't resume a session the user chose to leave
+	if (notNull(sess) && notNull(sessConfig) && sessConfig->id != id) sess->abandon();
+
 	// Check for a valid ID (non-emtpy and 
 	Array<String> ids;
 	experimentConfig.getSessionIds(ids);
 	if (!id.empty() && ids.contains(id)) {
 		// Load the session config specified by the id
 		sessConfig = experimentConfig.getSessionConfigById(id);
-		logPrintf("User selected session: %s. Updating now...\n", id);
+		logPrintfAsync("User selected session: %s. Updating now...\n", id);
 		m_userSettingsWindow->setSelectedSession(id);
 		// Create the session based on the loaded config
 		sess = Session::create(this, sessConfig);
@@ -510,26 +558,48 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 		sessConfig = SessionConfig::create();
 		sess = Session::create(this);
 	}
+	// Pointers into the live session config are handed out (player, developer menus), so it shouldn't share its sub-configs
+	sessConfig->detach();
 
 	// Update the controls for this session
 	updateControls(m_firstSession);				// If first session consider showing the menu
 
 	// Update the frame rate/delay
-	updateParameters(sessConfig->render.frameDelay, sessConfig->render.frameRate);
+	updateParameters(sessConfig->render->frameDelay, sessConfig->render->frameRate);
+
+	// Update the (optional) fixed simulation rate
+	m_fixedTimestep.setRate(sessConfig->render->simulationRate);
+	m_interpolator.clear();
+
+	// Reset the adaptive quality controller (restoring any shadows it disabled before the scene changes)
+	const RealTime qualityTargetDuration = (sessConfig->render->adaptiveQuality && sessConfig->render->frameRate > 0) ? 1.0 / sessConfig->render->frameRate : 0.0;
+	m_qualityController.configure(sessConfig->render->qualityLevels, sessConfig->render->qualitySettings(), qualityTargetDuration);
+	applyQualityLevel(QualityLevel());
+
+	if (sessConfig->render->lateLatch && !m_rawInput.running()) {
+		logPrintfAsync("WARNING: \"lateLatch\" requires the raw input thread (\"rawInputThread\" in the system config), late latching is disabled!\n");
+	}
+
+	// Start delaying from the new session's state (and free the delay framebuffers when delaying state instead)
+	m_stateDelayQueue.clear();
+	if (sessConfig->render->frameDelayMode == "state") {
+		m_ldrDelayBufferQueue.clear();
+		m_currentDelayBufferIndex = 0;
+	}
 
 	// Handle buffer setup here
 	updateShaderBuffers();
 
 	// Update shader table
 	m_shaderTable.clear();
-	if (!sessConfig->render.shader3D.empty()) {
-		m_shaderTable.set(sessConfig->render.shader3D, G3D::Shader::getShaderFromPattern(sessConfig->render.shader3D));
+	if (!sessConfig->render->shader3D.empty()) {
+		m_shaderTable.set(sessConfig->render->shader3D, G3D::Shader::getShaderFromPattern(sessConfig->render->shader3D));
 	}
-	if (!sessConfig->render.shader2D.empty()) {
-		m_shaderTable.set(sessConfig->render.shader2D, G3D::Shader::getShaderFromPattern(sessConfig->render.shader2D));
+	if (!sessConfig->render->shader2D.empty()) {
+		m_shaderTable.set(sessConfig->render->shader2D, G3D::Shader::getShaderFromPattern(sessConfig->render->shader2D));
 	}
-	if (!sessConfig->render.shaderComposite.empty()) {
-		m_shaderTable.set(sessConfig->render.shaderComposite, G3D::Shader::getShaderFromPattern(sessConfig->render.shaderComposite));
+	if (!sessConfig->render->shaderComposite.empty()) {
+		m_shaderTable.set(sessConfig->render->shaderComposite, G3D::Shader::getShaderFromPattern(sessConfig->render->shaderComposite));
 	}
 
 	// Update shader parameters
@@ -538,16 +608,19 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 	m_last3DTime = m_startTime;
 	m_lastCompositeTime = m_startTime;
 	m_frameNumber = 0;
+	m_lastFrameEndTime = 0.0;		// Don't count the (long) session loading frame as a hitch
+	m_stageCounters.setEnabled(sessConfig->logger->enable && sessConfig->logger->logPerfCounters);
+	m_latencyTracker.setEnabled(sessConfig->logger->enable && sessConfig->logger->logShotLatency);
 
 	// Load (session dependent) fonts
-	hudFont = GFont::fromFile(System::findDataFile(sessConfig->hud.hudFont));
-	m_combatFont = GFont::fromFile(System::findDataFile(sessConfig->targetView.combatTextFont));
+	hudFont = GFont::fromFile(System::findDataFile(sessConfig->hud->hudFont));
+	m_combatFont = GFont::fromFile(System::findDataFile(sessConfig->targetView->combatTextFont));
 
 	// Handle clearing the targets here (clear any remaining targets before loading a new scene)
-	if (notNull(scene())) sess->clearTargets();
+	if (notNull(scene())) sess->clearTargetPool();
 
 	// Load the experiment scene if we haven't already (target only)
-	if (sessConfig->scene.name.empty()) {
+	if (sessConfig->scene->name.empty()) {
 		// No scene specified, load default scene
 		if (m_loadedScene.name.empty() || forceReload) {
 			loadScene(m_defaultSceneName);					// Note: this calls onGraphics()
@@ -555,26 +628,26 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 		}
 		// Otherwise let the loaded scene persist
 	}
-	else if (sessConfig->scene != m_loadedScene || forceReload) {
-		loadScene(sessConfig->scene.name);
-		m_loadedScene = sessConfig->scene;
+	else if (*sessConfig->scene != m_loadedScene || forceReload) {
+		loadScene(sessConfig->scene->name);
+		m_loadedScene = *sessConfig->scene;
 	}
 
 	// Check for play mode specific parameters
 	if (notNull(weapon)) weapon->clearDecals();
-	weapon->setConfig(&sessConfig->weapon);
+	weapon->setConfig(&*sessConfig->weapon);
 	weapon->setScene(scene());
 	weapon->setCamera(activeCamera());
 
 	// Update weapon model (if drawn) and sounds
 	weapon->loadModels();
 	weapon->loadSounds();
-	if (!sessConfig->audio.sceneHitSound.empty()) {
-		m_sceneHitSound = Sound::create(System::findDataFile(sessConfig->audio.sceneHitSound));
+	if (!sessConfig->audio->sceneHitSound.empty()) {
+		m_sceneHitSound = Sound::create(System::findDataFile(sessConfig->audio->sceneHitSound));
 	}
 
 	// Load static HUD textures
-	for (StaticHudElement element : sessConfig->hud.staticElements) {
+	for (StaticHudElement element : sessConfig->hud->staticElements) {
 		hudTextures.set(element.filename, Texture::fromFile(System::findDataFile(element.filename)));
 	}
 
@@ -582,7 +655,7 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 	m_materials.clear();
 	for (int i = 0; i < m_MatTableSize; i++) {
 		float complete = (float)i / m_MatTableSize;
-		Color3 color = sessConfig->targetView.healthColors[0] * complete + sessConfig->targetView.healthColors[1] * (1.0f - complete);
+		Color3 color = sessConfig->targetView->healthColors[0] * complete + sessConfig->targetView->healthColors[1] * (1.0f - complete);
 		UniversalMaterial::Specification materialSpecification;
 		materialSpecification.setLambertian(Texture::Specification(color));
 		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
@@ -600,13 +673,20 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 		FileSystem::createDirectory(resultsDirPath);
 	}
 
-	const String logName = sessConfig->logger.logToSingleDb ? 
+	String logName = sessConfig->logger->logToSingleDb ? 
 		resultsDirPath + experimentConfig.description + "_" + userStatusTable.currentUser + "_" + m_expConfigHash :
 		resultsDirPath + id + "_" + userStatusTable.currentUser + "_" + String(FPSciLogger::genFileTimestamp());
 
+	// Resume an interrupted session (continue logging to its results file)
+	if (m_resumeState.resumable() && m_resumeState.sessionId == id) {
+		logName = m_resumeState.dbFilename;
+		sess->setResumeState(m_resumeState);
+	}
+	m_resumeState = SessionJournal::State();
+
 	if (systemConfig.hasLogger) {
-		if (!sessConfig->clickToPhoton.enabled) {
-			logPrintf("WARNING: Using a click-to-photon logger without the click-to-photon region enabled!\n\n");
+		if (!sessConfig->clickToPhoton->enabled) {
+			logPrintfAsync("WARNING: Using a click-to-photon logger without the click-to-photon region enabled!\n\n");
 		}
 		if (m_pyLogger == nullptr) {
 			m_pyLogger = PythonLogger::create(systemConfig.loggerComPort, systemConfig.hasSync, systemConfig.syncComPort);
@@ -616,7 +696,7 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 			m_pyLogger->mergeLogToDb();
 		}
 		// Run a new logger if we need to (include the mode to run in here...)
-		m_pyLogger->run(logName, sessConfig->clickToPhoton.mode);
+		m_pyLogger->run(logName, sessConfig->clickToPhoton->mode);
 	}
 
 	// Initialize the experiment (this creates the results file)
@@ -624,15 +704,28 @@ void FPSciApp::updateSession(const String& id, bool forceReload) {
 
 	// Don't create a results file for a user w/ no sessions left
 	if (m_userSettingsWindow->sessionsForSelectedUser() == 0) {
-		logPrintf("No sessions remaining for selected user.\n");
+		logPrintfAsync("No sessions remaining for selected user.\n");
 	}
 	else {
-		logPrintf("Created results file: %s.db\n", logName.c_str());
+		logPrintfAsync("Created results file: %s.db\n", logName.c_str());
 	}
 
 	if (m_firstSession) {
 		m_firstSession = false;
 	}
+
+	// Start simulating on a separate thread (if requested)
+	if (systemConfig.simulationThread) {
+		if (m_fixedTimestep.enabled()) {
+			m_simThreadButton = ShootButtonState();
+			m_simThreadTime = 0.0;
+			typedScene<PhysicsScene>()->setQueueChanges(true);		// Entities added/removed while simulating are applied in onPose()
+			m_simThread.start(sessConfig->render->simulationRate, [this](SimTime step) { simulationThreadStep(step); });
+		}
+		else {
+			logPrintfAsync("WARNING: simulationThread requires a (fixed) simulationRate, simulating once per frame instead.\n");
+		}
+	}
 }
 
 void FPSciApp::quitRequest() {
@@ -654,15 +747,15 @@ void FPSciApp::onAfterLoadScene(const Any& any, const String& sceneName) {
 
 	// Add a player if one isn't present in the scene
 	if (isNull(player)) {
-		logPrintf("WARNING: Didn't find a \"player\" specified in \"%s\"! Adding one at the origin.", sceneName);
+		logPrintfAsync("WARNING: Didn't find a \"player\" specified in \"%s\"! Adding one at the origin.", sceneName);
 		shared_ptr<Entity> newPlayer = PlayerEntity::create("player", scene().get(), CFrame(), nullptr);
 		scene()->insert(newPlayer);
 	}
 
 	// Set the active camera to the player
-	const String pcamName = sessConfig->scene.playerCamera;
-	playerCamera = pcamName.empty() ? scene()->defaultCamera() : scene()->typedEntity<Camera>(sessConfig->scene.playerCamera);
-	alwaysAssertM(notNull(playerCamera), format("Scene %s does not contain a camera named \"%s\"!", sessConfig->scene.name, sessConfig->scene.playerCamera));
+	const String pcamName = sessConfig->scene->playerCamera;
+	playerCamera = pcamName.empty() ? scene()->defaultCamera() : scene()->typedEntity<Camera>(sessConfig->scene->playerCamera);
+	alwaysAssertM(notNull(playerCamera), format("Scene %s does not contain a camera named \"%s\"!", sessConfig->scene->name, sessConfig->scene->playerCamera));
 	setActiveCamera(playerCamera);
 
 	initPlayer();
@@ -685,65 +778,87 @@ void FPSciApp::onNetwork() {
 }
 
 
-void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
-	// TODO: this should eventually probably use sdt instead of rdt
-	RealTime currentRealTime;
-	if (m_lastOnSimulationRealTime == 0) {
-		m_lastOnSimulationRealTime = System::time();			// Grab the current system time if uninitialized
-		currentRealTime = m_lastOnSimulationRealTime;			// Set this equal to the current system time
-	}
-	else {
-		currentRealTime = m_lastOnSimulationRealTime + rdt;		// Increment the time by the current real time delta
+void FPSciApp::stepSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
+	// TODO (or NOTTODO): The following can be cleared at the cost of one more level of inheritance.
+	sess->onSimulation(rdt, sdt, idt);
+	stepWorld(sdt);
+}
+
+void FPSciApp::stepWorld(SimTime sdt) {
+	if (scene()) { scene()->onSimulation(sdt); }
+
+	// Simulate the projectiles
+	weapon->simulateProjectiles(sdt, sess->hittableTargets());
+
+	// explosion animation
+	for (int i = 0; i < m_explosions.size(); i++) {
+		const shared_ptr<Entity> explosion = m_explosions[i];
+		m_explosionRemainingTimes[i] -= sdt;
+		if (m_explosionRemainingTimes[i] <= 0) {
+			typedScene<PhysicsScene>()->removeOrQueue(explosion);
+			m_explosions.fastRemove(i);
+			m_explosionRemainingTimes.fastRemove(i);
+			i--;
+		}
+		else {
+			// could update animation here...
+		}
 	}
+}
 
+void FPSciApp::simulateWeapon(RealTime lastTime, RealTime currentTime, RealTime rdt, const ShootButtonState& button) {
 	bool stateCanFire = sess->currentState == PresentationState::trialTask && !m_userSettingsWindow->visible();
 
 	// These variables will be used to fire after the various weapon styles populate them below
 	int numShots = 0;
 	float damagePerShot = weapon->damagePerShot();
-	RealTime newLastFireTime = currentRealTime;
+	RealTime newLastFireTime = currentTime;
+
+	// Use the timestamped press/release times when available, otherwise assume they happened half way through the interval
+	const RealTime pressTime = isNaN(button.pressTime) ? lastTime + rdt * 0.5f : clamp(button.pressTime, lastTime, currentTime);
+	const RealTime releaseTime = isNaN(button.releaseTime) ? lastTime + rdt * 0.5f : clamp(button.releaseTime, lastTime, currentTime);
 
-	if (shootButtonJustPressed && stateCanFire && !weapon->canFire(currentRealTime)) {
+	if (button.justPressed && stateCanFire && !weapon->canFire(currentTime)) {
 		// Invalid click since the weapon isn't ready to fire
 		sess->accumulatePlayerAction(PlayerActionType::Invalid);
 	}
-	else if ((shootButtonJustPressed || !shootButtonUp) && !stateCanFire) {
+	else if ((button.justPressed || !button.up) && !stateCanFire) {
 		// Non-task state but button pressed
 		sess->accumulatePlayerAction(PlayerActionType::Nontask);
 	}
-	else if (shootButtonJustPressed && !weapon->config()->autoFire && weapon->canFire(currentRealTime) && stateCanFire) {
-		// Discrete weapon fires a single shot with normal damage at the current time
+	else if (button.justPressed && !weapon->config()->autoFire && weapon->canFire(currentTime) && stateCanFire) {
+		// Discrete weapon fires a single shot with normal damage at the press time (or the current time if not timestamped)
 		numShots = 1;
-		// These copy the above defaults, but are here for clarity
+		// This copies the above default, but is here for clarity
 		damagePerShot = weapon->damagePerShot();
-		newLastFireTime = currentRealTime;
+		newLastFireTime = isNaN(button.pressTime) ? currentTime : pressTime;
 	}
-	else if (weapon->config()->autoFire && !weapon->config()->isContinuous() && !shootButtonUp && stateCanFire) {
-		// Autofire weapon should create shots until currentRealTime with normal damage
-		if (shootButtonJustPressed) {
-			// If the button was just pressed, fire one bullet half way through
-			weapon->setLastFireTime(m_lastOnSimulationRealTime + rdt * 0.5f);
+	else if (weapon->config()->autoFire && !weapon->config()->isContinuous() && !button.up && stateCanFire) {
+		// Autofire weapon should create shots until currentTime with normal damage
+		if (button.justPressed) {
+			// If the button was just pressed, fire one bullet at the press time
+			weapon->setLastFireTime(pressTime);
 			numShots = 1;
 		}
 		// Add on bullets until the frame time
-		int newShots = weapon->numShotsUntil(currentRealTime);
+		int newShots = weapon->numShotsUntil(currentTime);
 		numShots += newShots;
 		newLastFireTime = weapon->lastFireTime() + (float)(newShots) * weapon->config()->firePeriod;
 		// This copies the above default, but are here for clarity
 		damagePerShot = weapon->damagePerShot();
 	}
-	else if (weapon->config()->isContinuous() && (!shootButtonUp || shootButtonJustReleased) && stateCanFire) {
+	else if (weapon->config()->isContinuous() && (!button.up || button.justReleased) && stateCanFire) {
 		// Continuous weapon should have been firing continuously, but since we do sampled simulation
 		// this approximates continuous fire by releasing a single "megabullet"
 		// with power that matches the elapsed time at the current
 		numShots = 1;
 
-		// If the button was just pressed, assume the duration should begin half way through
-		if (shootButtonJustPressed) {
-			weapon->setLastFireTime(m_lastOnSimulationRealTime + rdt * 0.5f);
+		// If the button was just pressed, the duration begins at the press time
+		if (button.justPressed) {
+			weapon->setLastFireTime(pressTime);
 		}
-		// If the shoot button just released, assume the fire ended half way through
-		newLastFireTime = shootButtonJustReleased ? m_lastOnSimulationRealTime + rdt * 0.5f : currentRealTime;
+		// If the shoot button just released, the fire ended at the release time
+		newLastFireTime = button.justReleased ? releaseTime : currentTime;
 		RealTime fireDuration = weapon->fireDurationUntil(newLastFireTime);
 		damagePerShot = (float)fireDuration * weapon->config()->damagePerSecond;
 	}
@@ -752,19 +867,16 @@ void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
 	m_currentWeaponDamage = damagePerShot; // pass this to the callback where weapon damage is applied
 	bool shotFired = false;
 	for (int shotId = 0; shotId < numShots; shotId++) {
-		Array<shared_ptr<Entity>> dontHit;
-		dontHit.append(m_explosions);
-		dontHit.append(sess->unhittableTargets());
 		Model::HitInfo info;
 		float hitDist = finf();
 		int hitIdx = -1;
 
-		shared_ptr<TargetEntity> target = weapon->fire(sess->hittableTargets(), hitIdx, hitDist, info, dontHit, false);			// Fire the weapon
+		shared_ptr<TargetEntity> target = weapon->fire(sess->hittableTargets(), hitIdx, hitDist, info, m_explosions, false);			// Fire the weapon
 		if (isNull(target)) // Miss case
 		{
 			// Play scene hit sound
 			if (!weapon->config()->isContinuous() && notNull(m_sceneHitSound)) {
-				m_sceneHitSound->play(sessConfig->audio.sceneHitSoundVol);
+				m_sceneHitSound->play(sessConfig->audio->sceneHitSoundVol);
 			}
 		}
 		shotFired = true;
@@ -772,40 +884,137 @@ void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
 	if (shotFired) {
 		weapon->setLastFireTime(newLastFireTime);
 	}
-	weapon->playSound(shotFired, shootButtonUp);
+	weapon->playSound(shotFired, button.up);
+	if (button.justPressed) {
+		m_latencyTracker.onSimulated(System::time(), shotFired);
+	}
+}
 
-	// TODO (or NOTTODO): The following can be cleared at the cost of one more level of inheritance.
-	sess->onSimulation(rdt, sdt, idt);
+void FPSciApp::applyTimedInput(ShootButtonState& button) {
+	const RealTime now = System::time();
+	// Raw input is read even when FPSci isn't focused (RIDEV_INPUTSINK), only fire from presses in first-person mouse mode
+	const bool acceptPresses = window()->hasFocus() && m_mouseInputMode == MouseInputMode::MOUSE_FPM;
+	TimedInputEvent e;
+	while (m_timedInput.popUntil(now, e)) {
+		if (!keyMap.map["shoot"].contains(e.key)) continue;
+		if (e.type == TimedInputEvent::ButtonDown) {
+			if (!acceptPresses) continue;				// Releases are still applied (so the button can't stick down)
+			button.justPressed = true;
+			if (isNaN(button.pressTime)) button.pressTime = e.time;
+			shootButtonUp = false;
+			m_latencyTracker.onInput(e.time);
+		}
+		else {
+			button.justReleased = true;
+			button.releaseTime = e.time;
+			shootButtonUp = true;
+		}
+	}
+	button.up = shootButtonUp;
+}
 
-	// These are all we need from GApp::onSimulation() for walk mode
-	m_widgetManager->onSimulation(rdt, sdt, idt);
-	if (scene()) { scene()->onSimulation(sdt); }
+void FPSciApp::simulationThreadStep(SimTime step) {
+	const shared_ptr<PlayerEntity>& p = scene()->typedEntity<PlayerEntity>("player");
 
-	// make sure mouse sensitivity is set right
-	if (m_userSettingsWindow->visible()) {
-		updateMouseSensitivity();
-	}
+	// Fire w/ the button state handed over by the render thread (against the targets as they were last presented)
+	const RealTime now = System::time();
+	if (m_simThreadTime == 0.0) m_simThreadTime = now;
+	simulateWeapon(m_simThreadTime, now, now - m_simThreadTime, m_simThreadButton);
+	m_simThreadButton.justPressed = false;
+	m_simThreadButton.justReleased = false;
+	m_simThreadButton.pressTime = nan();
+	m_simThreadButton.releaseTime = nan();
+	m_simThreadTime = now;
+
+	// Step from the last simulated state
+	m_interpolator.restore();
+	m_interpolator.clear();
+	for (const shared_ptr<TargetEntity>& target : sess->targetArray()) { m_interpolator.track(target); }
+	for (const shared_ptr<Projectile>& projectile : weapon->projectiles()) { m_interpolator.track(projectile); }
+	m_interpolator.track(p, false);
+	stepWorld(step);
+	if (sess->currentState == PresentationState::trialTask) {
+		sess->accumulateTrajectories();
+	}
+	m_interpolator.update();
+}
 
-	// Simulate the projectiles
-	weapon->simulateProjectiles(sdt, sess->hittableTargets());
+void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
+	// TODO: this should eventually probably use sdt instead of rdt
+	RealTime currentRealTime;
+	if (m_lastOnSimulationRealTime == 0) {
+		m_lastOnSimulationRealTime = System::time();			// Grab the current system time if uninitialized
+		currentRealTime = m_lastOnSimulationRealTime;			// Set this equal to the current system time
+	}
+	else {
+		currentRealTime = m_lastOnSimulationRealTime + rdt;		// Increment the time by the current real time delta
+	}
 
-	// explosion animation
-	for (int i = 0; i < m_explosions.size(); i++) {
-		shared_ptr<VisibleEntity> explosion = m_explosions[i];
-		m_explosionRemainingTimes[i] -= sdt;
-		if (m_explosionRemainingTimes[i] <= 0) {
-			scene()->remove(explosion);
-			m_explosions.fastRemove(i);
-			m_explosionRemainingTimes.fastRemove(i);
-			i--;
+	const shared_ptr<PlayerEntity>& p = scene()->typedEntity<PlayerEntity>("player");
+	const bool threaded = m_simThread.running();
+	// Hold the simulation lock while touching simulated state (when simulating on another thread)
+	std::unique_lock<std::mutex> simLock(m_simThread.mutex(), std::defer_lock);
+	if (threaded) simLock.lock();
+
+	ShootButtonState button;
+	button.justPressed = shootButtonJustPressed;
+	button.justReleased = shootButtonJustReleased;
+	button.up = shootButtonUp;
+	applyTimedInput(button);
+	if (threaded) {
+		// Hand the button state to the simulation thread (it fires the weapon and steps the scene)
+		m_simThreadButton.justPressed |= button.justPressed;
+		m_simThreadButton.justReleased |= button.justReleased;
+		m_simThreadButton.up = button.up;
+		if (isNaN(m_simThreadButton.pressTime)) m_simThreadButton.pressTime = button.pressTime;
+		if (!isNaN(button.releaseTime)) m_simThreadButton.releaseTime = button.releaseTime;
+
+		// Presentation state updates drive the GUI (so stay on this thread)
+		sess->updatePresentationState();
+		p->applyViewRotation();				// View rotation is applied once per frame (not per step) to avoid adding latency
+		m_interpolator.apply(m_simThread.alpha(System::time()));
+	}
+	else {
+		// Event times are System::time() values, move them into this (accumulated) time base
+		const RealTime timeOffset = currentRealTime - System::time();
+		if (!isNaN(button.pressTime)) button.pressTime += timeOffset;
+		if (!isNaN(button.releaseTime)) button.releaseTime += timeOffset;
+		simulateWeapon(m_lastOnSimulationRealTime, currentRealTime, rdt, button);
+
+		if (m_fixedTimestep.enabled()) {
+			// Fixed rate simulation, step from the last simulated state then interpolate between the last two steps for rendering
+			m_interpolator.restore();
+			p->applyViewRotation();				// View rotation is applied once per frame (not per step) to avoid adding latency
+			sess->updatePresentationState();	// As is the presentation state (as when simulating on another thread)
+			const int steps = m_fixedTimestep.advance(sdt);
+			const SimTime step = m_fixedTimestep.step();
+			for (int i = 0; i < steps; i++) {
+				m_interpolator.clear();
+				for (const shared_ptr<TargetEntity>& target : sess->targetArray()) { m_interpolator.track(target); }
+				for (const shared_ptr<Projectile>& projectile : weapon->projectiles()) { m_interpolator.track(projectile); }
+				m_interpolator.track(p, false);
+				stepWorld(step);
+				if (sess->currentState == PresentationState::trialTask) {
+					sess->accumulateTrajectories();
+				}
+			}
+			m_interpolator.update();
+			m_interpolator.apply(m_fixedTimestep.alpha());
 		}
 		else {
-			// could update animation here...
+			stepSimulation(rdt, sdt, idt);
 		}
 	}
 
+	// These are all we need from GApp::onSimulation() for walk mode
+	m_widgetManager->onSimulation(rdt, sdt, idt);
+
+	// make sure mouse sensitivity is set right
+	if (m_userSettingsWindow->visible()) {
+		updateMouseSensitivity();
+	}
+
 	// Move the player
-	const shared_ptr<PlayerEntity>& p = scene()->typedEntity<PlayerEntity>("player");
 	playerCamera->setFrame(p->getCameraFrame());
 	
 	// Handle developer mode features here
@@ -816,8 +1025,8 @@ void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
 		}
 
 		// Handle frame rate/delay updates here
-		if (sessConfig->render.frameRate != lastSetFrameRate || displayLagFrames != sessConfig->render.frameDelay) {
-			updateParameters(sessConfig->render.frameDelay, sessConfig->render.frameRate);
+		if (sessConfig->render->frameRate != lastSetFrameRate || displayLagFrames != sessConfig->render->frameDelay) {
+			updateParameters(sessConfig->render->frameDelay, sessConfig->render->frameRate);
 		}
 
 		if (startupConfig.waypointEditorMode) {
@@ -831,9 +1040,17 @@ void FPSciApp::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
 		// the screen horizontally.
 		debugWindow->setRect(Rect2D::xywh(0.0f, 0.0f, (float)window()->width(), debugWindow->rect().height()));
 	}
+	if (threaded) simLock.unlock();			// Unlock before (possibly) changing sessions, this stops the simulation thread
 	   
-	// Check for completed session
-	if (sess->moveOn) {
+	// Log commands that finished (w/ their exit codes and durations)
+	m_processRunner.takeFinished(m_finishedCommands);
+	for (const CommandProcess& process : m_finishedCommands) {
+		sess->logCommand(process);
+	}
+	m_finishedCommands.fastClear();
+
+	// Check for completed session (after any blocking end of session commands complete)
+	if (sess->moveOn && !sess->waitingOnCommands()) {
 		// Get the next session for the current user
 		updateSession(userStatusTable.getNextSession());
 	}
@@ -873,6 +1090,11 @@ bool FPSciApp::onEvent(const GEvent& event) {
 				updateSession(m_userSettingsWindow->selectedSession());
 				// Do not set foundKey = true to allow shader reloading from GApp::onEvent()
 			}
+			else if (keyMap.map["exportTrace"].contains(ksym)) {
+				const String resultsDirPath = startupConfig.experimentList[experimentIdx].resultsDirPath;
+				TraceRecorder::common().exportChromeTrace(resultsDirPath + "trace_" + FPSciLogger::genFileTimestamp() + ".json");
+				foundKey = true;
+			}
 			// Waypoint editor only keys
 			else if (startupConfig.waypointEditorMode) {
 				if (keyMap.map["toggleWaypointWindow"].contains(ksym)) {
@@ -1031,7 +1253,7 @@ void FPSciApp::onAfterEvents() {
 
 		// Re-create the settings window
 		String selSess = m_userSettingsWindow->selectedSession();
-		m_userSettingsWindow = UserMenu::create(this, userTable, userStatusTable, sessConfig->menu, theme, Rect2D::xywh(0.0f, 0.0f, 10.0f, 10.0f));
+		m_userSettingsWindow = UserMenu::create(this, userTable, userStatusTable, *sessConfig->menu, theme, Rect2D::xywh(0.0f, 0.0f, 10.0f, 10.0f));
 		m_userSettingsWindow->setSelectedSession(selSess);
 		moveToCenter(m_userSettingsWindow);
 		m_userSettingsWindow->setVisible(m_showUserMenu);
@@ -1055,7 +1277,7 @@ void FPSciApp::onAfterEvents() {
 
 Vector2 FPSciApp::currentTurnScale() {
 	const shared_ptr<UserConfig> user = currentUser();
-	Vector2 baseTurnScale = sessConfig->player.turnScale * user->turnScale;
+	Vector2 baseTurnScale = sessConfig->player->turnScale * user->turnScale;
 	// Apply y-invert here
 	if (user->invertY) baseTurnScale.y = -baseTurnScale.y;
 	// If we're not scoped just return the normal user turn scale
@@ -1067,16 +1289,16 @@ Vector2 FPSciApp::currentTurnScale() {
 	}
 	else {
 		// Otherwise scale the scope turn scalue using the ratio of FoV
-		return playerCamera->fieldOfViewAngleDegrees() / sessConfig->render.hFoV * baseTurnScale;
+		return playerCamera->fieldOfViewAngleDegrees() / sessConfig->render->hFoV * baseTurnScale;
 	}
 }
 
 void FPSciApp::setScopeView(bool scoped) {
 	// Get player entity and calculate scope FoV
 	const shared_ptr<PlayerEntity>& player = scene()->typedEntity<PlayerEntity>("player");
-	const float scopeFoV = sessConfig->weapon.scopeFoV > 0 ? sessConfig->weapon.scopeFoV : sessConfig->render.hFoV;
+	const float scopeFoV = sessConfig->weapon->scopeFoV > 0 ? sessConfig->weapon->scopeFoV : sessConfig->render->hFoV;
 	weapon->setScoped(scoped);														// Update the weapon state		
-	const float FoV = (scoped ? scopeFoV : sessConfig->render.hFoV);					// Get new FoV in degrees (depending on scope state)
+	const float FoV = (scoped ? scopeFoV : sessConfig->render->hFoV);					// Get new FoV in degrees (depending on scope state)
 	playerCamera->setFieldOfView(FoV * pif() / 180.f, FOVDirection::HORIZONTAL);		// Set the camera FoV
 	player->turnScale = currentTurnScale();												// Scale sensitivity based on the field of view change here
 }
@@ -1088,17 +1310,17 @@ void FPSciApp::hitTarget(shared_ptr<TargetEntity> target) {
 	target->playHitSound();
 
 	// Check if we need to add combat text for this damage
-	if (sessConfig->targetView.showCombatText) {
+	if (sessConfig->targetView->showCombatText) {
 		m_combatTextList.append(FloatingCombatText::create(
 			format("%2.0f", 100.f * damage),
 			m_combatFont,
-			sessConfig->targetView.combatTextSize,
-			sessConfig->targetView.combatTextColor,
-			sessConfig->targetView.combatTextOutline,
-			sessConfig->targetView.combatTextOffset,
-			sessConfig->targetView.combatTextVelocity,
-			sessConfig->targetView.combatTextFade,
-			sessConfig->targetView.combatTextTimeout));
+			sessConfig->targetView->combatTextSize,
+			sessConfig->targetView->combatTextColor,
+			sessConfig->targetView->combatTextOutline,
+			sessConfig->targetView->combatTextOffset,
+			sessConfig->targetView->combatTextVelocity,
+			sessConfig->targetView->combatTextFade,
+			sessConfig->targetView->combatTextTimeout));
 		m_combatTextList.last()->setFrame(target->frame());
 	}
 
@@ -1109,7 +1331,7 @@ void FPSciApp::hitTarget(shared_ptr<TargetEntity> target) {
 		// Handle reference target here
 		sess->destroyTarget(target);
 		destroyedTarget = true;
-		sess->accumulatePlayerAction(PlayerActionType::Nontask, target->name());
+		sess->accumulatePlayerAction(PlayerActionType::Nontask, target->logName());
 
 	}
 	else if (target->health() <= 0) {
@@ -1125,7 +1347,7 @@ void FPSciApp::hitTarget(shared_ptr<TargetEntity> target) {
 		);
 		m_explosionIdx++;
 		m_explosionIdx %= m_maxExplosions;
-		scene()->insert(newExplosion);
+		typedScene<PhysicsScene>()->insertOrQueue(newExplosion);
 		m_explosions.push(newExplosion);
 		m_explosionRemainingTimes.push(experimentConfig.getTargetConfigById(target->id())->destroyDecalDuration); // Schedule end of explosion
 		target->playDestroySound();
@@ -1140,11 +1362,11 @@ void FPSciApp::hitTarget(shared_ptr<TargetEntity> target) {
 			destroyedTarget = true;
 		}
 		// Target eliminated, must be 'destroy'.
-		sess->accumulatePlayerAction(PlayerActionType::Destroy, target->name());
+		sess->accumulatePlayerAction(PlayerActionType::Destroy, target->logName());
 	}
 	else {
 		// Target 'hit', but still alive.
-		sess->accumulatePlayerAction(PlayerActionType::Hit, target->name());
+		sess->accumulatePlayerAction(PlayerActionType::Hit, target->logName());
 	}
 	if (!destroyedTarget || respawned) {
 		if (respawned) {
@@ -1156,18 +1378,18 @@ void FPSciApp::hitTarget(shared_ptr<TargetEntity> target) {
 }
 
 void FPSciApp::updateTargetColor(const shared_ptr<TargetEntity>& target) {
-	BEGIN_PROFILER_EVENT("updateTargetColor/changeColor");
-	BEGIN_PROFILER_EVENT("updateTargetColor/clone");
+	BEGIN_TRACE_EVENT("updateTargetColor/changeColor");
+	BEGIN_TRACE_EVENT("updateTargetColor/clone");
 	shared_ptr<ArticulatedModel::Pose> pose = dynamic_pointer_cast<ArticulatedModel::Pose>(target->pose()->clone());
-	END_PROFILER_EVENT();
-	BEGIN_PROFILER_EVENT("updateTargetColor/materialSet");
+	END_TRACE_EVENT();
+	BEGIN_TRACE_EVENT("updateTargetColor/materialSet");
 	shared_ptr<UniversalMaterial> mat = m_materials[min((int)(target->health() * m_MatTableSize), m_MatTableSize - 1)];
 	pose->materialTable.set("core/icosahedron_default", mat);
-	END_PROFILER_EVENT();
-	BEGIN_PROFILER_EVENT("updateTargetColor/setPose");
+	END_TRACE_EVENT();
+	BEGIN_TRACE_EVENT("updateTargetColor/setPose");
 	target->setPose(pose);
-	END_PROFILER_EVENT();
-	END_PROFILER_EVENT();
+	END_TRACE_EVENT();
+	END_TRACE_EVENT();
 }
 
 void FPSciApp::missEvent() {
@@ -1178,10 +1400,17 @@ void FPSciApp::missEvent() {
 
 /** Handle user input here */
 void FPSciApp::onUserInput(UserInput* ui) {
-	BEGIN_PROFILER_EVENT("onUserInput");
+	BEGIN_TRACE_EVENT("onUserInput");
+
+	// Hold the simulation lock while updating the player/weapon (when simulating on another thread)
+	std::unique_lock<std::mutex> simLock(m_simThread.mutex(), std::defer_lock);
+	if (m_simThread.running()) simLock.lock();
 
 	GApp::onUserInput(ui);
 
+	// Mouse motion received up to now is included in this frame's input (the late latch only adds motion after this)
+	m_rawInput.motion(m_latchMotionX, m_latchMotionY);
+
 	const shared_ptr<PlayerEntity>& player = scene()->typedEntity<PlayerEntity>("player");
 	if (m_mouseInputMode == MouseInputMode::MOUSE_FPM && activeCamera() == playerCamera && notNull(player)) {
 		player->updateFromInput(ui);		// Only update the player if the mouse input mode is FPM and the active camera is the player view camera
@@ -1195,7 +1424,7 @@ void FPSciApp::onUserInput(UserInput* ui) {
 	for (GKey scopeButton : keyMap.map["scope"]) {
 		if (ui->keyPressed(scopeButton)) {
 			// Are we using scope toggling?
-			if (sessConfig->weapon.scopeToggle) {
+			if (sessConfig->weapon->scopeToggle) {
 				setScopeView(!weapon->scoped());
 			}
 			// Otherwise just set scope based on the state of the scope button
@@ -1203,7 +1432,7 @@ void FPSciApp::onUserInput(UserInput* ui) {
 				setScopeView(true);
 			}
 		}
-		if (ui->keyReleased(scopeButton) && !sessConfig->weapon.scopeToggle) {
+		if (ui->keyReleased(scopeButton) && !sessConfig->weapon->scopeToggle) {
 			setScopeView(false);
 		}
 	}
@@ -1211,12 +1440,16 @@ void FPSciApp::onUserInput(UserInput* ui) {
 	// Record button state changes
 	// These will be evaluated and reset on the next onSimulation()
 	for (GKey shootButton : keyMap.map["shoot"]) {
+		// Mouse buttons come (timestamped) from the raw input thread when it is running
+		const bool mouseButton = shootButton == GKey::LEFT_MOUSE || shootButton == GKey::MIDDLE_MOUSE || shootButton == GKey::RIGHT_MOUSE;
+		if (mouseButton && m_rawInput.running()) continue;
 		if (ui->keyReleased(shootButton)) {
 			shootButtonJustReleased = true;
 			shootButtonUp = true;
 		}
 		if (ui->keyPressed(shootButton)) {
 			shootButtonJustPressed = true;
+			m_latencyTracker.onInput(System::time());		// Timestamp the press for the software latency tracker
 		}
 		if (ui->keyDown(shootButton)) {
 			shootButtonUp = false;
@@ -1232,13 +1465,10 @@ void FPSciApp::onUserInput(UserInput* ui) {
 	
 	for (GKey dummyShoot : keyMap.map["dummyShoot"]) {
 		if (ui->keyPressed(dummyShoot) && (sess->currentState == PresentationState::trialFeedback) && !m_userSettingsWindow->visible()) {
-			Array<shared_ptr<Entity>> dontHit;
-			dontHit.append(m_explosions);
-			dontHit.append(sess->unhittableTargets());
 			Model::HitInfo info;
 			float hitDist = finf();
 			int hitIdx = -1;
-			shared_ptr<TargetEntity> target = weapon->fire(sess->hittableTargets(), hitIdx, hitDist, info, dontHit, true);			// Fire the weapon
+			shared_ptr<TargetEntity> target = weapon->fire(sess->hittableTargets(), hitIdx, hitDist, info, m_explosions, true);			// Fire the weapon
 		}
 	}
 
@@ -1249,15 +1479,154 @@ void FPSciApp::onUserInput(UserInput* ui) {
 	}
 
 	playerCamera->filmSettings().setSensitivity(sceneBrightness);
-    END_PROFILER_EVENT();
+    END_TRACE_EVENT();
 }
 
 void FPSciApp::onPose(Array<shared_ptr<Surface> >& surface, Array<shared_ptr<Surface2D> >& surface2D) {
+	// Hold the simulation lock while posing (when simulating on another thread), the posed surfaces, camera frames
+	// (only written on this thread) and m_renderState are all the render reads, so it doesn't need the lock
+	std::unique_lock<std::mutex> simLock(m_simThread.mutex(), std::defer_lock);
+	if (m_simThread.running()) simLock.lock();
+
+	// Apply the entity inserts/removals the simulation thread queued (see PhysicsScene::setQueueChanges())
+	typedScene<PhysicsScene>()->applyQueuedChanges();
+
+	// Render the simulation state from displayLagFrames ago (when delaying state instead of framebuffers)
+	const bool delayState = displayLagFrames > 0 && sessConfig->render->frameDelayMode == "state";
+	if (delayState) applyDelayedState();
+
 	GApp::onPose(surface, surface2D);
 
 	typedScene<PhysicsScene>()->poseExceptExcluded(surface, "player");
 
-	if (weapon) { weapon->onPose(surface); }
+	if (delayState) poseAndRestoreDelayedState(surface);
+
+	// The view model kicks w/ the (delayed) presented state too
+	if (weapon) { weapon->onPose(surface, delayState ? m_stateDelayQueue.delayed().time : System::time()); }
+
+	captureRenderState(delayState);
+}
+
+void FPSciApp::captureRenderState(bool delayState) {
+	RenderState& state = m_renderState;
+	state.time = delayState ? m_stateDelayQueue.delayed().time : System::time();
+
+	// Target health bars (as of the delayed state, when delaying state instead of framebuffers)
+	state.healthBars.fastClear();
+	if (delayState) {
+		state.healthBars.append(m_stateDelayQueue.delayed().healthBars);
+	}
+	else {
+		for (const shared_ptr<TargetEntity>& target : sess->targetArray()) {
+			if (!target->visible()) continue;			// Pre-spawned targets are hidden until the task starts
+			StateSnapshot::HealthBar& bar = state.healthBars.next();
+			bar.position = target->frame().translation;
+			bar.health = target->health();
+		}
+	}
+
+	// Drop expired combat text (the simulation thread appends to this list)
+	for (int i = 0; i < m_combatTextList.size(); i++) {
+		if (m_combatTextList[i]->expired(state.time)) m_combatTextList[i] = nullptr;		// Null pointers to remove
+	}
+	m_combatTextList.removeNulls();
+	state.combatText.fastClear();
+	state.combatText.append(m_combatTextList);
+
+	// Weapon/player/session status for the HUD
+	if (notNull(weapon)) {
+		state.weaponCooldown = weapon->cooldownRatio(m_lastOnSimulationRealTime);
+		state.reticleCooldown = weapon->cooldownRatio(m_lastOnSimulationRealTime, currentUser()->reticleChangeTimeS);
+		state.remainingAmmo = weapon->remainingAmmo();
+	}
+	const shared_ptr<PlayerEntity>& player = scene()->typedEntity<PlayerEntity>("player");
+	if (notNull(player)) state.playerHealth = player->health();
+	if (notNull(sess)) {
+		state.remainingTrialTime = sess->getRemainingTrialTime();
+		state.progress = sess->getProgress();
+		state.score = sess->getScore();
+	}
+}
+
+void FPSciApp::applyDelayedState() {
+	m_stateDelayQueue.setDelay(displayLagFrames);
+
+	// Capture the state to present this frame
+	StateSnapshot& current = m_stateDelayQueue.next();
+	current.time = System::time();
+	current.camera = playerCamera->frame();
+	m_stateDelayEntities.fastClear();
+	scene()->getEntityArray(m_stateDelayEntities);
+	for (const shared_ptr<Entity>& entity : m_stateDelayEntities) {
+		if (entity->name() == "player") continue;
+		current.add(entity, entity->frame(), dynamic_cast<VisibleEntity*>(entity.get()));
+	}
+	for (const shared_ptr<TargetEntity>& target : sess->targetArray()) {
+		if (!target->visible()) continue;
+		StateSnapshot::HealthBar& bar = current.healthBars.next();
+		bar.position = target->frame().translation;
+		bar.health = target->health();
+	}
+	const StateSnapshot& delayed = m_stateDelayQueue.advance();
+
+	// Move the camera and entities to the delayed state (hiding entities that didn't exist yet)
+	m_stateDelayCameraFrame = current.camera;
+	playerCamera->setFrame(delayed.camera);
+	m_stateDelayApplied = true;
+	for (int i = 0; i < current.entities.size(); i++) {
+		const int idx = delayed.indexOf(current.entities[i]);
+		if (idx >= 0) {
+			delayed.apply(idx);
+		}
+		else if (notNull(current.visibleEntities[i])) {
+			current.visibleEntities[i]->setVisible(false);
+		}
+	}
+}
+
+void FPSciApp::poseAndRestoreDelayedState(Array<shared_ptr<Surface> >& posed3D) {
+	const StateSnapshot& current = m_stateDelayQueue.current();
+	const StateSnapshot& delayed = m_stateDelayQueue.delayed();
+
+	// Entities removed from the scene since the delayed state was captured are still presented
+	for (int i = 0; i < delayed.entities.size(); i++) {
+		if (delayed.visible[i] && current.indexOf(delayed.entities[i]) < 0) {
+			delayed.apply(i);
+			delayed.entities[i]->onPose(posed3D);
+		}
+	}
+
+	// Put the entities back at their live frames (and visibility)
+	for (int i = 0; i < current.entities.size(); i++) {
+		current.apply(i);
+	}
+}
+
+void FPSciApp::lateLatchView() {
+	m_lateLatchRotation = Vector2::zero();
+	if (!sessConfig->render->lateLatch || !m_rawInput.running() || m_stateDelayApplied) return;
+	if (m_mouseInputMode != MouseInputMode::MOUSE_FPM || activeCamera() != playerCamera || m_userSettingsWindow->visible()) return;
+
+	// The simulation thread (if running) steps the player and fires from the player camera frame
+	std::unique_lock<std::mutex> simLock(m_simThread.mutex(), std::defer_lock);
+	if (m_simThread.running()) simLock.lock();
+
+	const shared_ptr<PlayerEntity>& player = scene()->typedEntity<PlayerEntity>("player");
+	if (isNull(player)) return;
+
+	// Rotate by the motion since the input stage (translation is unchanged). The player's own rotation picks this motion
+	// up from the next frame's input, and weapon fire until then uses this (displayed) camera frame.
+	int64 x, y;
+	m_rawInput.motion(x, y);
+	m_lateLatchRotation = player->mouseRotation(Vector2((float)(x - m_latchMotionX), (float)(y - m_latchMotionY)));
+	if (m_lateLatchRotation.isZero()) return;
+	playerCamera->setFrame(player->getRotatedCameraFrame(m_lateLatchRotation.x, m_lateLatchRotation.y));
+}
+
+void FPSciApp::restoreDelayedCamera() {
+	if (!m_stateDelayApplied) return;
+	playerCamera->setFrame(m_stateDelayCameraFrame);
+	m_stateDelayApplied = false;
 }
 
 /** Set the currently reticle by index */
@@ -1277,12 +1646,16 @@ void FPSciApp::setReticle(const int r) {
 void FPSciApp::onCleanup() {
 	// Called after the application loop ends.  Place a majority of cleanup code
 	// here instead of in the constructor so that exceptions can be caught.
+	m_simThread.stop();
+	m_rawInput.stop();
+	TextLogSink::common().stop();			// Write out any pending log records
 }
 
 /** Overridden (optimized) oneFrame() function to improve latency */
 void FPSciApp::oneFrame() {
 	// Count this frame (for shaders)
 	m_frameNumber++;
+	m_stageCounters.beginFrame();
 
     // Wait
     // Note: we might end up spending all of our time inside of
@@ -1290,7 +1663,8 @@ void FPSciApp::oneFrame() {
     // though, because while we're sleeping the CPU the GPU is working
     // to catch up.    
     if ((submitToDisplayMode() == SubmitToDisplayMode::MINIMIZE_LATENCY)) {
-        BEGIN_PROFILER_EVENT("Wait");
+        BEGIN_TRACE_EVENT("Wait");
+        m_stageCounters.begin(StageCounters::Wait);
         m_waitWatch.tick(); {
             RealTime nowAfterLoop = System::time();
 
@@ -1305,7 +1679,13 @@ void FPSciApp::oneFrame() {
                 duration = 1.0 / 4.0;
             }
             RealTime desiredWaitTime = max(0.0, duration - cumulativeTime);
-            onWait(max(0.0, desiredWaitTime - m_lastFrameOverWait) * 0.97);
+            m_frameMissedDeadline = (desiredWaitTime <= 0.0);
+            if (systemConfig.preciseFramePacing) {
+                m_framePacer.waitUntil(nowAfterLoop + desiredWaitTime);
+            }
+            else {
+                onWait(max(0.0, desiredWaitTime - m_lastFrameOverWait) * 0.97);
+            }
 
             // Update wait timers
             m_lastWaitTime = System::time();
@@ -1322,7 +1702,8 @@ void FPSciApp::oneFrame() {
                 m_lastFrameOverWait = lerp(m_lastFrameOverWait, thisOverWait, 0.1);
             }
         }  m_waitWatch.tock();
-        END_PROFILER_EVENT();
+        m_stageCounters.end(StageCounters::Wait);
+        END_TRACE_EVENT();
     }
 
     for (int repeat = 0; repeat < max(1, m_renderPeriod); ++repeat) {
@@ -1332,6 +1713,7 @@ void FPSciApp::oneFrame() {
         RealTime timeStep = m_now - m_lastTime;
 
         // User input
+        m_stageCounters.begin(StageCounters::Input);
         m_userInputWatch.tick();
         if (manageUserInput) {
             processGEventQueue();
@@ -1339,13 +1721,14 @@ void FPSciApp::oneFrame() {
         onAfterEvents();
         onUserInput(userInput);
         m_userInputWatch.tock();
+        m_stageCounters.end(StageCounters::Input);
 
         // Network
-        BEGIN_PROFILER_EVENT("GApp::onNetwork");
+        BEGIN_TRACE_EVENT("GApp::onNetwork");
         m_networkWatch.tick();
         onNetwork();
         m_networkWatch.tock();
-        END_PROFILER_EVENT();
+        END_TRACE_EVENT();
 
         // Logic
         m_logicWatch.tick();
@@ -1355,8 +1738,9 @@ void FPSciApp::oneFrame() {
         m_logicWatch.tock();
 
         // Simulation
+        m_stageCounters.begin(StageCounters::Simulation);
         m_simulationWatch.tick();
-        BEGIN_PROFILER_EVENT("Simulation");
+        BEGIN_TRACE_EVENT("Simulation");
         {
             RealTime rdt = timeStep;
 
@@ -1381,12 +1765,14 @@ void FPSciApp::oneFrame() {
             setSimTime(simTime() + sdt);
         }
         m_simulationWatch.tock();
-        END_PROFILER_EVENT();
+        m_stageCounters.end(StageCounters::Simulation);
+        END_TRACE_EVENT();
     }
 
 
     // Pose
-    BEGIN_PROFILER_EVENT("Pose");
+    BEGIN_TRACE_EVENT("Pose");
+    m_stageCounters.begin(StageCounters::Pose);
     m_poseWatch.tick(); {
         m_posed3D.fastClear();
         m_posed2D.fastClear();
@@ -1397,7 +1783,8 @@ void FPSciApp::oneFrame() {
         // it allows us to trigger the TAA code.
 		playerCamera->onPose(m_posed3D);
     } m_poseWatch.tock();
-    END_PROFILER_EVENT();
+    m_stageCounters.end(StageCounters::Pose);
+    END_TRACE_EVENT();
 
     // Wait
     // Note: we might end up spending all of our time inside of
@@ -1405,7 +1792,8 @@ void FPSciApp::oneFrame() {
     // though, because while we're sleeping the CPU the GPU is working
     // to catch up.    
     if ((submitToDisplayMode() != SubmitToDisplayMode::MINIMIZE_LATENCY)) {
-        BEGIN_PROFILER_EVENT("Wait");
+        BEGIN_TRACE_EVENT("Wait");
+        m_stageCounters.begin(StageCounters::Wait);
         m_waitWatch.tick(); {
             RealTime nowAfterLoop = System::time();
 
@@ -1420,7 +1808,13 @@ void FPSciApp::oneFrame() {
                 duration = 1.0 / 4.0;
             }
             RealTime desiredWaitTime = max(0.0, duration - cumulativeTime);
-            onWait(max(0.0, desiredWaitTime - m_lastFrameOverWait) * 0.97);
+            m_frameMissedDeadline = (desiredWaitTime <= 0.0);
+            if (systemConfig.preciseFramePacing) {
+                m_framePacer.waitUntil(nowAfterLoop + desiredWaitTime);
+            }
+            else {
+                onWait(max(0.0, desiredWaitTime - m_lastFrameOverWait) * 0.97);
+            }
 
             // Update wait timers
             m_lastWaitTime = System::time();
@@ -1437,24 +1831,34 @@ void FPSciApp::oneFrame() {
                 m_lastFrameOverWait = lerp(m_lastFrameOverWait, thisOverWait, 0.1);
             }
         }  m_waitWatch.tock();
-        END_PROFILER_EVENT();
+        m_stageCounters.end(StageCounters::Wait);
+        END_TRACE_EVENT();
     }
 
     // Graphics
     debugAssertGLOk();
     if ((submitToDisplayMode() == SubmitToDisplayMode::BALANCE) && (!renderDevice->swapBuffersAutomatically())) {
+        m_stageCounters.begin(StageCounters::Swap);
+        m_swapWatch.tick();
         swapBuffers();
+        m_swapWatch.tock();
+        m_latencyTracker.onPresent(System::time());
+        m_stageCounters.end(StageCounters::Swap);
     }
 
     if (notNull(m_gazeTracker)) {
-        BEGIN_PROFILER_EVENT("Gaze Tracker");
+        BEGIN_TRACE_EVENT("Gaze Tracker");
         sampleGazeTrackerData();
-        END_PROFILER_EVENT();
+        END_TRACE_EVENT();
     }
 
-    BEGIN_PROFILER_EVENT("Graphics");
+    lateLatchView();
+
+    BEGIN_TRACE_EVENT("Graphics");
     renderDevice->beginFrame();
     m_widgetManager->onBeforeGraphics();
+    m_stageCounters.begin(StageCounters::Graphics);
+    const RealTime renderStartTime = System::time();
     m_graphicsWatch.tick(); {
         debugAssertGLOk();
         renderDevice->pushState(); {
@@ -1462,11 +1866,71 @@ void FPSciApp::oneFrame() {
             onGraphics(renderDevice, m_posed3D, m_posed2D);
         } renderDevice->popState();
     }  m_graphicsWatch.tock();
+    m_stageCounters.end(StageCounters::Graphics);
+    m_latencyTracker.onRendered(renderStartTime, System::time());
+    restoreDelayedCamera();
     renderDevice->endFrame();
+    if (renderDevice->swapBuffersAutomatically()) {
+        m_latencyTracker.onPresent(System::time());		// Buffers are swapped in endFrame()
+    }
     if ((submitToDisplayMode() == SubmitToDisplayMode::MINIMIZE_LATENCY) && (!renderDevice->swapBuffersAutomatically())) {
+        m_stageCounters.begin(StageCounters::Swap);
+        m_swapWatch.tick();
         swapBuffers();
+        m_swapWatch.tock();
+        m_latencyTracker.onPresent(System::time());
+        m_stageCounters.end(StageCounters::Swap);
+    }
+    END_TRACE_EVENT();
+
+    // Log the timing breakdown for this frame
+    if (notNull(sess)) {
+        FrameInfo info(FPSciLogger::getFileTime(), m_previousSimTimeStep);
+        info.frameNumber = m_frameNumber;
+        info.rdt = m_previousRealTimeStep;
+        info.idt = (float)m_wallClockTargetDuration;
+        info.inputTime = (float)m_userInputWatch.elapsedTime();
+        info.simulationTime = (float)m_simulationWatch.elapsedTime();
+        info.poseTime = (float)m_poseWatch.elapsedTime();
+        info.waitTime = (float)m_waitWatch.elapsedTime();
+        info.graphicsTime = (float)m_graphicsWatch.elapsedTime();
+        info.swapTime = (float)m_swapWatch.elapsedTime();
+        info.missedDeadline = m_frameMissedDeadline;
+        info.view = sess->getViewDirection();
+        info.lateLatch = m_lateLatchRotation / units::degrees();
+        sess->accumulateFrameInfo(info);
+        if (m_stageCounters.enabled()) sess->accumulateStageCounters(m_stageCounters.endFrame());
+
+        // Log the software latency of any shots presented this frame
+        m_latencyTracker.takeCompleted(m_completedShots);
+        for (const ShotLatency& shot : m_completedShots) {
+            sess->logShotLatency(shot);
+        }
+
+        // Check for a hitch (frame well over its time budget)
+        const RealTime frameEndTime = System::time();
+        const RealTime frameTime = frameEndTime - m_lastFrameEndTime;
+        if (m_lastFrameEndTime > 0.0 && m_wallClockTargetDuration > 0.0 && frameTime > sessConfig->logger->hitchThreshold * m_wallClockTargetDuration) {
+            HitchInfo hitch;
+            hitch.frame = info;
+            hitch.frameTime = (float)frameTime;
+            hitch.budget = (float)m_wallClockTargetDuration;
+            // Only summarize the recent trace zones when hitches are logged (otherwise they are just counted, e.g. for %sessHitches)
+            if (sessConfig->logger->logHitches) hitch.zones = TraceRecorder::common().recentEventsToString(HitchZoneCount);
+            sess->logHitch(hitch);
+        }
+        m_lastFrameEndTime = frameEndTime;
+
+        // Update the adaptive quality level using the frame's work time (excluding time spent waiting for the frame deadline)
+        if (m_qualityController.enabled()) {
+            const int prevLevel = m_qualityController.level();
+            const float workTime = info.inputTime + info.simulationTime + info.poseTime + info.graphicsTime + info.swapTime;
+            if (m_qualityController.addFrameTime(workTime)) {
+                sess->logQualityChange(m_frameNumber, prevLevel, m_qualityController.level(), m_qualityController.current().name,
+                    m_qualityController.meanFrameTime(), (float)(1.0 / sessConfig->render->frameRate));
+            }
+        }
     }
-    END_PROFILER_EVENT();
 
     // Remove all expired debug shapes
     for (int i = 0; i < debugShapeArray.size(); ++i) {
@@ -24,6 +24,15 @@
 #include "PythonLogger.h"
 #include "Weapon.h"
 #include "CombatText.h"
+#include "SessionJournal.h"
+#include "FramePacer.h"
+#include "FixedTimestep.h"
+#include "SimulationThread.h"
+#include "QualityController.h"
+#include "LatencyTracker.h"
+#include "RawInputThread.h"
+#include "StateDelayQueue.h"
+#include "ProcessRunner.h"
 
 class Session;
 class DialogBase;
@@ -35,6 +44,29 @@ class WaypointManager;
 // feedback: feedback showing whether task performance was successful or not.
 enum PresentationState { initial, pretrial, trialTask, trialFeedback, sessionFeedback, complete };
 
+/** Shoot button state changes (since the last simulation) */
+struct ShootButtonState {
+	bool justPressed = false;
+	bool justReleased = false;
+	bool up = true;
+	RealTime pressTime = nan();			///< Time of the (first) press, if timestamped (see TimedInputQueue)
+	RealTime releaseTime = nan();		///< Time of the (last) release, if timestamped (see TimedInputQueue)
+};
+
+/** Simulated state drawn in the 2D/HUD passes, captured in onPose() so rendering doesn't need the simulation lock */
+struct RenderState {
+	Array<StateSnapshot::HealthBar>			healthBars;							///< Health bars of the visible targets
+	Array<shared_ptr<FloatingCombatText>>	combatText;							///< Combat text to draw (storage reused between frames)
+	RealTime								time = 0.0;							///< Time the combat text is drawn at (the delayed state time when delaying state)
+	float									weaponCooldown = 0.0f;				///< Weapon cooldown ratio (for the HUD)
+	float									reticleCooldown = 0.0f;				///< Weapon cooldown ratio over the reticle change time
+	int										remainingAmmo = 0;
+	float									playerHealth = 1.0f;
+	float									remainingTrialTime = 0.0f;
+	float									progress = 0.0f;
+	int										score = 0;
+};
+
 class FPSciApp : public GApp {
 public:
 	enum MouseInputMode {					///< Enumerated type for controlling the mouse input mode
@@ -50,7 +82,7 @@ protected:
 	shared_ptr<GFont>						m_combatFont;						///< Font used for floating combat text
 	Array<shared_ptr<FloatingCombatText>>	m_combatTextList;					///< Array of existing combat text
 
-	Array<shared_ptr<VisibleEntity>>		m_explosions;						///< Model for target destroyed decal
+	Array<shared_ptr<Entity>>				m_explosions;						///< Target destroyed decals (also the entities shots ignore)
 	Array<RealTime>							m_explosionRemainingTimes;			///< Time for end of explosion
 	int										m_explosionIdx = 0;					///< Explosion index
 	const int								m_maxExplosions = 20;				///< Maximum number of simultaneous explosions
@@ -82,12 +114,42 @@ protected:
 	String									m_defaultSceneName = "FPSci Simple Hallway";	// Default scene to load
 
 	String									m_expConfigHash;					///< String hash of experiment config file
+	uint32									m_randomSeed = 0;					///< Seed used for Random::common()
+	SessionJournal::State					m_resumeState;						///< Interrupted session (from the session journal) to resume
+	FramePacer								m_framePacer;						///< Hybrid sleep/spin frame pacer (when systemConfig.preciseFramePacing is set)
+	FixedTimestep							m_fixedTimestep;					///< Accumulator for fixed rate simulation (when sessConfig->render->simulationRate is set)
+	EntityInterpolator						m_interpolator;						///< Interpolates rendered entity frames between fixed rate simulation steps
+	SimulationThread						m_simThread;						///< Runs the simulation on its own thread (when systemConfig.simulationThread is set)
+	ShootButtonState						m_simThreadButton;					///< Shoot button state handed to the simulation thread (guarded by m_simThread.mutex())
+	RealTime								m_simThreadTime = 0.0;				///< Wall clock time of the last simulation thread step
+	Stopwatch								m_swapWatch;						///< Timing for swapBuffers (other stages are timed by GApp)
+	bool									m_frameMissedDeadline = false;		///< Whether the current frame had no time left to wait
+	RealTime								m_lastFrameEndTime = 0.0;			///< End time of the last frame (for hitch detection)
+	static const int						HitchZoneCount = 300;				///< Number of (most recent) profiler zone events to store w/ each hitch
+	QualityController						m_qualityController;				///< Adaptive quality level (when sessConfig->render->adaptiveQuality is set)
+	Array<shared_ptr<Light>>				m_shadowlessLights;					///< Lights w/ shadows disabled by the current quality level
+	StageCounters							m_stageCounters;					///< CPU counters by frame stage (when sessConfig->logger->logPerfCounters is set)
+	LatencyTracker							m_latencyTracker;					///< Software input to present latency of each shot (when sessConfig->logger->logShotLatency is set)
+	Array<ShotLatency>						m_completedShots;					///< Shots presented this frame (storage reused across frames)
+	TimedInputQueue							m_timedInput;						///< Timestamped shoot button events (from m_rawInput or injected by tests)
+	RawInputThread							m_rawInput;							///< Reads raw mouse buttons at device rate (when systemConfig.rawInputThread is set)
+	ProcessRunner							m_processRunner;					///< Runs session/trial commands (outlives sessions so end commands can complete)
+	Array<CommandProcess>					m_finishedCommands;					///< Commands finished this frame (storage reused across frames)
 
 	shared_ptr<PythonLogger>				m_pyLogger = nullptr;
 
 	/** When m_displayLagFrames > 0, 3D frames are delayed in this queue */
 	Array<shared_ptr<Framebuffer>>			m_ldrDelayBufferQueue;
 	int										m_currentDelayBufferIndex = 0;
+	/** When m_displayLagFrames > 0 and sessConfig->render->frameDelayMode is "state", the rendered state is delayed in this queue instead */
+	StateDelayQueue							m_stateDelayQueue;
+	Array<shared_ptr<Entity>>				m_stateDelayEntities;				///< Scene entities (storage reused between frames)
+	CFrame									m_stateDelayCameraFrame;			///< Live player camera frame (restored after rendering a delayed state)
+	bool									m_stateDelayApplied = false;		///< Whether the player camera is currently set to a delayed state
+	RenderState								m_renderState;						///< Simulated state drawn this frame (captured in onPose())
+	int64									m_latchMotionX = 0;					///< Raw mouse motion (m_rawInput.motion()) already delivered by the input stage
+	int64									m_latchMotionY = 0;
+	Vector2									m_lateLatchRotation;				///< Rotation (yaw, pitch in radians) applied by the late latch this frame
 
     shared_ptr<UserMenu>					m_userSettingsWindow;				///< User settings window
 	MouseInputMode							m_mouseInputMode = MouseInputMode::MOUSE_CURSOR;	///< Does the mouse currently have control over the view
@@ -198,6 +260,11 @@ public:
 
 	int			experimentIdx = 0;				///< Index of the current experiment
 
+	/** Queue of timestamped shoot button events consumed by onSimulation() */
+	TimedInputQueue& timedInput() { return m_timedInput; }
+	/** Runner for session and trial commands */
+	ProcessRunner& processRunner() { return m_processRunner; }
+
 	/** Call to change the reticle. */
 	void setReticle(int r);
 	/** Show the player controls */
@@ -229,6 +296,10 @@ public:
 	shared_ptr<UserConfig> const currentUser(void) {  return userTable.getUserById(userStatusTable.currentUser); }
 
 	void markSessComplete(String id);
+	/** Seed used for Random::common() (logged to the session journal) */
+	uint32 randomSeed() const { return m_randomSeed; }
+	/** Filename for the session journal of the current user */
+	String sessionJournalFilename();
 	/** Updates experiment state to the provided session id and updates player parameters (including mouse sensitivity) */
 	virtual void updateSession(const String& id, bool forceReload = false);
 	void updateParameters(int frameDelay, float frameRate);
@@ -254,7 +325,27 @@ public:
 	virtual void onAI() override;
 	virtual void onNetwork() override;
 	virtual void onSimulation(RealTime rdt, SimTime sdt, SimTime idt) override;
+	/** Advance the session, scene, and projectiles by a single simulation step */
+	void stepSimulation(RealTime rdt, SimTime sdt, SimTime idt);
+	/** Advance the scene, projectiles, and explosions (but not the session) by a single simulation step */
+	void stepWorld(SimTime sdt);
+	/** Fire the weapon (if requested by the shoot button state) for the simulation interval ending at currentTime */
+	void simulateWeapon(RealTime lastTime, RealTime currentTime, RealTime rdt, const ShootButtonState& button);
+	/** Apply timestamped shoot button events received up to now to the button state (and shootButtonUp) */
+	void applyTimedInput(ShootButtonState& button);
+	/** Simulation step run on the simulation thread (when systemConfig.simulationThread is set) */
+	void simulationThreadStep(SimTime step);
 	virtual void onPose(Array<shared_ptr<Surface> >& posed3D, Array<shared_ptr<Surface2D> >& posed2D) override;
+	/** Capture the current state and move the player camera and scene entities to the delayed state (frameDelayMode = "state") */
+	void applyDelayedState();
+	/** Pose entities from the delayed state that have since been removed from the scene, then restore the entities' live frames */
+	void poseAndRestoreDelayedState(Array<shared_ptr<Surface> >& posed3D);
+	/** Copy the simulated state the 2D/HUD passes draw into m_renderState (call w/ the simulation lock held) */
+	void captureRenderState(bool delayState);
+	/** Restore the live player camera frame (after rendering a delayed state) */
+	void restoreDelayedCamera();
+	/** Rotate the player camera by the mouse motion received since the input stage (sessConfig->render->lateLatch), call right before rendering */
+	void lateLatchView();
 	virtual void onAfterLoadScene(const Any& any, const String& sceneName) override;
 	virtual bool onEvent(const GEvent& e) override;
 	virtual void onAfterEvents() override;
@@ -277,6 +368,7 @@ public:
 	void drawFeedbackMessage(RenderDevice* rd);										///< Draw a user feedback message (at full render device resolution)
 
 	void updateShaderBuffers();									///< Regenerate buffers (for configured shaders)
+	void applyQualityLevel(const QualityLevel& quality);		///< Apply the rendering settings for a quality level
 
 	/** calls rd->pushState with the right delayed buffer. Creates buffers if needed */
 	void pushRdStateWithDelay(RenderDevice* rd, Array<shared_ptr<Framebuffer>> &delayBufferQueue, int &delayIndex, int lagFrames = 0);
@@ -1,6 +1,7 @@
 /** \file FPSciAppGraphics.cpp */
 #include "FPSciApp.h"
 #include "WaypointManager.h"
+#include "TraceRecorder.h"
 
 void FPSciApp::updateShaderBuffers() {
 	// Parameters for update/resize of buffers
@@ -8,10 +9,10 @@ void FPSciApp::updateShaderBuffers() {
 	int height = renderDevice->height();
 
 	// 2D buffers (input and output) used when 2D resolution or shader is specified
-	if (!sessConfig->render.shader2D.empty() || sessConfig->render.resolution2D[0] > 0) {
-		if (sessConfig->render.resolution2D[0] > 0) {
-			width = sessConfig->render.resolution2D[0];
-			height = sessConfig->render.resolution2D[1];
+	if (!sessConfig->render->shader2D.empty() || sessConfig->render->resolution2D[0] > 0) {
+		if (sessConfig->render->resolution2D[0] > 0) {
+			width = sessConfig->render->resolution2D[0];
+			height = sessConfig->render->resolution2D[1];
 		}
 		m_ldrBuffer2D = Framebuffer::create(Texture::createEmpty("FPSci::2DShaderPass::Input", width, height, 
 			ImageFormat::RGBA8(), Texture::DIM_2D, true));
@@ -24,11 +25,11 @@ void FPSciApp::updateShaderBuffers() {
 	}
 
 	// 3D shader output (use popped framebuffer as input) used when 3D resolution or shader is specified
-	if (!sessConfig->render.shader3D.empty() || sessConfig->render.resolution3D[0] > 0) {
+	if (!sessConfig->render->shader3D.empty() || sessConfig->render->resolution3D[0] > 0) {
 		width = m_framebuffer->width(); height = m_framebuffer->height();
-		if (sessConfig->render.resolution3D[0] > 0) {
-			width = sessConfig->render.resolution3D[0];
-			height = sessConfig->render.resolution3D[1];
+		if (sessConfig->render->resolution3D[0] > 0) {
+			width = sessConfig->render->resolution3D[0];
+			height = sessConfig->render->resolution3D[1];
 		}
 		m_hdrShader3DOutput = Framebuffer::create(Texture::createEmpty("FPSci::3DShaderPass::Output", width, height, 
 			m_framebuffer->texture(0)->format(), Texture::DIM_2D, true));
@@ -38,13 +39,13 @@ void FPSciApp::updateShaderBuffers() {
 	}
 
 	// Composite buffer (input and output) used when composite shader or resolution is specified
-	if (!sessConfig->render.shaderComposite.empty() || sessConfig->render.resolutionComposite[0] > 0) {
+	if (!sessConfig->render->shaderComposite.empty() || sessConfig->render->resolutionComposite[0] > 0) {
 		width = renderDevice->width(); height = renderDevice->height();
 		m_ldrBufferPrecomposite = Framebuffer::create(Texture::createEmpty("FPSci::CompositeShaderPass::Precomposite", width, height, 
 			ImageFormat::RGB8(), Texture::DIM_2D, true));
-		if (sessConfig->render.resolutionComposite[0] > 0) {
-			width = sessConfig->render.resolutionComposite[0];
-			height = sessConfig->render.resolutionComposite[1];
+		if (sessConfig->render->resolutionComposite[0] > 0) {
+			width = sessConfig->render->resolutionComposite[0];
+			height = sessConfig->render->resolutionComposite[1];
 		}
 		m_ldrBufferComposite = Framebuffer::create(Texture::createEmpty("FPSci::CompositeShaderPass::Input", width, height, 
 			ImageFormat::RGB8(), Texture::DIM_2D, true));
@@ -58,9 +59,33 @@ void FPSciApp::updateShaderBuffers() {
 	}
 }
 
+void FPSciApp::applyQualityLevel(const QualityLevel& quality) {
+	if (notNull(scene())) {
+		scene()->lightingEnvironment().ambientOcclusionSettings.enabled = quality.ambientOcclusion;
+		// Disable shadows on (only) the lights that cast them, so they can be restored later
+		if (!quality.shadows && m_shadowlessLights.size() == 0) {
+			for (const shared_ptr<Light>& light : scene()->lightingEnvironment().lightArray) {
+				if (light->castsShadows()) {
+					light->setCastsShadows(false);
+					m_shadowlessLights.append(light);
+				}
+			}
+		}
+	}
+	if (quality.shadows) {
+		for (const shared_ptr<Light>& light : m_shadowlessLights) { light->setCastsShadows(true); }
+		m_shadowlessLights.fastClear();
+	}
+	if (notNull(playerCamera)) {
+		playerCamera->filmSettings().setAntialiasingEnabled(quality.antialiasing);
+		playerCamera->filmSettings().setBloomStrength(quality.bloomStrength);
+	}
+}
+
 void FPSciApp::onGraphics(RenderDevice* rd, Array<shared_ptr<Surface> >& posed3D, Array<shared_ptr<Surface2D> >& posed2D) {
 	debugAssertGLOk();
 
+	// Rendering reads only the posed surfaces and m_renderState (captured in onPose()), so the simulation thread keeps running
 	rd->pushState(); {
 		debugAssert(notNull(activeCamera()));
 		rd->setProjectionAndCameraMatrix(activeCamera()->projection(), activeCamera()->frame());
@@ -84,11 +109,13 @@ void FPSciApp::onGraphics(RenderDevice* rd, Array<shared_ptr<Surface> >& posed3D
 
 void FPSciApp::onGraphics3D(RenderDevice* rd, Array<shared_ptr<Surface> >& surface) {
 
-	pushRdStateWithDelay(rd, m_ldrDelayBufferQueue, m_currentDelayBufferIndex, displayLagFrames);
+	// When delaying the simulation state (see onPose()) the posed surfaces are already delayed
+	const int bufferLagFrames = (sessConfig->render->frameDelayMode == "framebuffer") ? displayLagFrames : 0;
+	pushRdStateWithDelay(rd, m_ldrDelayBufferQueue, m_currentDelayBufferIndex, bufferLagFrames);
 
-	scene()->lightingEnvironment().ambientOcclusionSettings.enabled = !emergencyTurbo;
-	playerCamera->filmSettings().setAntialiasingEnabled(!emergencyTurbo);
-	playerCamera->filmSettings().setBloomStrength(emergencyTurbo ? 0.0f : 0.5f);
+	// The (manual) emergency turbo mode overrides the adaptive quality level
+	static const QualityLevel turbo = QualityLevel::turbo();
+	applyQualityLevel(emergencyTurbo ? turbo : m_qualityController.current());
 
 	// Tone mapping from HDR --> LDR happens at the end of this call (after onPostProcessHDR3DEffects() call)
 	GApp::onGraphics3D(rd, surface);
@@ -107,7 +134,7 @@ void FPSciApp::onGraphics3D(RenderDevice* rd, Array<shared_ptr<Surface> >& surfa
 		drawDelayed2DElements(rd, resolution);
 	}rd->pop2D();
 
-	popRdStateWithDelay(rd, m_ldrDelayBufferQueue, m_currentDelayBufferIndex, displayLagFrames);
+	popRdStateWithDelay(rd, m_ldrDelayBufferQueue, m_currentDelayBufferIndex, bufferLagFrames);
 
 	// Transfer LDR framebuffer to the composite buffer (if used)
 	if (m_ldrBufferComposite) {
@@ -115,42 +142,42 @@ void FPSciApp::onGraphics3D(RenderDevice* rd, Array<shared_ptr<Surface> >& surfa
 		rd->copyTextureFromScreen(m_ldrBufferPrecomposite->texture(0), rd->viewport());
 		// Resample the copied framebuffer onto the (controlled resolution) composite shader input buffer
 		rd->push2D(m_ldrBufferComposite); {
-			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrBufferPrecomposite->texture(0), sessConfig->render.samplerPrecomposite, true);
+			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrBufferPrecomposite->texture(0), sessConfig->render->samplerPrecomposite, true);
 		} rd->pop2D();
 	}
 }
  
 void FPSciApp::onPostProcessHDR3DEffects(RenderDevice* rd) {
 	if (notNull(m_hdrShader3DOutput)) {
-		if(sessConfig->render.shader3D.empty()) {
+		if(sessConfig->render->shader3D.empty()) {
 			// No shader specified, just a resize perform pass through into 3D output buffer from framebuffer
 			rd->push2D(m_hdrShader3DOutput); {
-				Draw::rect2D(rd->viewport(), rd, Color3::white(), m_framebuffer->texture(0), sessConfig->render.sampler3D);
+				Draw::rect2D(rd->viewport(), rd, Color3::white(), m_framebuffer->texture(0), sessConfig->render->sampler3D);
 			} rd->pop2D();
 		}
 		else {
-			BEGIN_PROFILER_EVENT_WITH_HINT("3D Shader Pass", "Time to run the post-3D shader pass");
+			BEGIN_TRACE_EVENT_WITH_HINT("3D Shader Pass", "Time to run the post-3D shader pass");
 
 				rd->push2D(m_hdrShader3DOutput); {
 				// Setup shadertoy-style args
 				Args args;
-					args.setUniform("iChannel0", m_framebuffer->texture(0), sessConfig->render.sampler3D);
+					args.setUniform("iChannel0", m_framebuffer->texture(0), sessConfig->render->sampler3D);
 					const float iTime = float(System::time() - m_startTime);
 					args.setUniform("iTime", iTime);
 					args.setUniform("iTimeDelta", iTime - m_lastTime);
 					args.setUniform("iMouse", userInput->mouseXY());
 				args.setUniform("iFrame", m_frameNumber);
 				args.setRect(rd->viewport());
-				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render.shader3D], args);
+				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render->shader3D], args);
 				m_lastTime = iTime;
 			} rd->pop2D();
 
-			END_PROFILER_EVENT();
+			END_TRACE_EVENT();
 		}
 
 		// Resample the shader output buffer into the framebuffer
 		rd->push2D(); {
-			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_hdrShader3DOutput->texture(0), sessConfig->render.sampler3DOutput);
+			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_hdrShader3DOutput->texture(0), sessConfig->render->sampler3DOutput);
 		} rd->pop2D();
 	}
 
@@ -169,63 +196,63 @@ void FPSciApp::onGraphics2D(RenderDevice* rd, Array<shared_ptr<Surface2D>>& pose
 	} rd->pop2D();
 
 	if(notNull(m_ldrBuffer2D)){
-		if (sessConfig->render.shader2D.empty()) {
+		if (sessConfig->render->shader2D.empty()) {
 			m_ldrShader2DOutput = m_ldrBuffer2D;		// Redirect output pointer to input (skip shading)
 		}
 		else {
-			BEGIN_PROFILER_EVENT_WITH_HINT("2D Shader Pass", "Time to run the post-2D shader pass");
+			BEGIN_TRACE_EVENT_WITH_HINT("2D Shader Pass", "Time to run the post-2D shader pass");
 			rd->push2D(m_ldrShader2DOutput); {
 				// Setup shadertoy-style args
 				Args args;
-				args.setUniform("iChannel0", m_ldrBuffer2D->texture(0), sessConfig->render.sampler2D);
+				args.setUniform("iChannel0", m_ldrBuffer2D->texture(0), sessConfig->render->sampler2D);
 				const float iTime = float(System::time() - m_startTime);
 				args.setUniform("iTime", iTime);
 				args.setUniform("iTimeDelta", iTime - m_last2DTime);
 				args.setUniform("iMouse", userInput->mouseXY());
 				args.setUniform("iFrame", m_frameNumber);
 				args.setRect(rd->viewport());
-				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render.shader2D], args);
+				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render->shader2D], args);
 				m_last2DTime = iTime;
 			} rd->pop2D();
-			END_PROFILER_EVENT();
+			END_TRACE_EVENT();
 		}
 
 		// Direct shader output to the display or composite shader input (if specified)
 		isNull(m_ldrBufferComposite) ? rd->push2D() : rd->push2D(m_ldrBufferComposite); {
 			rd->setBlendFunc(RenderDevice::BLEND_SRC_ALPHA, RenderDevice::BLEND_ONE_MINUS_SRC_ALPHA);
-			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrShader2DOutput->texture(0), sessConfig->render.sampler2DOutput);
+			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrShader2DOutput->texture(0), sessConfig->render->sampler2DOutput);
 		} rd->pop2D();
 	}
 
 	//  Handle post-2D composite shader here
 	if (m_ldrBufferComposite) {
-		if (sessConfig->render.shaderComposite.empty()) {
+		if (sessConfig->render->shaderComposite.empty()) {
 			m_ldrShaderCompositeOutput = m_ldrBufferComposite;		// Redirect output pointer to input
 		}
 		else {
 			// Run a composite shader
-			BEGIN_PROFILER_EVENT_WITH_HINT("Composite Shader Pass", "Time to run the composite shader pass");
+			BEGIN_TRACE_EVENT_WITH_HINT("Composite Shader Pass", "Time to run the composite shader pass");
 
 			rd->push2D(m_ldrShaderCompositeOutput); {
 				// Setup shadertoy-style args
 				Args args;
-				args.setUniform("iChannel0", m_ldrBufferComposite->texture(0), sessConfig->render.samplerComposite);
+				args.setUniform("iChannel0", m_ldrBufferComposite->texture(0), sessConfig->render->samplerComposite);
 				const float iTime = float(System::time() - m_startTime);
 				args.setUniform("iTime", iTime);
 				args.setUniform("iTimeDelta", iTime - m_lastCompositeTime);
 				args.setUniform("iMouse", userInput->mouseXY());
 				args.setUniform("iFrame", m_frameNumber);
 				args.setRect(rd->viewport());
-				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render.shaderComposite], args);
+				LAUNCH_SHADER_PTR(m_shaderTable[sessConfig->render->shaderComposite], args);
 				m_lastCompositeTime = iTime;
 			} rd->pop2D();
 
-			END_PROFILER_EVENT();
+			END_TRACE_EVENT();
 		}
 
 		// Copy the shader output buffer into the framebuffer
 		rd->push2D(); {
-			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrShaderCompositeOutput->texture(0), sessConfig->render.samplerFinal);
+			Draw::rect2D(rd->viewport(), rd, Color3::white(), m_ldrShaderCompositeOutput->texture(0), sessConfig->render->samplerFinal);
 		} rd->pop2D();
 	}
 
@@ -282,15 +309,15 @@ void FPSciApp::draw2DElements(RenderDevice* rd, Vector2 resolution) {
 	}
 
 	// Click-to-photon mouse event indicator
-	if (sessConfig->clickToPhoton.enabled && sessConfig->clickToPhoton.mode != "total") {
-		drawClickIndicator(rd, sessConfig->clickToPhoton.mode, resolution);
+	if (sessConfig->clickToPhoton->enabled && sessConfig->clickToPhoton->mode != "total") {
+		drawClickIndicator(rd, sessConfig->clickToPhoton->mode, resolution);
 	}
 
 	// Player camera only indicators
 	if (activeCamera() == playerCamera) {
 		// Reticle
 		const shared_ptr<UserConfig> user = currentUser();
-		float tscale = weapon->cooldownRatio(m_lastOnSimulationRealTime, user->reticleChangeTimeS);
+		float tscale = m_renderState.reticleCooldown;
 		float rScale = scale * (tscale * user->reticleScale[0] + (1.0f - tscale) * user->reticleScale[1]);
 		Color4 rColor = user->reticleColor[1] * (1.0f - tscale) + user->reticleColor[0] * tscale;
 		Draw::rect2D(((reticleTexture->rect2DBounds() - reticleTexture->vector2Bounds() / 2.0f)) * rScale / 2.0f + resolution / 2.0f, rd, rColor, reticleTexture);
@@ -301,59 +328,55 @@ void FPSciApp::drawDelayed2DElements(RenderDevice* rd, Vector2 resolution) {
 	// Put elements that should be delayed along w/ (or independent of) 3D here
 	const float scale = resolution.x / 1920.0f;
 
-	// Draw target health bars
-	if (sessConfig->targetView.showHealthBars) {
-		for (auto const& target : sess->targetArray()) {
-			target->drawHealthBar(rd, *activeCamera(), *m_framebuffer,
-				sessConfig->targetView.healthBarSize,
-				sessConfig->targetView.healthBarOffset,
-				sessConfig->targetView.healthBarBorderSize,
-				sessConfig->targetView.healthBarColors,
-				sessConfig->targetView.healthBarBorderColor);
+	// Draw target health bars (as captured in onPose(), from the delayed state when delaying state instead of framebuffers)
+	if (sessConfig->targetView->showHealthBars) {
+		for (const StateSnapshot::HealthBar& bar : m_renderState.healthBars) {
+			TargetEntity::drawHealthBar(rd, *activeCamera(), *m_framebuffer, bar.position, bar.health,
+				sessConfig->targetView->healthBarSize,
+				sessConfig->targetView->healthBarOffset,
+				sessConfig->targetView->healthBarBorderSize,
+				sessConfig->targetView->healthBarColors,
+				sessConfig->targetView->healthBarBorderColor);
 		}
 	}
 
-	// Draw the combat text
-	if (sessConfig->targetView.showCombatText) {
-		Array<int> toRemove;
-		for (int i = 0; i < m_combatTextList.size(); i++) {
-			bool remove = !m_combatTextList[i]->draw(rd, *playerCamera, *m_framebuffer);
-			if (remove) m_combatTextList[i] = nullptr;		// Null pointers to remove
+	// Draw the combat text (expired text is removed in onPose())
+	if (sessConfig->targetView->showCombatText) {
+		for (const shared_ptr<FloatingCombatText>& text : m_renderState.combatText) {
+			text->draw(rd, *playerCamera, *m_framebuffer, m_renderState.time);
 		}
-		// Remove the expired elements here
-		m_combatTextList.removeNulls();
 	}
 
-	if (sessConfig->clickToPhoton.enabled && sessConfig->clickToPhoton.mode == "total") {
+	if (sessConfig->clickToPhoton->enabled && sessConfig->clickToPhoton->mode == "total") {
 		drawClickIndicator(rd, "total", resolution);
 	}
 
 	// Draw the HUD here
-	if (sessConfig->hud.enable) {
+	if (sessConfig->hud->enable) {
 		drawHUD(rd, resolution);
 	}
 }
 
 void FPSciApp::drawClickIndicator(RenderDevice* rd, String mode, Vector2 resolution) {
 	// Click to photon latency measuring corner box
-	if (sessConfig->clickToPhoton.enabled) {
+	if (sessConfig->clickToPhoton->enabled) {
 		float boxLeft = 0.0f;
 		// Paint both sides by the width of latency measuring box.
-		Point2 latencyRect = sessConfig->clickToPhoton.size * resolution;
-		float boxTop = resolution.y * sessConfig->clickToPhoton.vertPos - latencyRect.y / 2;
-		if (sessConfig->clickToPhoton.mode == "both") {
+		Point2 latencyRect = sessConfig->clickToPhoton->size * resolution;
+		float boxTop = resolution.y * sessConfig->clickToPhoton->vertPos - latencyRect.y / 2;
+		if (sessConfig->clickToPhoton->mode == "both") {
 			boxTop = (mode == "minimum") ? boxTop - latencyRect.y : boxTop + latencyRect.y;
 		}
-		if (sessConfig->clickToPhoton.side == "right") {
+		if (sessConfig->clickToPhoton->side == "right") {
 			boxLeft = resolution.x - latencyRect.x;
 		}
 		// Draw the "active" box
 		Color3 boxColor;
-		if (sessConfig->clickToPhoton.mode == "frameRate") {
-			boxColor = (frameToggle) ? sessConfig->clickToPhoton.colors[0] : sessConfig->clickToPhoton.colors[1];
+		if (sessConfig->clickToPhoton->mode == "frameRate") {
+			boxColor = (frameToggle) ? sessConfig->clickToPhoton->colors[0] : sessConfig->clickToPhoton->colors[1];
 			frameToggle = !frameToggle;
 		}
-		else boxColor = (shootButtonUp) ? sessConfig->clickToPhoton.colors[0] : sessConfig->clickToPhoton.colors[1];
+		else boxColor = (shootButtonUp) ? sessConfig->clickToPhoton->colors[0] : sessConfig->clickToPhoton->colors[1];
 		Draw::rect2D(Rect2D::xywh(boxLeft, boxTop, latencyRect.x, latencyRect.y), rd, boxColor);
 	}
 }
@@ -367,7 +390,7 @@ void FPSciApp::drawFeedbackMessage(RenderDevice* rd) {
 		const float scale = rd->width() / 1920.f;
 		String message = sess->getFeedbackMessage();
 		const float centerHeight = rd->height() * 0.4f;
-		const float scaledFontSize = floor(sessConfig->feedback.fontSize * scale);
+		const float scaledFontSize = floor(sessConfig->feedback->fontSize * scale);
 		if (!message.empty()) {
 			String currLine;
 			Array<String> lines = stringSplit(message, '\n');
@@ -377,13 +400,13 @@ void FPSciApp::drawFeedbackMessage(RenderDevice* rd) {
 				vertPos - 1.5f * scaledFontSize,
 				(float) rd->width(),
 				scaledFontSize * (lines.length() + 1) * 1.5f),
-				rd, sessConfig->feedback.backgroundColor);
+				rd, sessConfig->feedback->backgroundColor);
 			for (String line : lines) {
 				outputFont->draw2D(rd, line.c_str(),
 					(Point2(rd->width() * 0.5f, vertPos)).floor(),
 					scaledFontSize,
-					sessConfig->feedback.color,
-					sessConfig->feedback.outlineColor,
+					sessConfig->feedback->color,
+					sessConfig->feedback->outlineColor,
 					GFont::XALIGN_CENTER, GFont::YALIGN_CENTER
 				);
 				vertPos += scaledFontSize * 1.5f;
@@ -429,32 +452,32 @@ void FPSciApp::drawHUD(RenderDevice *rd, Vector2 resolution) {
 	// Scale is used to position/resize the "score banner" when the window changes size in "windowed" mode (always 1 in fullscreen mode).
 	const Vector2 scale = resolution / (Vector2)OSWindow::primaryDisplayWindowSize();
 
-	RealTime now = m_lastOnSimulationRealTime;
+	const float cooldown = m_renderState.weaponCooldown;
 
 	// Weapon ready status (cooldown indicator)
-	if (sessConfig->hud.renderWeaponStatus) {
+	if (sessConfig->hud->renderWeaponStatus) {
 		// Draw the "active" cooldown box
-		if (sessConfig->hud.cooldownMode == "box") {
+		if (sessConfig->hud->cooldownMode == "box") {
 			float boxLeft = 0.0f;
-			if (sessConfig->hud.weaponStatusSide == "right") {
+			if (sessConfig->hud->weaponStatusSide == "right") {
 				// swap side
-				boxLeft = resolution.x * (1.0f - sessConfig->clickToPhoton.size.x);
+				boxLeft = resolution.x * (1.0f - sessConfig->clickToPhoton->size.x);
 			}
 			Draw::rect2D(
 				Rect2D::xywh(
 					boxLeft,
-					resolution.y * (weapon->cooldownRatio(now)),
-					resolution.x * sessConfig->clickToPhoton.size.x,
-					resolution.y * (1.0f - weapon->cooldownRatio(now))
+					resolution.y * cooldown,
+					resolution.x * sessConfig->clickToPhoton->size.x,
+					resolution.y * (1.0f - cooldown)
 				), rd, Color3::white() * 0.8f
 			);
 		}
-		else if (sessConfig->hud.cooldownMode == "ring") {
+		else if (sessConfig->hud->cooldownMode == "ring") {
 			// Draw cooldown "ring" instead of box
-			const float iRad = sessConfig->hud.cooldownInnerRadius;
-			const float oRad = iRad + sessConfig->hud.cooldownThickness;
-			const int segments = sessConfig->hud.cooldownSubdivisions;
-			int segsToLight = static_cast<int>(ceilf((1 - weapon->cooldownRatio(now))*segments));
+			const float iRad = sessConfig->hud->cooldownInnerRadius;
+			const float oRad = iRad + sessConfig->hud->cooldownThickness;
+			const int segments = sessConfig->hud->cooldownSubdivisions;
+			int segsToLight = static_cast<int>(ceilf((1 - cooldown)*segments));
 			// Create the segments
 			for (int i = 0; i < segsToLight; i++) {
 				const float inc = static_cast<float>(2 * pi() / segments);
@@ -466,63 +489,63 @@ void FPSciApp::drawHUD(RenderDevice *rd, Vector2 resolution) {
 					center + Vector2(iRad*sin(theta + inc), -iRad * cos(theta + inc)),
 					center + Vector2(iRad*sin(theta), -iRad * cos(theta))
 				};
-				Draw::poly2D(verts, rd, sessConfig->hud.cooldownColor);
+				Draw::poly2D(verts, rd, sessConfig->hud->cooldownColor);
 			}
 		}
 	}
 
 	// Draw the player health bar
-	if (sessConfig->hud.showPlayerHealthBar) {
+	if (sessConfig->hud->showPlayerHealthBar) {
 		//const float guardband = (rd->framebuffer()->width() - window()->framebuffer()->width()) / 2.0f;
-		const float health = scene()->typedEntity<PlayerEntity>("player")->health();
-		Point2 location = sessConfig->hud.playerHealthBarPos * resolution;
+		const float health = m_renderState.playerHealth;
+		Point2 location = sessConfig->hud->playerHealthBarPos * resolution;
 		location.y += (m_debugMenuHeight * scale.y);
-		const Point2 size = sessConfig->hud.playerHealthBarSize * resolution;
-		const Vector2 border = sessConfig->hud.playerHealthBarBorderSize * resolution;
-		const Color4 borderColor = sessConfig->hud.playerHealthBarBorderColor;
-		const Color4 color = sessConfig->hud.playerHealthBarColors[1] * (1.0f - health) + sessConfig->hud.playerHealthBarColors[0] * health;
+		const Point2 size = sessConfig->hud->playerHealthBarSize * resolution;
+		const Vector2 border = sessConfig->hud->playerHealthBarBorderSize * resolution;
+		const Color4 borderColor = sessConfig->hud->playerHealthBarBorderColor;
+		const Color4 color = sessConfig->hud->playerHealthBarColors[1] * (1.0f - health) + sessConfig->hud->playerHealthBarColors[0] * health;
 
 		Draw::rect2D(Rect2D::xywh(location - border, size + border + border), rd, borderColor);
 		Draw::rect2D(Rect2D::xywh(location, size*Point2(health, 1.0f)), rd, color);
 	}
 	// Draw the ammo indicator
-	if (sessConfig->hud.showAmmo) {
+	if (sessConfig->hud->showAmmo) {
 		//const float guardband = (rd->framebuffer()->width() - window()->framebuffer()->width()) / 2.0f;
 		Point2 lowerRight = resolution; //Point2(static_cast<float>(rd->viewport().width()), static_cast<float>(rd->viewport().height())) - Point2(guardband, guardband);
 		hudFont->draw2D(rd,
-			format("%d/%d", weapon->remainingAmmo(), sessConfig->weapon.maxAmmo),
-			lowerRight - sessConfig->hud.ammoPosition,
-			sessConfig->hud.ammoSize,
-			sessConfig->hud.ammoColor,
-			sessConfig->hud.ammoOutlineColor,
+			format("%d/%d", m_renderState.remainingAmmo, sessConfig->weapon->maxAmmo),
+			lowerRight - sessConfig->hud->ammoPosition,
+			sessConfig->hud->ammoSize,
+			sessConfig->hud->ammoColor,
+			sessConfig->hud->ammoOutlineColor,
 			GFont::XALIGN_RIGHT,
 			GFont::YALIGN_BOTTOM
 		);
 	}
 
-	if (sessConfig->hud.showBanner && !emergencyTurbo) {
+	if (sessConfig->hud->showBanner && !emergencyTurbo) {
 		const shared_ptr<Texture> scoreBannerTexture = hudTextures["scoreBannerBackdrop"];
-		const Point2 hudCenter(resolution.x / 2.0f, sessConfig->hud.bannerVertVisible * scoreBannerTexture->height() * scale.y + debugMenuHeight());
+		const Point2 hudCenter(resolution.x / 2.0f, sessConfig->hud->bannerVertVisible * scoreBannerTexture->height() * scale.y + debugMenuHeight());
 		Draw::rect2D((scoreBannerTexture->rect2DBounds() * scale - scoreBannerTexture->vector2Bounds() * scale / 2.0f) * 0.8f + hudCenter, rd, Color3::white(), scoreBannerTexture);
 
 		// Create strings for time remaining, progress in sessions, and score
-		float remainingTime = sess->getRemainingTrialTime();
+		float remainingTime = m_renderState.remainingTrialTime;
 		float printTime = remainingTime > 0 ? remainingTime : 0.0f;
 		String time_string = format("%0.2f", printTime);
-		float prog = sess->getProgress();
+		float prog = m_renderState.progress;
 		String prog_string = "";
 		if (!isnan(prog)) {
 			prog_string = format("%d", (int)(100.0f*prog)) + "%";
 		}
-		String score_string = format("%d", (int)(10 * sess->getScore()));
+		String score_string = format("%d", (int)(10 * m_renderState.score));
 
-		hudFont->draw2D(rd, time_string, hudCenter - Vector2(80, 0) * scale.x, scale.x * sessConfig->hud.bannerSmallFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_RIGHT, GFont::YALIGN_CENTER);
-		hudFont->draw2D(rd, prog_string, hudCenter + Vector2(0, -1), scale.x * sessConfig->hud.bannerLargeFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_CENTER, GFont::YALIGN_CENTER);
-		hudFont->draw2D(rd, score_string, hudCenter + Vector2(125, 0) * scale, scale.x * sessConfig->hud.bannerSmallFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_RIGHT, GFont::YALIGN_CENTER);
+		hudFont->draw2D(rd, time_string, hudCenter - Vector2(80, 0) * scale.x, scale.x * sessConfig->hud->bannerSmallFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_RIGHT, GFont::YALIGN_CENTER);
+		hudFont->draw2D(rd, prog_string, hudCenter + Vector2(0, -1), scale.x * sessConfig->hud->bannerLargeFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_CENTER, GFont::YALIGN_CENTER);
+		hudFont->draw2D(rd, score_string, hudCenter + Vector2(125, 0) * scale, scale.x * sessConfig->hud->bannerSmallFontSize, Color3::white(), Color4::clear(), GFont::XALIGN_RIGHT, GFont::YALIGN_CENTER);
 	}
 
 	// Draw any static HUD elements
-	for (StaticHudElement element : sessConfig->hud.staticElements) {
+	for (StaticHudElement element : sessConfig->hud->staticElements) {
 		if (!hudTextures.containsKey(element.filename)) continue;						// Skip any items we haven't loaded
 		const shared_ptr<Texture> texture = hudTextures[element.filename];				// Get the loaded texture for this element
 		const Vector2 size = element.scale * scale * texture->vector2Bounds();			// Get the final size of the image
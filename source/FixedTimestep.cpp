@@ -0,0 +1,64 @@
+#include "FixedTimestep.h"
+
+int FixedTimestep::advance(SimTime dt) {
+	if (!enabled()) return 1;
+	m_accumulator += dt;
+
+	// Allow a tiny bit of slack so frame times that are a multiple of the step don't alternate between 0 and 2 steps
+	const SimTime eps = m_step * 1e-6;
+	int steps = 0;
+	while (m_accumulator >= m_step - eps && steps < m_maxStepsPerFrame) {
+		m_accumulator -= m_step;
+		steps++;
+	}
+	// Drop time we can't keep up with (bounds the simulation cost)
+	if (m_accumulator >= m_step) {
+		m_accumulator = fmod(m_accumulator, m_step);
+	}
+	m_accumulator = max(0.0, m_accumulator);
+	return steps;
+}
+
+void EntityInterpolator::restore() {
+	for (State& s : m_states) {
+		CFrame frame = s.entity->frame();
+		if (s.interpolateRotation) {
+			if (frame == s.presented) s.entity->setFrame(s.current);
+		}
+		else if (frame.translation == s.presented.translation) {
+			// Keep the (live) rotation
+			frame.translation = s.current.translation;
+			s.entity->setFrame(frame);
+		}
+	}
+}
+
+void EntityInterpolator::track(const shared_ptr<Entity>& entity, bool interpolateRotation) {
+	if (isNull(entity)) return;
+	State s;
+	s.entity = entity;
+	s.previous = entity->frame();
+	s.current = s.previous;
+	s.presented = s.previous;
+	s.interpolateRotation = interpolateRotation;
+	m_states.append(s);
+}
+
+void EntityInterpolator::update() {
+	for (State& s : m_states) {
+		s.current = s.entity->frame();
+	}
+}
+
+void EntityInterpolator::apply(float alpha) {
+	for (State& s : m_states) {
+		if (s.interpolateRotation) {
+			s.presented = s.previous.lerp(s.current, alpha);
+		}
+		else {
+			s.presented = s.entity->frame();		// Keep the (live) rotation
+			s.presented.translation = s.previous.translation.lerp(s.current.translation, alpha);
+		}
+		s.entity->setFrame(s.presented);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Accumulator for running the simulation at a fixed rate (independent of the frame rate)
+
+	Each frame call advance() w/ the frame's time step and run the returned number of fixed steps.
+	The number of steps per frame is capped (dropping any time that can't be kept up with) to bound the simulation cost.
+	The fraction of a step left over (alpha()) is used to interpolate the rendered state between the last two steps.
+*/
+class FixedTimestep {
+public:
+	static const int DefaultMaxStepsPerFrame = 8;
+
+protected:
+	SimTime		m_step = 0.0;							///< Fixed step (in seconds), 0 if disabled
+	SimTime		m_accumulator = 0.0;					///< Time not yet simulated
+	int			m_maxStepsPerFrame = DefaultMaxStepsPerFrame;
+
+public:
+	FixedTimestep() {}
+
+	/** Set the simulation rate (in Hz), a rate <= 0 disables fixed rate simulation */
+	void setRate(float rateHz) {
+		m_step = rateHz > 0.f ? 1.0 / rateHz : 0.0;
+		reset();
+	}
+	void setMaxStepsPerFrame(int steps) { m_maxStepsPerFrame = max(1, steps); }
+
+	bool enabled() const { return m_step > 0.0; }
+	SimTime step() const { return m_step; }
+
+	/** Add a frame's time step, returns the number of fixed steps to simulate */
+	int advance(SimTime dt);
+
+	/** Fraction of a step accumulated since the last step (in [0,1)) */
+	float alpha() const { return enabled() ? clamp((float)(m_accumulator / m_step), 0.f, 1.f) : 1.f; }
+
+	void reset() { m_accumulator = 0.0; }
+};
+
+/** Interpolates entity frames between the last two (fixed rate) simulation steps for rendering
+
+	Call restore() before simulating, then clear() and track() the moving entities before each step,
+	and update() and apply() after the last step of the frame.
+*/
+class EntityInterpolator {
+protected:
+	struct State {
+		shared_ptr<Entity>	entity;
+		CFrame				previous;						///< Frame before the last step
+		CFrame				current;						///< Frame after the last step
+		CFrame				presented;						///< Interpolated frame (as set by apply())
+		bool				interpolateRotation = true;		///< Interpolate rotation (or leave the entity's live rotation alone)?
+	};
+	Array<State> m_states;
+
+public:
+	/** Put tracked entities back at their simulated frames (unless something else has moved them since apply()) */
+	void restore();
+
+	/** Stop tracking all entities */
+	void clear() { m_states.fastClear(); }
+
+	/** Track an entity (call before the step), entities created during the step are not interpolated */
+	void track(const shared_ptr<Entity>& entity, bool interpolateRotation = true);
+
+	/** Record the simulated frames after the last step */
+	void update();
+
+	/** Move tracked entities to the frames interpolated between the last two steps */
+	void apply(float alpha);
+};
@@ -56,6 +56,12 @@ void RenderConfig::load(AnyTableReader reader, int settingsVersion) {
 	case 1:
 		reader.getIfPresent("frameRate", frameRate);
 		reader.getIfPresent("frameDelay", frameDelay);
+		reader.getIfPresent("frameDelayMode", frameDelayMode);
+		if (frameDelayMode != "framebuffer" && frameDelayMode != "state") {
+			throw format("\"frameDelayMode\" must be \"framebuffer\" or \"state\" (found \"%s\")!", frameDelayMode.c_str());
+		}
+		reader.getIfPresent("simulationRate", simulationRate);
+		reader.getIfPresent("lateLatch", lateLatch);
 		reader.getIfPresent("horizontalFieldOfView", hFoV);
 
 		reader.getIfPresent("resolution2D", resolution2D);
@@ -74,6 +80,19 @@ void RenderConfig::load(AnyTableReader reader, int settingsVersion) {
 		reader.getIfPresent("samplerComposite", samplerComposite);
 		reader.getIfPresent("samplerFinal", samplerFinal);
 
+		reader.getIfPresent("adaptiveQuality", adaptiveQuality);
+		reader.getIfPresent("qualityLevels", qualityLevels);
+		reader.getIfPresent("qualityDowngradeThreshold", qualityDowngradeThreshold);
+		reader.getIfPresent("qualityUpgradeThreshold", qualityUpgradeThreshold);
+		reader.getIfPresent("qualityWindowFrames", qualityWindowFrames);
+		reader.getIfPresent("qualityUpgradeFrames", qualityUpgradeFrames);
+		if (qualityLevels.size() == 0) {
+			throw String("The \"qualityLevels\" array must contain at least one quality level!");
+		}
+		if (qualityUpgradeThreshold >= qualityDowngradeThreshold) {
+			throw format("\"qualityUpgradeThreshold\" (%f) must be less than \"qualityDowngradeThreshold\" (%f)!", qualityUpgradeThreshold, qualityDowngradeThreshold);
+		}
+
 		break;
 	default:
 		throw format("Did not recognize settings version: %d", settingsVersion);
@@ -93,6 +112,9 @@ Any RenderConfig::addToAny(Any a, bool forceAll) const {
 	RenderConfig def;
 	if (forceAll || def.frameRate != frameRate)					a["frameRate"] = frameRate;
 	if (forceAll || def.frameDelay != frameDelay)				a["frameDelay"] = frameDelay;
+	if (forceAll || def.frameDelayMode != frameDelayMode)		a["frameDelayMode"] = frameDelayMode;
+	if (forceAll || def.simulationRate != simulationRate)		a["simulationRate"] = simulationRate;
+	if (forceAll || def.lateLatch != lateLatch)					a["lateLatch"] = lateLatch;
 	if (forceAll || def.hFoV != hFoV)							a["horizontalFieldOfView"] = hFoV;
 
 	if (forceAll || def.resolution2D != resolution2D)			a["resolution2D"] = resolution2D;
@@ -110,10 +132,26 @@ Any RenderConfig::addToAny(Any a, bool forceAll) const {
 	if (forceAll || def.samplerPrecomposite != samplerPrecomposite)	a["samplerPrecomposite"] = samplerPrecomposite;
 	if (forceAll || def.samplerComposite != samplerComposite)	a["samplerComposite"] = samplerComposite;
 	if (forceAll || def.samplerFinal != samplerFinal)			a["samplerFinal"] = samplerFinal;
+
+	if (forceAll || def.adaptiveQuality != adaptiveQuality)		a["adaptiveQuality"] = adaptiveQuality;
+	if (forceAll || def.qualityLevels.size() != qualityLevels.size() || def.qualityLevels != qualityLevels)	a["qualityLevels"] = qualityLevels;
+	if (forceAll || def.qualityDowngradeThreshold != qualityDowngradeThreshold)	a["qualityDowngradeThreshold"] = qualityDowngradeThreshold;
+	if (forceAll || def.qualityUpgradeThreshold != qualityUpgradeThreshold)		a["qualityUpgradeThreshold"] = qualityUpgradeThreshold;
+	if (forceAll || def.qualityWindowFrames != qualityWindowFrames)				a["qualityWindowFrames"] = qualityWindowFrames;
+	if (forceAll || def.qualityUpgradeFrames != qualityUpgradeFrames)			a["qualityUpgradeFrames"] = qualityUpgradeFrames;
 	
 	return a;
 }
 
+QualityController::Settings RenderConfig::qualitySettings() const {
+	QualityController::Settings settings;
+	settings.downgradeThreshold = qualityDowngradeThreshold;
+	settings.upgradeThreshold = qualityUpgradeThreshold;
+	settings.windowFrames = qualityWindowFrames;
+	settings.upgradeFrames = qualityUpgradeFrames;
+	return settings;
+}
+
 void PlayerConfig::load(AnyTableReader reader, int settingsVersion) {
 	switch (settingsVersion) {
 	case 1:
@@ -342,6 +380,7 @@ void TargetViewConfig::load(AnyTableReader reader, int settingsVersion) {
 		reader.getIfPresent("referenceTargetColor", refTargetColor);
 		reader.getIfPresent("showPreviewTargetsWithReference", previewWithRef);
 		reader.getIfPresent("previewTargetColor", previewColor);
+		reader.getIfPresent("preSpawnTargets", preSpawnTargets);
 		break;
 	default:
 		throw format("Did not recognize settings version: %d", settingsVersion);
@@ -372,6 +411,7 @@ Any TargetViewConfig::addToAny(Any a, bool forceAll) const {
 	if (forceAll || def.refTargetColor != refTargetColor)				a["referenceTargetColor"] = refTargetColor;
 	if (forceAll || def.previewWithRef != previewWithRef)				a["showPreviewTargetsWithReference"] = previewWithRef;
 	if (forceAll || def.previewColor != previewColor)					a["previewTargetColor"] = previewColor;
+	if (forceAll || def.preSpawnTargets != preSpawnTargets)				a["preSpawnTargets"] = preSpawnTargets;
 	return a;
 }
 
@@ -412,6 +452,12 @@ void LoggerConfig::load(AnyTableReader reader, int settingsVersion) {
 		reader.getIfPresent("logUsers", logUsers);
 		reader.getIfPresent("sessionParametersToLog", sessParamsToLog);
 		reader.getIfPresent("logToSingleDb", logToSingleDb);
+		reader.getIfPresent("logProfilerTrace", logProfilerTrace);
+		reader.getIfPresent("logHitches", logHitches);
+		reader.getIfPresent("hitchThreshold", hitchThreshold);
+		reader.getIfPresent("logPerfCounters", logPerfCounters);
+		reader.getIfPresent("logShotLatency", logShotLatency);
+		reader.getIfPresent("exportTrialSchedule", exportTrialSchedule);
 		break;
 	default:
 		throw format("Did not recognize settings version: %d", settingsVersion);
@@ -429,6 +475,12 @@ Any LoggerConfig::addToAny(Any a, bool forceAll) const {
 	if (forceAll || def.logUsers != logUsers)							a["logUsers"] = logUsers;
 	if (forceAll || def.sessParamsToLog != sessParamsToLog)				a["sessionParametersToLog"] = sessParamsToLog;
 	if (forceAll || def.logToSingleDb != logToSingleDb)					a["logToSingleDb"] = logToSingleDb;
+	if (forceAll || def.logProfilerTrace != logProfilerTrace)			a["logProfilerTrace"] = logProfilerTrace;
+	if (forceAll || def.logHitches != logHitches)						a["logHitches"] = logHitches;
+	if (forceAll || def.hitchThreshold != hitchThreshold)				a["hitchThreshold"] = hitchThreshold;
+	if (forceAll || def.logPerfCounters != logPerfCounters)				a["logPerfCounters"] = logPerfCounters;
+	if (forceAll || def.logShotLatency != logShotLatency)				a["logShotLatency"] = logShotLatency;
+	if (forceAll || def.exportTrialSchedule != exportTrialSchedule)		a["exportTrialSchedule"] = exportTrialSchedule;
 	return a;
 }
 
@@ -465,6 +517,7 @@ void CommandConfig::load(AnyTableReader reader, int settingsVersion) {
 		reader.getIfPresent("commandsOnSessionEnd", sessionEndCmds);
 		reader.getIfPresent("commandsOnTrialStart", trialStartCmds);
 		reader.getIfPresent("commandsOnTrialEnd", trialEndCmds);
+		reader.getIfPresent("commandsForTrialEvents", trialEventCmds);
 		break;
 	default:
 		throw format("Did not recognize settings version: %d", settingsVersion);
@@ -477,6 +530,7 @@ Any CommandConfig::addToAny(Any a, const bool forceAll) const {
 	if (forceAll || sessionEndCmds.size() > 0)			a["commandsOnSessionEnd"] = sessionEndCmds;
 	if (forceAll || trialStartCmds.size() > 0)			a["commandsOnTrialStart"] = trialStartCmds;
 	if (forceAll || trialEndCmds.size() > 0)			a["commandsOnTrialEnd"] = trialEndCmds;
+	if (forceAll || trialEventCmds.size() > 0)			a["commandsForTrialEvents"] = trialEventCmds;
 	return a;
 }
 
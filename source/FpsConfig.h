@@ -2,6 +2,8 @@
 #include <G3D/G3D.h>
 #include "Weapon.h"
 #include "GuiElements.h"
+#include "QualityController.h"
+#include "CopyOnWrite.h"
 
 class SceneConfig {
 public:
@@ -27,6 +29,9 @@ public:
 	// Rendering parameters
 	float           frameRate = 1000.0f;						///< Target (goal) frame rate (in Hz)
 	int             frameDelay = 0;								///< Integer frame delay (in frames)
+	String			frameDelayMode = "framebuffer";				///< How frames are delayed: "framebuffer" (delay rendered frames) or "state" (delay the rendered simulation state)
+	float           simulationRate = 0.0f;						///< Fixed simulation rate (in Hz), 0 to simulate once per frame
+	bool			lateLatch = false;							///< Re-sample mouse motion right before rendering to update the view rotation (requires the raw input thread)
 	float           hFoV = 103.0f;							    ///< Field of view (horizontal) for the user
 	
 	Array<int>		resolution2D = { 0, 0 };					///< Optional 2D buffer resolution
@@ -46,6 +51,17 @@ public:
 	Sampler			samplerComposite = Sampler::video();		///< Sampler for sampling the shaderComposite iChannel0 input
 	Sampler			samplerFinal = Sampler::video();			///< Sampler for sampling composite (shader) output buffer into the final framebuffer
 
+	// Adaptive quality
+	bool			adaptiveQuality = false;					///< Automatically lower/raise rendering quality to hold the target frame rate
+	Array<QualityLevel> qualityLevels = QualityLevel::defaultLadder();	///< Quality ladder (highest quality first)
+	float			qualityDowngradeThreshold = 0.9f;			///< Lower quality when the mean frame time exceeds this fraction of the target frame duration
+	float			qualityUpgradeThreshold = 0.6f;				///< Raise quality when the mean frame time stays under this fraction of the target frame duration
+	int				qualityWindowFrames = 30;					///< Number of frames averaged for each quality decision
+	int				qualityUpgradeFrames = 240;					///< Number of frames the mean must stay under the upgrade threshold before raising quality
+
+	/** Controller settings for the adaptive quality parameters above */
+	QualityController::Settings qualitySettings() const;
+
 	void load(AnyTableReader reader, int settingsVersion = 1);
 	Any addToAny(Any a, bool forceAll = false) const;
 
@@ -211,6 +227,8 @@ public:
 	bool			previewWithRef = false;								///< Show preview of per-trial targets with the reference
 	Color3			previewColor = Color3(0.5, 0.5, 0.5);				///< Color to show preview targets in
 
+	bool			preSpawnTargets = false;							///< Spawn (hidden) trial targets during the pretrial state, showing them when the task starts
+
 	void load(AnyTableReader reader, int settingsVersion = 1);
 	Any addToAny(Any a, bool forceAll = false) const;
 };
@@ -243,6 +261,12 @@ public:
 	bool logUsers = true;		///< Log user information in table?
 
 	bool logToSingleDb = true;		///< Log all results to a single db file?
+	bool logProfilerTrace = false;	///< Write a (Chrome) trace of profiler zones alongside the db file?
+	bool logHitches = false;			///< Log frames that exceed their time budget in table?
+	float hitchThreshold = 1.5f;	///< Frame duration (as a multiple of the target frame duration) above which a frame is considered a hitch
+	bool logPerfCounters = false;	///< Log per-trial CPU counters (cycles by frame stage, page faults) in table?
+	bool logShotLatency = true;		///< Log the (software) input to present latency of each shot in table?
+	bool exportTrialSchedule = false;	///< Write the session's compiled trial schedule (CSV) alongside the db file?
 
 	// Session parameter logging
 	Array<String> sessParamsToLog = { "frameRate", "frameDelay" };			///< Parameter names to log to the Sessions table of the DB
@@ -269,6 +293,7 @@ public:
 	Array<CommandSpec> sessionEndCmds;						///< Command to run on end of a session
 	Array<CommandSpec> trialStartCmds;						///< Command to run on start of a trial
 	Array<CommandSpec> trialEndCmds;							///< Command to run on end of a trial
+	Array<CommandSpec> trialEventCmds;						///< Command to run for the whole session, receiving trial events on stdin
 
 	void load(AnyTableReader reader, int settingsVersion = 1);
 	Any addToAny(Any a, const bool forceAll = false) const;
@@ -301,20 +326,20 @@ class FpsConfig : public ReferenceCountedObject {
 public:
 	int	            settingsVersion = 1;						///< Settings version
 
-	// Sub structures
-	SceneConfig			scene;									///< Scene related config parameters			
-	RenderConfig		render;									///< Render related config parameters
-	PlayerConfig		player;									///< Player related config parameters
-	HudConfig			hud;									///< HUD related config parameters
-	AudioConfig			audio;									///< Audio related config parameters
-	TimingConfig		timing;									///< Timing related config parameters
-	FeedbackConfig		feedback;								///< Feedback message config parameters
-	TargetViewConfig	targetView;								///< Target drawing config parameters
-	ClickToPhotonConfig clickToPhoton;							///< Click to photon config parameters
-	LoggerConfig		logger;									///< Logging configuration
-	WeaponConfig		weapon;			                        ///< Weapon to be used
-	MenuConfig			menu;									///< User settings window configuration
-	CommandConfig		commands;								///< Commands to run during execution
+	// Sub structures (shared w/ the config this was copied from until modified, read through a const reference to avoid copies)
+	CopyOnWrite<SceneConfig>			scene;					///< Scene related config parameters			
+	CopyOnWrite<RenderConfig>			render;					///< Render related config parameters
+	CopyOnWrite<PlayerConfig>			player;					///< Player related config parameters
+	CopyOnWrite<HudConfig>				hud;					///< HUD related config parameters
+	CopyOnWrite<AudioConfig>			audio;					///< Audio related config parameters
+	CopyOnWrite<TimingConfig>			timing;					///< Timing related config parameters
+	CopyOnWrite<FeedbackConfig>			feedback;				///< Feedback message config parameters
+	CopyOnWrite<TargetViewConfig>		targetView;				///< Target drawing config parameters
+	CopyOnWrite<ClickToPhotonConfig>	clickToPhoton;			///< Click to photon config parameters
+	CopyOnWrite<LoggerConfig>			logger;					///< Logging configuration
+	CopyOnWrite<WeaponConfig>			weapon;					///< Weapon to be used
+	CopyOnWrite<MenuConfig>				menu;					///< User settings window configuration
+	CopyOnWrite<CommandConfig>			commands;				///< Commands to run during execution
 	Array<Question>		questionArray;							///< Array of questions for this experiment/trial
 
 	// Constructors
@@ -329,26 +354,64 @@ public:
 
 	FpsConfig() {}
 
+protected:
+	/** Names of the fields a sub-config can be loaded from (all fields written by addToAny() plus any load-only aliases) */
+	template <class T>
+	static Array<String> fieldNames(const Array<String>& aliases = Array<String>()) {
+		Array<String> names = T().addToAny(Any(Any::TABLE), true).table().getKeys();
+		names.append(aliases);
+		return names;
+	}
+
+	/** Load a sub-config, only copying it (if shared) when the Any sets one of its fields */
+	template <class T>
+	void loadIfPresent(const Any& any, AnyTableReader& reader, CopyOnWrite<T>& config, const Array<String>& fields) {
+		for (const String& name : fields) {
+			if (any.containsKey(name)) {
+				config->load(reader, settingsVersion);
+				return;
+			}
+		}
+	}
+
+public:
 	void load(const Any& any) {
+		static const Array<String> renderFields = fieldNames<RenderConfig>({ "sampled2D" });
+		static const Array<String> playerFields = fieldNames<PlayerConfig>({ "turnScale" });
+		static const Array<String> hudFields = fieldNames<HudConfig>();
+		static const Array<String> targetViewFields = fieldNames<TargetViewConfig>({ "showReferenceTarget" });
+		static const Array<String> clickToPhotonFields = fieldNames<ClickToPhotonConfig>({ "clickPhotonMode" });
+		static const Array<String> audioFields = fieldNames<AudioConfig>();
+		static const Array<String> timingFields = fieldNames<TimingConfig>();
+		static const Array<String> feedbackFields = fieldNames<FeedbackConfig>();
+		static const Array<String> loggerFields = fieldNames<LoggerConfig>();
+		static const Array<String> menuFields = fieldNames<MenuConfig>();
+		static const Array<String> commandFields = fieldNames<CommandConfig>();
+
 		AnyTableReader reader(any);
 		reader.getIfPresent("settingsVersion", settingsVersion);
-		render.load(reader, settingsVersion);
-		player.load(reader, settingsVersion);
-		hud.load(reader, settingsVersion);
-		targetView.load(reader, settingsVersion);
-		clickToPhoton.load(reader, settingsVersion);
-		audio.load(reader, settingsVersion);
-		timing.load(reader, settingsVersion);
-		feedback.load(reader, settingsVersion);
-		logger.load(reader, settingsVersion);
-		menu.load(reader, settingsVersion);
-		commands.load(reader, settingsVersion);
+		loadIfPresent(any, reader, render, renderFields);
+		loadIfPresent(any, reader, player, playerFields);
+		loadIfPresent(any, reader, hud, hudFields);
+		loadIfPresent(any, reader, targetView, targetViewFields);
+		loadIfPresent(any, reader, clickToPhoton, clickToPhotonFields);
+		loadIfPresent(any, reader, audio, audioFields);
+		loadIfPresent(any, reader, timing, timingFields);
+		loadIfPresent(any, reader, feedback, feedbackFields);
+		loadIfPresent(any, reader, logger, loggerFields);
+		loadIfPresent(any, reader, menu, menuFields);
+		loadIfPresent(any, reader, commands, commandFields);
 		switch (settingsVersion) {
 		case 1:
-			reader.getIfPresent("scene", scene);
-			reader.getIfPresent("weapon", weapon);
+		{
+			// Scene and weapon are replaced (not merged) when specified
+			SceneConfig sceneConfig;
+			WeaponConfig weaponConfig;
+			if (reader.getIfPresent("scene", sceneConfig)) scene = sceneConfig;
+			if (reader.getIfPresent("weapon", weaponConfig)) weapon = weaponConfig;
 			reader.getIfPresent("questions", questionArray);
 			break;
+		}
 		default:
 			debugPrintf("Settings version '%d' not recognized in FpsConfig.\n", settingsVersion);
 			break;
@@ -366,20 +429,37 @@ public:
 		Any a(Any::TABLE);
 		FpsConfig def;
 		a["settingsVersion"] = settingsVersion;
-		if (forceAll || def.scene != scene) a["scene"] = scene;
-		a = render.addToAny(a, forceAll);
-		a = player.addToAny(a, forceAll);
-		a = hud.addToAny(a, forceAll);
-		a = targetView.addToAny(a, forceAll);
-		a = clickToPhoton.addToAny(a, forceAll);
-		a = audio.addToAny(a, forceAll);
-		a = timing.addToAny(a, forceAll);
-		a = feedback.addToAny(a, forceAll);
-		a = logger.addToAny(a, forceAll);
-		a = menu.addToAny(a, forceAll);
-		a = commands.addToAny(a, forceAll);
-		a["weapon"] = weapon.toAny(forceAll);
+		if (forceAll || *def.scene != *scene) a["scene"] = *scene;
+		a = render->addToAny(a, forceAll);
+		a = player->addToAny(a, forceAll);
+		a = hud->addToAny(a, forceAll);
+		a = targetView->addToAny(a, forceAll);
+		a = clickToPhoton->addToAny(a, forceAll);
+		a = audio->addToAny(a, forceAll);
+		a = timing->addToAny(a, forceAll);
+		a = feedback->addToAny(a, forceAll);
+		a = logger->addToAny(a, forceAll);
+		a = menu->addToAny(a, forceAll);
+		a = commands->addToAny(a, forceAll);
+		a["weapon"] = weapon->toAny(forceAll);
 		return a;
 	}
+
+	/** Give this config its own copy of any sub-configs it shares (e.g. before handing out pointers to its fields) */
+	void detach() {
+		scene.mutate();
+		render.mutate();
+		player.mutate();
+		hud.mutate();
+		audio.mutate();
+		timing.mutate();
+		feedback.mutate();
+		targetView.mutate();
+		clickToPhoton.mutate();
+		logger.mutate();
+		weapon.mutate();
+		menu.mutate();
+		commands.mutate();
+	}
 };
 
@@ -0,0 +1,94 @@
+#include "FramePacer.h"
+#include "TextLogSink.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+const float FramePacer::HistogramEdgesUs[FramePacer::HistogramBins - 1] = { 10.f, 25.f, 50.f, 100.f, 250.f, 500.f, 1000.f };
+
+/** System clock, sleeps on a high-resolution waitable timer when supported (otherwise a regular one) */
+class SystemPacerClock : public FramePacer::Clock {
+protected:
+	HANDLE m_timer = NULL;
+public:
+	SystemPacerClock() {
+		m_timer = CreateWaitableTimerEx(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if (m_timer == NULL) {
+			m_timer = CreateWaitableTimer(NULL, TRUE, NULL);
+		}
+	}
+	~SystemPacerClock() {
+		if (m_timer != NULL) CloseHandle(m_timer);
+	}
+
+	RealTime now() override { return System::time(); }
+
+	void sleep(RealTime duration) override {
+		if (m_timer == NULL) {
+			System::sleep(duration);
+			return;
+		}
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -(LONGLONG)(duration * 1e7);		// Relative time in 100ns units
+		if (SetWaitableTimer(m_timer, &dueTime, 0, NULL, NULL, FALSE)) {
+			WaitForSingleObject(m_timer, INFINITE);
+		}
+	}
+
+	void spin() override { YieldProcessor(); }
+};
+
+FramePacer::FramePacer(const shared_ptr<Clock>& clock) : m_clock(clock) {
+	if (isNull(m_clock)) {
+		m_clock = std::make_shared<SystemPacerClock>();
+	}
+}
+
+RealTime FramePacer::waitUntil(RealTime deadline) {
+	RealTime now = m_clock->now();
+	while (now < deadline) {
+		const RealTime remaining = deadline - now;
+		const RealTime spinS = spinTime();
+		if (remaining > spinS) {
+			// Coarse sleep up to the start of the spin window
+			const RealTime requested = remaining - spinS;
+			const RealTime start = now;
+			m_clock->sleep(requested);
+			now = m_clock->now();
+
+			// Track how far the OS overshoots our sleeps (decaying max)
+			const RealTime oversleep = (now - start) - requested;
+			m_oversleepS = max(oversleep, m_oversleepS * 0.999);
+		}
+		else {
+			m_clock->spin();
+			now = m_clock->now();
+		}
+	}
+	recordError(now - deadline);
+	return now;
+}
+
+void FramePacer::recordError(RealTime errorS) {
+	m_lastErrorS = errorS;
+	const float errUs = (float)(G3D::abs(errorS) * 1e6);
+	m_stats.frames++;
+	m_stats.sumUs += errUs;
+	m_stats.sumSqUs += (double)errUs * errUs;
+	m_stats.maxUs = max(m_stats.maxUs, errUs);
+	int bin = 0;
+	while (bin < HistogramBins - 1 && errUs >= HistogramEdgesUs[bin]) { bin++; }
+	m_stats.histogram[bin]++;
+}
+
+void FramePacer::printStatsToLog() const {
+	if (m_stats.frames == 0) return;
+	String hist;
+	for (int i = 0; i < HistogramBins; i++) {
+		const String label = (i < HistogramBins - 1) ? format("<%.0fus", HistogramEdgesUs[i]) : format(">=%.0fus", HistogramEdgesUs[HistogramBins - 2]);
+		hist += format("%s%s: %d", i == 0 ? "" : ", ", label.c_str(), m_stats.histogram[i]);
+	}
+	logPrintfAsync("Frame pacing error over %d frames: mean = %.1fus, rms = %.1fus, max = %.1fus, spin window = %.0fus\n\t[%s]\n",
+		m_stats.frames, m_stats.meanUs(), m_stats.rmsUs(), m_stats.maxUs, spinTime() * 1e6, hist.c_str());
+}
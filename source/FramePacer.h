@@ -0,0 +1,68 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Hybrid sleep/spin frame pacer
+
+	Waits until an absolute deadline by sleeping coarsely (on a high-resolution waitable timer where available) until
+	a short "spin" window before the deadline, then spin-waiting on the high-resolution clock for the remainder.
+	The spin window grows to cover the largest (recently) observed sleep overshoot, so the pacer adapts to the OS timer granularity.
+	The error (wake time - deadline) of every wait is recorded into a histogram for reporting.
+*/
+class FramePacer {
+public:
+	/** Time source used by the pacer (replaced w/ a fake clock for testing) */
+	class Clock {
+	public:
+		virtual ~Clock() {}
+		/** Current time (in seconds) */
+		virtual RealTime now() = 0;
+		/** Coarse (OS) sleep for the provided duration (in seconds) */
+		virtual void sleep(RealTime duration) = 0;
+		/** Called once per spin-wait iteration */
+		virtual void spin() {}
+	};
+
+	static const int HistogramBins = 8;
+	static const float HistogramEdgesUs[HistogramBins - 1];			///< Upper edges (in us) for all but the last histogram bin
+
+	/** Error distribution for all waits since the last reset */
+	struct ErrorStats {
+		int		frames = 0;											///< Number of waits recorded
+		double	sumUs = 0.0;										///< Sum of (absolute) errors (in us)
+		double	sumSqUs = 0.0;										///< Sum of squared errors (in us^2)
+		float	maxUs = 0.f;										///< Max (absolute) error (in us)
+		int		histogram[HistogramBins] = { 0 };					///< Count of waits by (absolute) error
+
+		float meanUs() const { return frames > 0 ? (float)(sumUs / frames) : 0.f; }
+		float rmsUs() const { return frames > 0 ? (float)sqrt(sumSqUs / frames) : 0.f; }
+	};
+
+protected:
+	shared_ptr<Clock>	m_clock;
+	RealTime			m_minSpinS = 0.002;							///< Minimum time before the deadline to switch from sleeping to spinning
+	RealTime			m_oversleepS = 0.0;							///< Decaying max of observed sleep overshoot
+	RealTime			m_lastErrorS = 0.0;							///< Error (wake time - deadline) of the last wait
+	ErrorStats			m_stats;
+
+	void recordError(RealTime errorS);
+
+public:
+	/** Create a pacer using the provided clock (or the system clock if none is provided) */
+	FramePacer(const shared_ptr<Clock>& clock = nullptr);
+
+	/** Set the minimum spin window (in seconds) */
+	void setMinSpinTime(RealTime s) { m_minSpinS = max(0.0, s); }
+
+	/** Current spin window (in seconds) */
+	RealTime spinTime() const { return max(m_minSpinS, 1.25 * m_oversleepS); }
+
+	/** Wait until the provided (absolute) deadline, returns the wake time */
+	RealTime waitUntil(RealTime deadline);
+
+	RealTime lastError() const { return m_lastErrorS; }
+	const ErrorStats& stats() const { return m_stats; }
+	void resetStats() { m_stats = ErrorStats(); }
+
+	/** Print the error distribution to the log */
+	void printStatsToLog() const;
+};
@@ -158,34 +158,34 @@ PlayerControls::PlayerControls(SessionConfig& config, std::function<void()> expo
 	GuiPane* pane = GuiWindow::pane();
 	auto heightPane = pane->addPane("Height");
 	heightPane->beginRow(); {
-		auto  c = heightPane->addNumberBox("Player Height", &(config.player.height), "m", GuiTheme::LINEAR_SLIDER, 0.2f, 3.0f);
+		auto  c = heightPane->addNumberBox("Player Height", &(config.player->height), "m", GuiTheme::LINEAR_SLIDER, 0.2f, 3.0f);
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	} heightPane->endRow();
 	heightPane->beginRow(); {
-		auto c = heightPane->addNumberBox("Player Crouch Height", &(config.player.crouchHeight), "m", GuiTheme::LINEAR_SLIDER, 0.2f, 3.0f);
+		auto c = heightPane->addNumberBox("Player Crouch Height", &(config.player->crouchHeight), "m", GuiTheme::LINEAR_SLIDER, 0.2f, 3.0f);
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	} heightPane->endRow();
 
 	auto movePane = pane->addPane("Movement");
 	movePane->beginRow(); {
-		auto c = movePane->addNumberBox("Move Rate", &(config.player.moveRate), "m/s", GuiTheme::LINEAR_SLIDER, 0.0f, 30.0f);
+		auto c = movePane->addNumberBox("Move Rate", &(config.player->moveRate), "m/s", GuiTheme::LINEAR_SLIDER, 0.0f, 30.0f);
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	}movePane->endRow();
 	movePane->beginRow(); {
-		auto c = movePane->addNumberBox("Jump Velocity", &(config.player.jumpVelocity), "m/s", GuiTheme::LINEAR_SLIDER, 0.0f, 50.0f, 0.1f);
+		auto c = movePane->addNumberBox("Jump Velocity", &(config.player->jumpVelocity), "m/s", GuiTheme::LINEAR_SLIDER, 0.0f, 50.0f, 0.1f);
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	} movePane->endRow();
 	movePane->beginRow(); {
-		auto c = movePane->addNumberBox("Jump Interval", &(config.player.jumpInterval), "s", GuiTheme::LINEAR_SLIDER, 0.0f, 10.0f, 0.1f);
+		auto c = movePane->addNumberBox("Jump Interval", &(config.player->jumpInterval), "s", GuiTheme::LINEAR_SLIDER, 0.0f, 10.0f, 0.1f);
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	} movePane->endRow();
 	movePane->beginRow(); {
-		auto c = movePane->addCheckBox("Jump Requires Contact?", &(config.player.jumpTouch));
+		auto c = movePane->addCheckBox("Jump Requires Contact?", &(config.player->jumpTouch));
 		c->setCaptionWidth(width / 2);
 		c->setWidth(width*0.95f);
 	} movePane->endRow();
@@ -208,16 +208,16 @@ RenderControls::RenderControls(FPSciApp* app, SessionConfig& config, bool& drawF
 
 	auto drawPane = pane->addPane("Drawing");
 	drawPane->beginRow(); {
-		auto cb = drawPane->addCheckBox("Show Weapon", &(config.weapon.renderModel));
-		cb->setEnabled(!config.weapon.modelSpec.filename.empty());
-		drawPane->addCheckBox("Show Bullets", &(config.weapon.renderBullets));
-		drawPane->addCheckBox("Show cooldown", &config.hud.renderWeaponStatus);
+		auto cb = drawPane->addCheckBox("Show Weapon", &(config.weapon->renderModel));
+		cb->setEnabled(!config.weapon->modelSpec.filename.empty());
+		drawPane->addCheckBox("Show Bullets", &(config.weapon->renderBullets));
+		drawPane->addCheckBox("Show cooldown", &config.hud->renderWeaponStatus);
 	}drawPane->endRow();
 	drawPane->beginRow(); {
-		drawPane->addCheckBox("Show HUD", &(config.hud.enable));
-		drawPane->addCheckBox("Show Banner", &(config.hud.showBanner));
-		drawPane->addCheckBox("Show Ammo", &(config.hud.showAmmo));
-		drawPane->addCheckBox("Show Health", &(config.hud.showPlayerHealthBar));
+		drawPane->addCheckBox("Show HUD", &(config.hud->enable));
+		drawPane->addCheckBox("Show Banner", &(config.hud->showBanner));
+		drawPane->addCheckBox("Show Ammo", &(config.hud->showAmmo));
+		drawPane->addCheckBox("Show Health", &(config.hud->showPlayerHealthBar));
 	} drawPane->endRow();
 
 	auto framePane = pane->addPane("Frame Rate/Delay");
@@ -226,11 +226,11 @@ RenderControls::RenderControls(FPSciApp* app, SessionConfig& config, bool& drawF
 		framePane->addCheckBox("Turbo mode", &turbo);
 	}framePane->endRow();
 	framePane->beginRow(); {
-		auto c = framePane->addNumberBox("Framerate", &(config.render.frameRate), "fps", GuiTheme::LINEAR_SLIDER, minFrameRate, maxFrameRate, 1.0f);
+		auto c = framePane->addNumberBox("Framerate", &(config.render->frameRate), "fps", GuiTheme::LINEAR_SLIDER, minFrameRate, maxFrameRate, 1.0f);
 		c->setWidth(width*0.95f);
 	} framePane->endRow();
 	framePane->beginRow(); {
-		auto c = framePane->addNumberBox("Display Lag", &(config.render.frameDelay), "f", GuiTheme::LINEAR_SLIDER, 0, maxFrameDelay);
+		auto c = framePane->addNumberBox("Display Lag", &(config.render->frameDelay), "f", GuiTheme::LINEAR_SLIDER, 0, maxFrameDelay);
 		c->setWidth(width*0.95f);
 	}framePane->endRow();
 
@@ -239,7 +239,7 @@ RenderControls::RenderControls(FPSciApp* app, SessionConfig& config, bool& drawF
 		m_storedMenuConfig.allowReticleChange = true;
 		m_storedMenuConfig.allowReticleChangeTimeChange = true;
 		m_showFullUserMenuBtn = menuPane->addButton("Show Full User Menu", this, &RenderControls::updateUserMenu);
-		if (config.menu.allowAnyChange()) {
+		if (config.menu->allowAnyChange()) {
 			// Default setup already allows any change
 			m_showFullUserMenuBtn->setEnabled(false);
 			m_showFullUserMenu = true;
@@ -257,7 +257,7 @@ RenderControls::RenderControls(FPSciApp* app, SessionConfig& config, bool& drawF
 }
 
 void RenderControls::updateUserMenu() {
-	MenuConfig tmp = m_app->sessConfig->menu;		// Store current config
+	MenuConfig tmp = *m_app->sessConfig->menu;		// Store current config
 	m_app->sessConfig->menu = m_storedMenuConfig;	// Swap the config w/ the stored version
 	if (!m_showFullUserMenu) {
 		m_showFullUserMenu = true;
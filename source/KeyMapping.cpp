@@ -27,6 +27,7 @@ KeyMapping::KeyMapping() {
 	map.set("moveWaypointRight", Array<GKey>{ GKey::INSERT });
 	map.set("moveWaypointLeft", Array<GKey>{ GKey::DELETE });
 	map.set("reloadConfigs", Array<GKey>{GKey::F5});
+	map.set("exportTrace", Array<GKey>{GKey::F6});
 	getUiKeyMapping();
 };
 
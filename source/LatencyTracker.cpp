@@ -0,0 +1,69 @@
+#include "LatencyTracker.h"
+
+void LatencyTracker::setEnabled(bool enabled) {
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_enabled = enabled;
+	m_pending.fastClear();
+	m_completed.fastClear();
+}
+
+void LatencyTracker::onInput(RealTime time) {
+	if (!m_enabled) return;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	if (m_pending.size() >= MaxPending) m_pending.remove(0);
+	Pending p;
+	p.latency.inputTime = time;
+	p.latency.frameDelay = m_frameDelay;
+	p.swapsRemaining = m_frameDelay;
+	m_pending.append(p);
+}
+
+void LatencyTracker::onSimulated(RealTime time, bool fired) {
+	if (!m_enabled) return;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (int i = 0; i < m_pending.size(); i++) {
+		Pending& p = m_pending[i];
+		if (p.fired) continue;
+		if (!fired) {
+			// Press didn't fire (e.g. weapon not ready), nothing to present
+			m_pending.remove(i--);
+			continue;
+		}
+		p.fired = true;
+		p.latency.fireTime = time;
+	}
+}
+
+void LatencyTracker::onRendered(RealTime renderStart, RealTime renderEnd) {
+	if (!m_enabled) return;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (Pending& p : m_pending) {
+		if (p.fired && !p.rendered && p.latency.fireTime <= renderStart) {
+			p.rendered = true;
+			p.latency.renderTime = renderEnd;
+		}
+	}
+}
+
+void LatencyTracker::onPresent(RealTime time) {
+	if (!m_enabled) return;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (int i = 0; i < m_pending.size(); i++) {
+		Pending& p = m_pending[i];
+		if (!p.rendered) continue;
+		if (p.swapsRemaining > 0) {
+			p.swapsRemaining--;
+			continue;
+		}
+		p.latency.presentTime = time;
+		m_completed.append(p.latency);
+		m_pending.remove(i--);
+	}
+}
+
+void LatencyTracker::takeCompleted(Array<ShotLatency>& shots) {
+	shots.fastClear();
+	if (!m_enabled) return;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	shots.swap(m_completed, shots);
+}
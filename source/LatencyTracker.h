@@ -0,0 +1,67 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+#include <mutex>
+
+/** Software (input to present) latency for a single shot */
+struct ShotLatency {
+	RealTime	inputTime = 0.0;				///< Time the shoot button press was ingested
+	RealTime	fireTime = 0.0;					///< Time the simulation step that fired the shot ran
+	RealTime	renderTime = 0.0;				///< Time the first frame including the shot finished rendering
+	RealTime	presentTime = 0.0;				///< Time the buffer swap that presented the shot returned
+	int			frameDelay = 0;					///< Configured frame delay (frames) at the time of the shot
+
+	RealTime inputToFire() const { return fireTime - inputTime; }
+	RealTime fireToRender() const { return renderTime - fireTime; }
+	RealTime renderToPresent() const { return presentTime - renderTime; }
+	RealTime total() const { return presentTime - inputTime; }
+};
+
+/** Follows each shoot button press through the frame pipeline to estimate (software) click-to-photon latency
+
+	Each press is timestamped at ingestion (onInput()), then matched to the simulation step that consumes it (onSimulated()),
+	the first frame rendered after it fired (onRendered()), and the buffer swap that presents that frame (onPresent()).
+	With a frame delay of N frames, the shot is presented by the (N+1)th swap after it is rendered.
+	All times are provided by the caller, so the tracker can be driven by a synthetic event stream.
+	Methods may be called from different threads (e.g. firing on the simulation thread).
+*/
+class LatencyTracker {
+protected:
+	/** A shot in flight */
+	struct Pending {
+		ShotLatency	latency;
+		bool		fired = false;
+		bool		rendered = false;
+		int			swapsRemaining = 0;			///< Swaps to wait (after rendering) before the shot is presented
+	};
+
+	std::mutex			m_mutex;
+	std::atomic<bool>	m_enabled{ false };			///< Read w/o the lock (by the input and render threads)
+	int					m_frameDelay = 0;
+	Array<Pending>		m_pending;
+	Array<ShotLatency>	m_completed;
+
+	static const int MaxPending = 64;			///< Drop the oldest shots beyond this (e.g. if frames stop being presented)
+
+public:
+	void setEnabled(bool enabled);
+	bool enabled() const { return m_enabled; }
+
+	/** Set the frame delay (in frames) applied to shots from now on */
+	void setFrameDelay(int frames) { m_frameDelay = max(0, frames); }
+
+	/** A shoot button press was ingested at the provided time */
+	void onInput(RealTime time);
+
+	/** A simulation step consumed the pending presses at the provided time, fired is false if no shot was fired (these presses are dropped) */
+	void onSimulated(RealTime time, bool fired);
+
+	/** A frame that started rendering at renderStart finished rendering at renderEnd (includes shots fired before renderStart) */
+	void onRendered(RealTime renderStart, RealTime renderEnd);
+
+	/** A buffer swap (present) returned at the provided time */
+	void onPresent(RealTime time);
+
+	/** Move all completed shots into the provided array */
+	void takeCompleted(Array<ShotLatency>& shots);
+};
@@ -1,5 +1,8 @@
 #include "Logger.h"
 #include "Session.h"
+#include "TextLogSink.h"
+#include "TraceRecorder.h"
+#include "ThreadPolicy.h"
 
 // TODO: Replace with the G3D timestamp uses.
 // utility function for generating a unique timestamp.
@@ -39,13 +42,14 @@ String FPSciLogger::genFileTimestamp() {
 void FPSciLogger::openResultsFile(const String& filename, 
 	const String& subjectID, 
 	const shared_ptr<SessionConfig>& sessConfig, 
-	const String& description)
+	const String& description,
+	const String& resumeStartTime)
 {
 	const bool createNewFile = !FileSystem::exists(filename);
 
 	// Open the file
 	if (sqlite3_open(filename.c_str(), &m_db)) {
-		logPrintf(("Error opening log file: " + filename).c_str());					// Write an error to the log
+		logPrintfAsync(("Error opening log file: " + filename).c_str());					// Write an error to the log
 	}
 
 	// Create tables if a new log file
@@ -62,7 +66,7 @@ void FPSciLogger::openResultsFile(const String& filename,
 				{ "trialsComplete", "integer" }
 		};
 		// add any user-specified parameters as headers
-		for (String name : sessConfig->logger.sessParamsToLog) { sessColumns.append({ "'" + name + "'", "text", "NOT NULL" }); }
+		for (String name : sessConfig->logger->sessParamsToLog) { sessColumns.append({ "'" + name + "'", "text", "NOT NULL" }); }
 		createTableInDB(m_db, "Sessions", sessColumns); // no need of Primary Key for this table.
 
 		// Targets Type table (written once per session)
@@ -112,6 +116,41 @@ void FPSciLogger::openResultsFile(const String& filename,
 		};
 		createTableInDB(m_db, "Trials", trialColumns);
 
+		// Trial counters table (CPU cycles by frame stage)
+		Columns trialCounterColumns = {
+				{ "session_id", "text" },
+				{ "trial_id", "integer" },
+				{ "trial_index", "integer"},
+				{ "block_id", "text"},
+				{ "frames", "integer" },
+				{ "input_cycles", "integer" },
+				{ "simulation_cycles", "integer" },
+				{ "pose_cycles", "integer" },
+				{ "wait_cycles", "integer" },
+				{ "graphics_cycles", "integer" },
+				{ "swap_cycles", "integer" },
+				{ "page_faults", "integer" },
+				{ "context_switches", "integer" },
+				{ "logger_write_cycles", "integer" },
+				{ "logger_writes", "integer" }
+		};
+		createTableInDB(m_db, "Trial_Counters", trialCounterColumns);
+
+		// Shot latency table (software input to present latency)
+		Columns shotLatencyColumns = {
+				{ "time", "text" },
+				{ "session_id", "text" },
+				{ "trial_id", "integer" },
+				{ "trial_index", "integer"},
+				{ "block_id", "text"},
+				{ "input_to_fire", "real" },
+				{ "fire_to_render", "real" },
+				{ "render_to_present", "real" },
+				{ "input_to_present", "real" },
+				{ "frame_delay", "integer" }
+		};
+		createTableInDB(m_db, "Shot_Latency", shotLatencyColumns);
+
 		// Target_Trajectory, only need to create the table.
 		Columns targetTrajectoryColumns = {
 				{ "time", "text" },
@@ -138,11 +177,74 @@ void FPSciLogger::openResultsFile(const String& filename,
 		// Frame_Info table
 		Columns frameInfoColumns = {
 				{"time", "text"},
-				//{"idt", "real"},
+				{"frame_number", "integer"},
+				{"rdt", "real"},
 				{"sdt", "real"},
+				{"idt", "real"},
+				{"input_time", "real"},
+				{"simulation_time", "real"},
+				{"pose_time", "real"},
+				{"wait_time", "real"},
+				{"graphics_time", "real"},
+				{"swap_time", "real"},
+				{"missed_deadline", "text"},
+				{"view_az", "real"},
+				{"view_el", "real"},
+				{"late_latch_yaw", "real"},
+				{"late_latch_pitch", "real"},
 		};
 		createTableInDB(m_db, "Frame_Info", frameInfoColumns);
 
+		// Hitches table
+		Columns hitchColumns = {
+				{"time", "text"},
+				{"session_id", "text"},
+				{"frame_number", "integer"},
+				{"frame_time", "real"},
+				{"budget", "real"},
+				{"input_time", "real"},
+				{"simulation_time", "real"},
+				{"pose_time", "real"},
+				{"wait_time", "real"},
+				{"graphics_time", "real"},
+				{"swap_time", "real"},
+				{"state", "text"},
+				{"trial_id", "integer"},
+				{"trial_index", "integer"},
+				{"block_id", "text"},
+				{"target_count", "integer"},
+				{"projectile_count", "integer"},
+				{"decal_count", "integer"},
+				{"logger_queue_bytes", "integer"},
+				{"profiler_zones", "text"},
+		};
+		createTableInDB(m_db, "Hitches", hitchColumns);
+
+		// Quality changes table
+		Columns qualityColumns = {
+				{"time", "text"},
+				{"session_id", "text"},
+				{"frame_number", "integer"},
+				{"from_level", "integer"},
+				{"to_level", "integer"},
+				{"level_name", "text"},
+				{"mean_frame_time", "real"},
+				{"budget", "real"},
+		};
+		createTableInDB(m_db, "Quality_Changes", qualityColumns);
+
+		// Commands table
+		Columns commandColumns = {
+				{"session_id", "text"},
+				{"event", "text"},
+				{"command", "text"},
+				{"blocking", "integer"},
+				{"status", "text"},
+				{"exit_code", "integer"},
+				{"duration_s", "real"},
+		};
+		createTableInDB(m_db, "Commands", commandColumns);
+
 		// Questions table
 		Columns questionColumns = {
 			{"session", "text"},
@@ -175,6 +277,12 @@ void FPSciLogger::openResultsFile(const String& filename,
 		createTableInDB(m_db, "Users", userColumns);
 	}
 
+	// A resumed session continues updating its existing entry
+	if (!resumeStartTime.empty()) {
+		m_openTimeStr = resumeStartTime;
+		return;
+	}
+
 	// Add the session info to the sessions table
 	m_openTimeStr = genUniqueTimestamp();
 	RowEntry sessValues = {
@@ -190,7 +298,7 @@ void FPSciLogger::openResultsFile(const String& filename,
 	// Create any table to do lookup here
 	Any a = sessConfig->toAny(true);
 	// Add the looked up values
-	for (String name : sessConfig->logger.sessParamsToLog) { sessValues.append("'" + a[name].unparse() + "'"); }
+	for (String name : sessConfig->logger->sessParamsToLog) { sessValues.append("'" + a[name].unparse() + "'"); }
 	// add header row
 	insertRowIntoDB(m_db, "Sessions", sessValues);
 
@@ -203,22 +311,65 @@ void FPSciLogger::updateSessionEntry(bool complete, int trialCount) {
 	char* errMsg;
 	String updateQ = "UPDATE Sessions SET end_time = '" + genUniqueTimestamp() + "', complete = '" + completeStr + "', trialsComplete = '" + trialCountStr + "' WHERE start_time = '" + m_openTimeStr + "'";
 	int ret = sqlite3_exec(m_db, updateQ.c_str(), 0, 0, &errMsg);
-	if (ret != SQLITE_OK) { logPrintf("Error in UPDATE statement (%s): %s\n", updateQ, errMsg); }
+	if (ret != SQLITE_OK) { logPrintfAsync("Error in UPDATE statement (%s): %s\n", updateQ, errMsg); }
 }
 
 void FPSciLogger::recordFrameInfo(const Array<FrameInfo>& frameInfo) {
 	Array<RowEntry> rows;
-	for (FrameInfo info : frameInfo) {
+	for (const FrameInfo& info : frameInfo) {
 		Array<String> frameValues = {
 			"'" + FPSciLogger::formatFileTime(info.time) + "'",
-			//String(std::to_string(info.idt)),
-			String(std::to_string(info.sdt))
+			String(std::to_string(info.frameNumber)),
+			String(std::to_string(info.rdt)),
+			String(std::to_string(info.sdt)),
+			String(std::to_string(info.idt)),
+			String(std::to_string(info.inputTime)),
+			String(std::to_string(info.simulationTime)),
+			String(std::to_string(info.poseTime)),
+			String(std::to_string(info.waitTime)),
+			String(std::to_string(info.graphicsTime)),
+			String(std::to_string(info.swapTime)),
+			info.missedDeadline ? "'true'" : "'false'",
+			String(std::to_string(info.view.x)),
+			String(std::to_string(info.view.y)),
+			String(std::to_string(info.lateLatch.x)),
+			String(std::to_string(info.lateLatch.y))
 		};
 		rows.append(frameValues);
 	}
 	insertRowsIntoDB(m_db, "Frame_Info", rows);
 }
 
+void FPSciLogger::recordHitches(const Array<HitchInfo>& hitches) {
+	Array<RowEntry> rows;
+	for (const HitchInfo& hitch : hitches) {
+		Array<String> hitchValues = {
+			"'" + FPSciLogger::formatFileTime(hitch.frame.time) + "'",
+			"'" + hitch.sessionId + "'",
+			String(std::to_string(hitch.frame.frameNumber)),
+			String(std::to_string(hitch.frameTime)),
+			String(std::to_string(hitch.budget)),
+			String(std::to_string(hitch.frame.inputTime)),
+			String(std::to_string(hitch.frame.simulationTime)),
+			String(std::to_string(hitch.frame.poseTime)),
+			String(std::to_string(hitch.frame.waitTime)),
+			String(std::to_string(hitch.frame.graphicsTime)),
+			String(std::to_string(hitch.frame.swapTime)),
+			"'" + hitch.state + "'",
+			String(std::to_string(hitch.trialIdx)),
+			String(std::to_string(hitch.trialCount)),
+			format("'Block %d'", hitch.block),
+			String(std::to_string(hitch.targetCount)),
+			String(std::to_string(hitch.projectileCount)),
+			String(std::to_string(hitch.decalCount)),
+			String(std::to_string(hitch.loggerQueueBytes)),
+			"'" + hitch.zones + "'"
+		};
+		rows.append(hitchValues);
+	}
+	insertRowsIntoDB(m_db, "Hitches", rows);
+}
+
 void FPSciLogger::recordPlayerActions(const Array<PlayerAction>& actions) {
 	Array<RowEntry> rows;
 	for (PlayerAction action : actions) {
@@ -263,13 +414,37 @@ void FPSciLogger::recordTargetLocations(const Array<TargetLocation>& locations)
 
 void FPSciLogger::loggerThreadEntry()
 {
+	TraceRecorder::common().setThreadName("FPSciLogger");
+	ThreadPolicy::applyRole("logger", "FPSciLogger");
 	std::unique_lock<std::mutex> lk(m_queueMutex);
 	while (m_running) {
 
 		m_queueCV.wait(lk, [this]{
-			return !m_running || m_flushNow || getTotalQueueBytes() >= m_bufferLimit;
+			return !m_running || m_flushNow || m_sampleTrialStart || m_pendingTrialCounters.size() > 0 || getTotalQueueBytes() >= m_bufferLimit;
 		});
 
+		// Complete the trial counters w/ their context switches (a trial end is handled before a later trial start)
+		if (m_sampleTrialStart || m_pendingTrialCounters.size() > 0) {
+			decltype(m_pendingTrialCounters) ended;
+			ended.swap(m_pendingTrialCounters, ended);
+			const bool trialStart = m_sampleTrialStart;
+			m_sampleTrialStart = false;
+			const uint32 threadId = m_contextSwitchThread;
+			lk.unlock();
+
+			const uint64 contextSwitches = StageCounters::threadContextSwitches(threadId);
+			for (TrialCounters& counters : ended) {
+				counters.append(String(std::to_string(contextSwitches - m_trialStartContextSwitches)));
+				counters.append(String(std::to_string(m_flushCycles.exchange(0))));		// Writes since the last trial
+				counters.append(String(std::to_string(m_flushes.exchange(0))));
+			}
+			if (trialStart) m_trialStartContextSwitches = contextSwitches;
+
+			lk.lock();
+			for (const TrialCounters& counters : ended) m_trialCounters.push_back(counters);
+			if (m_running && !m_flushNow && getTotalQueueBytes() < m_bufferLimit) continue;		// Nothing to write yet
+		}
+
 		// Move all the queues into temporary local copies.
 		// This is so we can release the lock and allow the queues to grow again while writing out the results.
 		// Also allocate new storage for each.
@@ -277,10 +452,18 @@ void FPSciLogger::loggerThreadEntry()
 		frameInfo.swap(m_frameInfo, frameInfo);
 		m_frameInfo.reserve(frameInfo.size() * 2);
 
+		decltype(m_hitches) hitches;
+		hitches.swap(m_hitches, hitches);
+		m_hitches.reserve(hitches.size() * 2);
+
 		decltype(m_playerActions) playerActions;
 		playerActions.swap(m_playerActions, playerActions);
 		m_playerActions.reserve(playerActions.size() * 2);
 
+		decltype(m_qualityChanges) qualityChanges;
+		qualityChanges.swap(m_qualityChanges, qualityChanges);
+		m_qualityChanges.reserve(qualityChanges.size() * 2);
+
 		decltype(m_questions) questions;
 		questions.swap(m_questions, questions);
 		m_questions.reserve(questions.size() * 2);
@@ -297,6 +480,18 @@ void FPSciLogger::loggerThreadEntry()
 		trials.swap(m_trials, trials);
 		m_trials.reserve(trials.size() * 2);
 
+		decltype(m_trialCounters) trialCounters;
+		trialCounters.swap(m_trialCounters, trialCounters);
+		m_trialCounters.reserve(trialCounters.size() * 2);
+
+		decltype(m_shotLatencies) shotLatencies;
+		shotLatencies.swap(m_shotLatencies, shotLatencies);
+		m_shotLatencies.reserve(shotLatencies.size() * 2);
+
+		decltype(m_commands) commands;
+		commands.swap(m_commands, commands);
+		m_commands.reserve(commands.size() * 2);
+
 		decltype(m_users) users;
 		users.swap(m_users, users);
 		m_users.reserve(users.size() * 2);
@@ -304,14 +499,26 @@ void FPSciLogger::loggerThreadEntry()
 		// Unlock all the now-empty queues and write out our temporary copies
 		lk.unlock();
 
+		TraceRecorder::beginEvent("FPSciLogger::write");
+		const uint64 startCycles = m_config.logPerfCounters ? StageCounters::threadCycles() : 0;
 		recordFrameInfo(frameInfo);
+		recordHitches(hitches);
 		recordPlayerActions(playerActions);
 		recordTargetLocations(targetLocations);
 
+		if (qualityChanges.size() > 0) insertRowsIntoDB(m_db, "Quality_Changes", qualityChanges);
 		insertRowsIntoDB(m_db, "Questions", questions);
 		insertRowsIntoDB(m_db, "Targets", targets);
 		insertRowsIntoDB(m_db, "Users", users);
 		insertRowsIntoDB(m_db, "Trials", trials);
+		if (trialCounters.size() > 0) insertRowsIntoDB(m_db, "Trial_Counters", trialCounters);
+		if (shotLatencies.size() > 0) insertRowsIntoDB(m_db, "Shot_Latency", shotLatencies);
+		if (commands.size() > 0) insertRowsIntoDB(m_db, "Commands", commands);
+		if (m_config.logPerfCounters) {
+			m_flushCycles += StageCounters::threadCycles() - startCycles;
+			m_flushes++;
+		}
+		TraceRecorder::endEvent();
 
 		lk.lock();
 	}
@@ -320,15 +527,16 @@ void FPSciLogger::loggerThreadEntry()
 FPSciLogger::FPSciLogger(const String& filename, 
 	const String& subjectID, 
 	const shared_ptr<SessionConfig>& sessConfig, 
-	const String& description 
-	) : m_db(nullptr), m_config(sessConfig->logger)
+	const String& description,
+	const String& resumeStartTime
+	) : m_db(nullptr), m_config(*sessConfig->logger), m_flushCycles(0), m_flushes(0)
 {
 	// Reserve some space in these arrays here
 	m_playerActions.reserve(5000);
 	m_targetLocations.reserve(5000);
 	
 	// Create the results file
-	openResultsFile(filename, subjectID,  sessConfig, description);
+	openResultsFile(filename, subjectID,  sessConfig, description, resumeStartTime);
 
 	// Thread management
 	m_running = true;
@@ -347,6 +555,23 @@ FPSciLogger::~FPSciLogger()
 	closeResultsFile();
 }
 
+void FPSciLogger::beginTrialContextSwitches() {
+	{
+		std::lock_guard<std::mutex> lk(m_queueMutex);
+		m_contextSwitchThread = (uint32)GetCurrentThreadId();
+		m_sampleTrialStart = true;
+	}
+	m_queueCV.notify_one();
+}
+
+void FPSciLogger::logTrialCounters(const TrialCounters& counters) {
+	{
+		std::lock_guard<std::mutex> lk(m_queueMutex);
+		m_pendingTrialCounters.push_back(counters);
+	}
+	m_queueCV.notify_one();
+}
+
 void FPSciLogger::flush(bool blockUntilDone)
 {
 	// Not implemented. Make another condition variable if this is needed.
@@ -360,7 +585,7 @@ void FPSciLogger::flush(bool blockUntilDone)
 }
 
 // Log target parameters into Target_Types table
-void FPSciLogger::logTargetTypes(const Array<shared_ptr<TargetConfig>>& targets) {
+void FPSciLogger::logTargetTypes(const Array<shared_ptr<const TargetConfig>>& targets) {
 	Array<RowEntry> rows;
 	for (auto config : targets) {
 		const String type = (config->destinations.size() > 0) ? "waypoint" : "parametrized";
@@ -392,7 +617,7 @@ void FPSciLogger::logTargetTypes(const Array<shared_ptr<TargetConfig>>& targets)
 	insertRowsIntoDB(m_db, "Target_Types", rows);
 }
 
-void FPSciLogger::addTarget(const String& name, const shared_ptr<TargetConfig>& config, const String& spawnTime, const float& size, const Point2& spawnEcc) {
+void FPSciLogger::addTarget(const String& name, const shared_ptr<const TargetConfig>& config, const String& spawnTime, const float& size, const Point2& spawnEcc) {
 	const RowEntry targetValues = {
 		"'" + name + "'",
 		"'" + config->id + "'",
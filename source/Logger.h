@@ -3,6 +3,7 @@
 #include "sqlHelpers.h"
 #include "UserConfig.h"
 #include "Session.h"
+#include <atomic>
 
 using RowEntry = Array<String>;
 using Columns = Array<Array<String>>;
@@ -10,6 +11,7 @@ using Columns = Array<Array<String>>;
 struct TargetLocation;
 struct PlayerAction;
 struct FrameInfo;
+struct HitchInfo;
 
 template<typename ItemType> static size_t queueBytes(Array<ItemType>& queue)
 {
@@ -23,6 +25,10 @@ public:
 	using QuestionResult = RowEntry;
 	using TrialValues = RowEntry;
 	using UserValues = RowEntry;
+	using QualityChange = RowEntry;
+	using TrialCounters = RowEntry;
+	using ShotLatencyValues = RowEntry;
+	using CommandResult = RowEntry;
 
 protected:
 	sqlite3* m_db = nullptr;						///< The db used for logging
@@ -38,23 +44,42 @@ protected:
 	std::mutex m_queueMutex;
 	std::condition_variable m_queueCV;
 
+	std::atomic<uint64> m_flushCycles;				///< CPU cycles spent by the logger thread writing results (when logging perf counters)
+	std::atomic<int> m_flushes;						///< Number of writes counted in m_flushCycles
+
+	// Per trial context switches are sampled on the logger thread (the snapshot is too slow for the main thread)
+	uint32 m_contextSwitchThread = 0;				///< Thread whose context switches are counted (the thread that starts the trials)
+	bool m_sampleTrialStart = false;				///< Sample the trial start context switch count (when the logger thread next wakes)
+	uint64 m_trialStartContextSwitches = 0;			///< Context switch count sampled at the trial start (logger thread only)
+	Array<TrialCounters> m_pendingTrialCounters;		///< Trial counters waiting for their (end of trial) context switch count
+
 	// Output queues for reported data storage
 	Array<FrameInfo> m_frameInfo;						///< Storage for frame info (sdt, idt, rdt)
+	Array<HitchInfo> m_hitches;							///< Storage for hitch (over budget frame) snapshots
 	Array<PlayerAction> m_playerActions;				///< Storage for player action (hit, miss, aim)
+	Array<QualityChange> m_qualityChanges;				///< Storage for adaptive quality level changes
 	Array<QuestionResult> m_questions;
 	Array<TargetLocation> m_targetLocations;			///< Storage for target trajectory (vector3 cartesian)
 	Array<TargetInfo> m_targets;
 	Array<TrialValues> m_trials;						///< Trial ID, start/end time etc.
+	Array<TrialCounters> m_trialCounters;				///< Per-trial CPU counters
+	Array<ShotLatencyValues> m_shotLatencies;			///< Per-shot (software) input to present latency
+	Array<CommandResult> m_commands;					///< Finished trial/session commands (w/ exit codes and durations)
 	Array<UserValues> m_users;
 
 	size_t getTotalQueueBytes()
 	{
 		return queueBytes(m_frameInfo) +
+			queueBytes(m_hitches) +
 			queueBytes(m_playerActions) +
+			queueBytes(m_qualityChanges) +
 			queueBytes(m_questions) +
 			queueBytes(m_targetLocations) +
 			queueBytes(m_targets) +
-			queueBytes(m_trials);
+			queueBytes(m_trials) +
+			queueBytes(m_trialCounters) +
+			queueBytes(m_shotLatencies) +
+			queueBytes(m_commands);
 	}
 
 	template<typename ItemType> void addToQueue(Array<ItemType>& queue, const ItemType& item)
@@ -76,6 +101,9 @@ protected:
 	/** Record an array of frame timing info */
 	void recordFrameInfo(const Array<FrameInfo>& info);
 
+	/** Record an array of hitch snapshots */
+	void recordHitches(const Array<HitchInfo>& hitches);
+
 	/** Record an array of player actions */
 	void recordPlayerActions(const Array<PlayerAction>& actions);
 
@@ -86,35 +114,54 @@ protected:
 	void openResultsFile(const String& filename, 
 		const String& subjectID, 
 		const shared_ptr<SessionConfig>& sessConfig, 
-		const String& description);
+		const String& description,
+		const String& resumeStartTime);
 
 	/** Close the results file */
 	void closeResultsFile(void);
 
 public:
 
-	FPSciLogger(const String& filename, const String& subjectID, const shared_ptr<SessionConfig>& sessConfig, const String& description);
+	FPSciLogger(const String& filename, const String& subjectID, const shared_ptr<SessionConfig>& sessConfig, const String& description, const String& resumeStartTime = "");
 	virtual ~FPSciLogger();
 	
+	/** @param resumeStartTime - Start time of an (interrupted) session to continue logging, rather than adding a new session to the file */
 	static shared_ptr<FPSciLogger> create(const String& filename, 
 		const String& subjectID, 
 		const shared_ptr<SessionConfig>& sessConfig,
-		const String& description="None") 
+		const String& description="None",
+		const String& resumeStartTime="") 
 	{
-		return createShared<FPSciLogger>(filename, subjectID, sessConfig, description);
+		return createShared<FPSciLogger>(filename, subjectID, sessConfig, description, resumeStartTime);
 	}
 
 	void updateSessionEntry(bool complete, int trialCount);
+	/** Start time of the session (its key in the Sessions table) */
+	const String& openTime() const { return m_openTimeStr; }
 
 	void logFrameInfo(const FrameInfo& frameInfo) { addToQueue(m_frameInfo, frameInfo); }
+	void logHitch(const HitchInfo& hitch) { addToQueue(m_hitches, hitch); }
 	void logPlayerAction(const PlayerAction& playerAction) { addToQueue(m_playerActions, playerAction); }
+	void logQualityChange(const QualityChange& change) { addToQueue(m_qualityChanges, change); }
 	void logQuestionResult(const QuestionResult& questionResult) { addToQueue(m_questions, questionResult); }
 	void logTargetLocation(const TargetLocation& targetLocation) { addToQueue(m_targetLocations, targetLocation); }
 	void logTargetInfo(const TargetInfo& targetInfo) { addToQueue(m_targets, targetInfo); }
 	void logTrial(const TrialValues& trial) { addToQueue(m_trials, trial); }
+	/** Start counting the calling thread's context switches for a trial (sampled on the logger thread as soon as it is free) */
+	void beginTrialContextSwitches();
+	/** Log a trial's counters, the logger thread appends the trial's context switches and its own write counters (since the last trial) */
+	void logTrialCounters(const TrialCounters& counters);
+	void logShotLatency(const ShotLatencyValues& latency) { addToQueue(m_shotLatencies, latency); }
+	void logCommand(const CommandResult& command) { addToQueue(m_commands, command); }
 
 	void logUserConfig(const UserConfig& userConfig, const String& sessId, const Vector2& sessTurnScale);
-	void logTargetTypes(const Array<shared_ptr<TargetConfig>>& targets);
+	void logTargetTypes(const Array<shared_ptr<const TargetConfig>>& targets);
+
+	/** Bytes of results currently waiting to be written */
+	size_t pendingBytes() {
+		std::lock_guard<std::mutex> lk(m_queueMutex);
+		return getTotalQueueBytes();
+	}
 
 	/** Wakes up the logging thread and flushes even if the buffer limit is not reached yet. */
 	void flush(bool blockUntilDone);
@@ -132,5 +179,5 @@ public:
 	void addQuestion(Question question, String session);
 
 	/** Add a target to an experiment */
-	void addTarget(const String& name, const shared_ptr<TargetConfig>& targetConfig, const String& spawnTime, const float& size, const Point2& spawnEcc);
+	void addTarget(const String& name, const shared_ptr<const TargetConfig>& targetConfig, const String& spawnTime, const float& size, const Point2& spawnEcc);
 };
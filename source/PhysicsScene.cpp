@@ -12,6 +12,48 @@ void PhysicsScene::poseExceptExcluded(Array<shared_ptr<Surface> >& surfaceArray,
         }
     }
 }
+
+void PhysicsScene::setQueueChanges(bool queue) {
+    m_queueChanges = queue;
+    if (!queue) applyQueuedChanges();
+}
+
+void PhysicsScene::insertOrQueue(const shared_ptr<Entity>& entity) {
+    if (m_queueChanges) m_queuedInserts.append(entity);
+    else insert(entity);
+}
+
+void PhysicsScene::removeOrQueue(const shared_ptr<Entity>& entity) {
+    if (!m_queueChanges) {
+        remove(entity);
+        return;
+    }
+    // An entity inserted and removed between applies never needs to be in the scene
+    const int idx = m_queuedInserts.findIndex(entity);
+    if (idx >= 0) m_queuedInserts.fastRemove(idx);
+    else m_queuedRemovals.append(entity);
+}
+
+void PhysicsScene::applyQueuedChanges() {
+    for (const shared_ptr<Entity>& entity : m_queuedInserts) {
+        insert(entity);
+    }
+    for (const shared_ptr<Entity>& entity : m_queuedRemovals) {
+        remove(entity);
+    }
+    m_queuedInserts.fastClear();
+    m_queuedRemovals.fastClear();
+}
+
+shared_ptr<Entity> PhysicsScene::intersect(const Ray& ray, float& distance, const std::function<bool(const shared_ptr<Entity>&)>& exclude, Model::HitInfo& info) const {
+    shared_ptr<Entity> closest;
+    for (const shared_ptr<Entity>& entity : m_entityArray) {
+        if (isNull(dynamic_cast<MarkerEntity*>(entity.get())) && !exclude(entity) && !m_queuedRemovals.contains(entity) && entity->intersect(ray, distance, info)) {
+            closest = entity;
+        }
+    }
+    return closest;
+}
  
 Any PhysicsScene::toAny() const {
     Any a = Scene::toAny();
@@ -9,6 +9,10 @@ protected:
     /** Polygons of all non-dynamic entitys */
     shared_ptr<TriTree>                     m_collisionTree;
 
+    bool                                    m_queueChanges = false;     ///< Queue inserts/removals (see setQueueChanges())
+    Array<shared_ptr<Entity>>               m_queuedInserts;
+    Array<shared_ptr<Entity>>               m_queuedRemovals;
+
     PhysicsScene(const shared_ptr<AmbientOcclusion>& ao) : Scene(ao) {
         m_collisionTree = TriTree::create(false);
     }
@@ -19,6 +23,23 @@ public:
 
     void poseExceptExcluded(Array<shared_ptr<Surface> >& surfaceArray, const String& excludedEntity);
 
+    /** Queue entity inserts/removals made w/ insertOrQueue()/removeOrQueue() until applyQueuedChanges() (rather than
+        applying them immediately). Lets the simulation thread add/remove entities w/o changing the entity array while
+        rendering reads it. Turning queueing off applies any queued changes. */
+    void setQueueChanges(bool queue);
+    /** Insert the entity (or queue it, see setQueueChanges()) */
+    void insertOrQueue(const shared_ptr<Entity>& entity);
+    /** Remove the entity (or queue it, see setQueueChanges()), it is skipped by intersect() from now on either way */
+    void removeOrQueue(const shared_ptr<Entity>& entity);
+    /** Apply the queued inserts/removals */
+    void applyQueuedChanges();
+
+    using Scene::intersect;
+
+    /** Closest (non-marker) entity hit by the ray, skipping any entity the exclude predicate returns true for.
+        Unlike passing an exclusion array, this doesn't need a list of every entity to skip built for each ray. */
+    shared_ptr<Entity> intersect(const Ray& ray, float& distance, const std::function<bool(const shared_ptr<Entity>&)>& exclude, Model::HitInfo& info) const;
+
     void setGravity(const Vector3& newGravity) { m_gravity = newGravity; }
     void setResetHeight(const float resetHeight) { m_resetHeight = resetHeight;  }
 
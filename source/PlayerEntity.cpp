@@ -1,5 +1,6 @@
 #include "PlayerEntity.h"
 #include "PhysicsScene.h"
+#include "TraceRecorder.h"
 
 // Disable collisions
 // #define NO_COLLISIONS
@@ -115,7 +116,7 @@ void PlayerEntity::updateFromInput(UserInput* ui) {
 	m_jumpPressed = false;
 
 	// Get the mouse rotation here
-	Vector2 mouseRotate = ui->mouseDXY() * turnScale * (float)m_cameraRadiansPerMouseDot;
+	Vector2 mouseRotate = mouseRotation(ui->mouseDXY());
 	float yaw = mouseRotate.x;
 	float pitch = mouseRotate.y;
 
@@ -124,6 +125,18 @@ void PlayerEntity::updateFromInput(UserInput* ui) {
 	setDesiredAngularVelocity(yaw, pitch);
 }
 
+void PlayerEntity::applyViewRotation() {
+	m_headingRadians += m_desiredYawVelocity;												// Integrate the yaw change into heading
+	m_headingRadians = mod1((m_headingRadians) / (2 * pif())) * 2 * pif();					// Keep the user's heading value in the [0,2pi) range		
+	m_headTilt -= m_desiredPitchVelocity;													// Integrate the pitch change into head tilt
+	m_headTilt = clamp(m_headTilt, -89.9f * units::degrees(), 89.9f * units::degrees());	// Keep the user's head tilt to <90°
+	// Set player frame rotation based on the heading and tilt
+	m_frame.rotation = Matrix3::fromAxisAngle(Vector3::unitY(), -m_headingRadians) * Matrix3::fromAxisAngle(Vector3::unitX(), m_headTilt);
+	// Consume the rotation (so it isn't applied again until the next input update)
+	m_desiredYawVelocity = 0.0f;
+	m_desiredPitchVelocity = 0.0f;
+}
+
 /** Maximum coordinate values for the player ship */
 void PlayerEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 	// Do not call Entity::onSimulation; that will override with spline animation
@@ -134,16 +147,13 @@ void PlayerEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 
 	if (!isNaN(deltaTime)) {
 		// Apply rotation first
-		m_headingRadians += m_desiredYawVelocity;												// Integrate the yaw change into heading
-		m_headingRadians = mod1((m_headingRadians) / (2 * pif())) * 2 * pif();					// Keep the user's heading value in the [0,2pi) range		
-		m_headTilt -= m_desiredPitchVelocity;													// Integrate the pitch change into head tilt
-		m_headTilt = clamp(m_headTilt, -89.9f * units::degrees(), 89.9f * units::degrees());	// Keep the user's head tilt to <90°
-		// Set player frame rotation based on the heading and tilt
-		m_frame.rotation = Matrix3::fromAxisAngle(Vector3::unitY(), -m_headingRadians) * Matrix3::fromAxisAngle(Vector3::unitX(), m_headTilt);
+		applyViewRotation();
 		
 		// Translation update - in direction after rotating
 		if (m_motionEnable) {
+			BEGIN_TRACE_EVENT("PlayerEntity::slideMove");
 			m_inContact = slideMove(deltaTime);
+			END_TRACE_EVENT();
 		}
 		
 		// Check for "off map" condition and reset position here...
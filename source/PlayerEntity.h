@@ -102,6 +102,17 @@ public:
 		return f;
 	}
 
+	/** Camera frame w/ an additional (not yet simulated) yaw/pitch rotation (in radians) applied, translation is unchanged */
+	const CFrame getRotatedCameraFrame(float yaw, float pitch) const {
+		CFrame f = getCameraFrame();
+		const float tilt = clamp(m_headTilt - pitch, -89.9f * units::degrees(), 89.9f * units::degrees());
+		f.rotation = Matrix3::fromAxisAngle(Vector3::unitY(), -(m_headingRadians + yaw)) * Matrix3::fromAxisAngle(Vector3::unitX(), tilt);
+		return f;
+	}
+
+	/** Convert a mouse motion (in mouse counts) to a (yaw, pitch) rotation (in radians) using the player's sensitivity */
+	Vector2 mouseRotation(const Vector2& mouseDelta) const { return mouseDelta * turnScale * m_cameraRadiansPerMouseDot; }
+
 	void setCrouched(bool crouched) { m_crouched = crouched; };
 	void setJumpPressed(bool pressed=true) { m_jumpPressed = pressed; }
 	void setMoveEnable(bool enabled) { m_motionEnable = enabled; }
@@ -156,4 +167,7 @@ public:
 	virtual void onSimulation(SimTime absoluteTime, SimTime deltaTime) override;
 	void updateFromInput(UserInput* ui);
 
+	/** Integrate the desired (yaw/pitch) angular velocity into the view rotation (consumes it, so it is only applied once per input update) */
+	void applyViewRotation();
+
 };
@@ -0,0 +1,417 @@
+#include "ProcessRunner.h"
+#include "TraceRecorder.h"
+#include "ThreadPolicy.h"
+#ifndef G3D_WINDOWS
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+static const int PollIntervalMs = 10;		///< Time between checks for process exit (while any are running)
+static const int ExitWaitMs = 10000;		///< Longest the destructor waits on blocking processes
+
+const char* CommandProcess::statusName(Status status) {
+	switch (status) {
+	case Status::Pending: return "pending";
+	case Status::Running: return "running";
+	case Status::Exited: return "exited";
+	case Status::Failed: return "failed";
+	case Status::Terminated: return "terminated";
+	}
+	return "unknown";
+}
+
+ProcessRunner::ProcessRunner() {
+#ifndef G3D_WINDOWS
+	signal(SIGPIPE, SIG_IGN);			// Writing to a process that exited shouldn't end the app
+#endif
+}
+
+ProcessRunner::~ProcessRunner() {
+	{
+		std::unique_lock<std::mutex> lk(m_mutex);
+		// Blocking commands are waited on (as if the app's next state was waiting on them), the rest are left running
+		const bool done = m_cv.wait_for(lk, std::chrono::milliseconds(ExitWaitMs), [this] {
+			for (const Entry& e : m_processes) {
+				if (e.process.blocking) return false;
+			}
+			return true;
+		});
+		if (!done) {
+			for (const Entry& e : m_processes) {
+				if (!e.process.blocking) continue;
+				logPrintf("Gave up waiting on blocking command at exit (leaving it %s): %s\n", CommandProcess::statusName(e.process.status), e.process.command.c_str());
+			}
+		}
+		m_running = false;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable()) m_thread.join();
+	for (const Entry& e : m_processes) {
+		if (e.process.status != CommandProcess::Status::Running) continue;
+		if (e.inputOpen) {
+			write(e.input, e.pending);					// Last chance for any queued input (that fits)
+			closePipe(e.input);							// Send EOF to processes reading their input
+		}
+		release(e.handle);
+	}
+}
+
+int ProcessRunner::launch(const String& command, bool foreground, bool blocking, const String& owner, const String& event, int after, bool pipeInput) {
+	int id;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		// Start the worker on first use, so it applies the thread policy from the (by then loaded) system config
+		if (!m_thread.joinable()) m_thread = std::thread(&ProcessRunner::threadEntry, this);
+		id = m_nextId++;
+		Entry& e = m_processes.next();
+		e.after = after;
+		e.pipeInput = pipeInput;
+		CommandProcess& p = e.process;
+		p.id = id;
+		p.command = command;
+		p.owner = owner;
+		p.event = event;
+		p.foreground = foreground;
+		p.blocking = blocking;
+	}
+	m_cv.notify_all();
+	return id;
+}
+
+void ProcessRunner::terminate(int id) {
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		const int idx = find(id);
+		if (idx < 0) return;
+		if (m_processes[idx].process.status == CommandProcess::Status::Pending) {
+			finish(idx, CommandProcess::Status::Terminated);		// Never launched
+			return;
+		}
+		m_processes[idx].terminate = true;
+	}
+	m_cv.notify_all();
+}
+
+bool ProcessRunner::send(int id, const String& line) {
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		const int idx = find(id);
+		if (idx < 0 || !m_processes[idx].pipeInput || m_processes[idx].closeInput) return false;
+		m_processes[idx].pending += line;
+		m_processes[idx].inputQueued = true;
+	}
+	m_cv.notify_all();
+	return true;
+}
+
+void ProcessRunner::closeInput(int id) {
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		const int idx = find(id);
+		if (idx < 0) return;
+		m_processes[idx].closeInput = true;
+		m_processes[idx].inputQueued = true;
+	}
+	m_cv.notify_all();
+}
+
+bool ProcessRunner::running(int id) const {
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return find(id) >= 0;
+}
+
+bool ProcessRunner::anyRunning(const Array<int>& ids) const {
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (int id : ids) {
+		if (find(id) >= 0) return true;
+	}
+	return false;
+}
+
+void ProcessRunner::takeFinished(Array<CommandProcess>& finished) {
+	std::lock_guard<std::mutex> lk(m_mutex);
+	finished.append(m_finished);
+	m_finished.fastClear();
+}
+
+int ProcessRunner::find(int id) const {
+	for (int i = 0; i < m_processes.size(); i++) {
+		if (m_processes[i].process.id == id) return i;
+	}
+	return -1;
+}
+
+bool ProcessRunner::launchable(const Entry& e) const {
+	return e.process.status == CommandProcess::Status::Pending && (e.after < 0 || find(e.after) < 0);
+}
+
+void ProcessRunner::finish(int idx, CommandProcess::Status status) {
+	Entry& e = m_processes[idx];
+	if (e.inputOpen) closePipe(e.input);
+	if (e.process.status == CommandProcess::Status::Running) release(e.handle);
+	e.process.status = status;
+	e.process.endTime = System::time();
+	m_finished.append(e.process);
+	m_processes.remove(idx);
+}
+
+void ProcessRunner::threadEntry() {
+	TraceRecorder::common().setThreadName("ProcessRunner");
+	ThreadPolicy::applyRole("helper", "ProcessRunner");
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (m_running) {
+		// Launch pending processes (w/o holding the lock, launching can be slow)
+		for (int i = 0; i < m_processes.size(); i++) {
+			if (!launchable(m_processes[i])) continue;
+			const int id = m_processes[i].process.id;
+			const String command = m_processes[i].process.command;
+			const bool foreground = m_processes[i].process.foreground;
+			const bool pipeInput = m_processes[i].pipeInput;
+			lk.unlock();
+			NativeHandle handle = NativeHandle();
+			PipeHandle input = PipeHandle();
+			String error;
+			const RealTime launchTime = System::time();
+			const bool success = spawn(command, foreground, pipeInput, handle, input, error);
+			lk.lock();
+
+			i = find(id);
+			if (i < 0) {						// Terminated while launching
+				if (success) {
+					if (pipeInput) closePipe(input);
+					kill(handle);
+					release(handle);
+				}
+				i = -1;							// Rescan (the array may have changed)
+				continue;
+			}
+			CommandProcess& p = m_processes[i].process;
+			p.launchTime = launchTime;
+			if (success) {
+				p.status = CommandProcess::Status::Running;
+				m_processes[i].handle = handle;
+				m_processes[i].input = input;
+				m_processes[i].inputOpen = pipeInput;
+			}
+			else {
+				p.error = error;
+				finish(i, CommandProcess::Status::Failed);
+				i = -1;
+			}
+		}
+
+		// Write queued input (the pipes are non-blocking, input that doesn't fit is retried on the next poll)
+		for (Entry& e : m_processes) {
+			if (e.process.status != CommandProcess::Status::Running || !hasInput(e)) continue;
+			e.inputQueued = false;
+			const int count = write(e.input, e.pending);
+			if (count < 0) e.pending.clear();				// Broken pipe (the process stopped reading/exited)
+			else e.pending = e.pending.substr(count);
+			if (count < 0 || (e.closeInput && e.pending.empty())) {
+				closePipe(e.input);
+				e.inputOpen = false;
+			}
+		}
+
+		// Check for exited (or to be terminated) processes
+		bool finished = false;
+		for (int i = m_processes.size() - 1; i >= 0; i--) {
+			Entry& e = m_processes[i];
+			if (e.process.status != CommandProcess::Status::Running) continue;
+			if (exited(e.handle, e.process.exitCode)) {
+				finish(i, CommandProcess::Status::Exited);
+				finished = true;
+			}
+			else if (e.terminate) {
+				kill(e.handle);
+				finish(i, CommandProcess::Status::Terminated);
+				finished = true;
+			}
+		}
+		if (finished) m_cv.notify_all();		// Wake the destructor (if waiting on blocking processes)
+
+		// Wait for new work, polling for exits while anything is running
+		const auto hasWork = [this] {
+			if (!m_running) return true;
+			for (const Entry& e : m_processes) {
+				if (launchable(e) || e.terminate || (e.process.status == CommandProcess::Status::Running && e.inputQueued && hasInput(e))) return true;
+			}
+			return false;
+		};
+		if (hasWork()) continue;
+		bool running = false;
+		for (const Entry& e : m_processes) {
+			running = running || (e.process.status == CommandProcess::Status::Running);
+		}
+		if (running) m_cv.wait_for(lk, std::chrono::milliseconds(PollIntervalMs), hasWork);
+		else m_cv.wait(lk, hasWork);
+	}
+}
+
+#ifdef G3D_WINDOWS
+
+static String lastErrorString() {
+	const DWORD code = GetLastError();
+	LPSTR msg = nullptr;
+	const DWORD len = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+		NULL, code, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&msg, 0, NULL);
+	const String error = len ? trimWhitespace(String(msg, len)) : format("Error %u", (unsigned)code);
+	if (notNull(msg)) LocalFree(msg);
+	return error;
+}
+
+bool ProcessRunner::spawn(const String& command, bool foreground, bool pipeInput, NativeHandle& handle, PipeHandle& input, String& error) {
+	STARTUPINFO si;
+	PROCESS_INFORMATION pi;
+	ZeroMemory(&si, sizeof(si));
+	si.cb = sizeof(si);
+	ZeroMemory(&pi, sizeof(pi));
+
+	HANDLE readPipe = NULL;
+	if (pipeInput) {
+		SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
+		if (!CreatePipe(&readPipe, &input, &sa, 0)) {
+			error = lastErrorString();
+			return false;
+		}
+		SetHandleInformation(input, HANDLE_FLAG_INHERIT, 0);		// Only the read end is inherited
+		DWORD mode = PIPE_NOWAIT;
+		SetNamedPipeHandleState(input, &mode, NULL, NULL);		// Writes never block the worker thread
+		si.dwFlags |= STARTF_USESTDHANDLES;
+		si.hStdInput = readPipe;
+		si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+		si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+	}
+
+	// CreateProcess may modify the command line, so pass it a copy
+	std::string cmd = command.c_str();
+	const bool validOutput = notNull(si.hStdOutput) && si.hStdOutput != INVALID_HANDLE_VALUE;
+	if (pipeInput && foreground && !validOutput) {
+		// STARTF_USESTDHANDLES replaces all the std handles, and the app has no stdout (GUI app) to pass on, so have the
+		// command's shell send its output to the new console instead (/S runs the rest of the command line verbatim)
+		cmd = format("cmd.exe /S /C \"%s >CONOUT$ 2>&1\"", command.c_str()).c_str();
+	}
+	bool success;
+	if (foreground) {	// Run process in the foreground
+		success = CreateProcess(NULL, &cmd[0], NULL, NULL, pipeInput, CREATE_NEW_CONSOLE, NULL, NULL, &si, &pi);
+	}
+	else {				// Run process silently in the background
+		success = CreateProcess(NULL, &cmd[0], NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+	}
+	if (!success) error = lastErrorString();
+	if (pipeInput) {
+		CloseHandle(readPipe);			// The process has its own copy
+		if (!success) CloseHandle(input);
+	}
+	if (!success) return false;
+	CloseHandle(pi.hThread);			// Only the process handle is needed
+	handle = pi.hProcess;
+	return true;
+}
+
+bool ProcessRunner::exited(NativeHandle handle, int& exitCode) {
+	if (WaitForSingleObject(handle, 0) != WAIT_OBJECT_0) return false;
+	DWORD code = 0;
+	GetExitCodeProcess(handle, &code);
+	exitCode = int(code);
+	return true;
+}
+
+void ProcessRunner::kill(NativeHandle handle) {
+	TerminateProcess(handle, 0);
+}
+
+void ProcessRunner::release(NativeHandle handle) {
+	CloseHandle(handle);
+}
+
+int ProcessRunner::write(PipeHandle input, const String& data) {
+	if (data.empty()) return 0;
+	DWORD count = 0;		// Non-blocking (PIPE_NOWAIT) writes return w/ only the bytes that fit
+	if (!WriteFile(input, data.c_str(), DWORD(data.length()), &count, NULL)) return -1;
+	return int(count);
+}
+
+void ProcessRunner::closePipe(PipeHandle input) {
+	CloseHandle(input);
+}
+
+#else
+
+bool ProcessRunner::spawn(const String& command, bool foreground, bool pipeInput, NativeHandle& handle, PipeHandle& input, String& error) {
+	int fds[2] = { -1, -1 };
+	if (pipeInput) {
+		if (pipe(fds) != 0) {
+			error = strerror(errno);
+			return false;
+		}
+		// Neither end leaks into other processes, the read end is dup'ed to the process's stdin
+		fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+		fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+		fcntl(fds[1], F_SETFL, O_NONBLOCK);			// Writes never block the worker thread
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	if (pipeInput) {
+		posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+	}
+	if (!foreground) {					// Run process silently in the background
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+		posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+	}
+	char* argv[] = { (char*)"/bin/sh", (char*)"-c", (char*)command.c_str(), nullptr };
+	const int result = posix_spawn(&handle, "/bin/sh", &actions, nullptr, argv, environ);
+	posix_spawn_file_actions_destroy(&actions);
+	if (pipeInput) {
+		close(fds[0]);					// The process has its own copy
+		if (result != 0) close(fds[1]);
+		else input = fds[1];
+	}
+	if (result != 0) {
+		error = strerror(result);
+		return false;
+	}
+	return true;
+}
+
+bool ProcessRunner::exited(NativeHandle handle, int& exitCode) {
+	int status = 0;
+	if (waitpid(handle, &status, WNOHANG) != handle) return false;
+	exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	return true;
+}
+
+void ProcessRunner::kill(NativeHandle handle) {
+	::kill(handle, SIGKILL);			// Like TerminateProcess()
+	waitpid(handle, nullptr, 0);		// Reap it
+}
+
+void ProcessRunner::release(NativeHandle handle) {
+	// Nothing to close, exited processes are reaped by exited()/kill()
+}
+
+int ProcessRunner::write(PipeHandle input, const String& data) {
+	size_t written = 0;
+	while (written < data.length()) {
+		const ssize_t count = ::write(input, data.c_str() + written, data.length() - written);
+		if (count < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;		// Pipe is full, write the rest later
+			return -1;
+		}
+		written += size_t(count);
+	}
+	return int(written);
+}
+
+void ProcessRunner::closePipe(PipeHandle input) {
+	close(input);
+}
+
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#ifndef G3D_WINDOWS
+#include <sys/types.h>
+#endif
+
+/** A command run by the ProcessRunner (and, once it has finished, its result) */
+struct CommandProcess {
+	enum class Status {
+		Pending,							///< Waiting for the worker thread to launch it
+		Running,
+		Exited,								///< Exited on its own (see exitCode)
+		Failed,								///< Could not be launched (see error)
+		Terminated							///< Terminated by the runner
+	};
+
+	int			id = -1;
+	String		command;
+	String		owner;						///< Id of the session that ran the command
+	String		event;						///< Event the command was run for (e.g. "start of trial")
+	bool		foreground = false;			///< Run in a new (visible) console
+	bool		blocking = false;			///< Does the caller wait for this command to complete?
+	Status		status = Status::Pending;
+	int			exitCode = -1;				///< Exit code (if status is Exited)
+	RealTime	launchTime = 0.0;			///< System::time() the process was launched
+	RealTime	endTime = 0.0;				///< System::time() the process exit/termination was observed
+	String		error;						///< Launch error (if status is Failed)
+
+	RealTime duration() const { return endTime - launchTime; }
+	static const char* statusName(Status status);
+};
+
+/** Launches external commands and tracks them to completion from a worker thread
+
+	Launching a process (and waiting for it) can take far longer than a frame, so callers only queue commands and poll
+	for their completion here. Finished processes are reported (w/ exit codes and durations) through takeFinished(), and
+	their handles are closed as soon as they exit. Processes still running when the runner is destroyed are left running
+	(so e.g. end of session commands can complete), except that blocking ones are waited on first (for up to 10s). The
+	worker thread is started by the first launch().
+
+	Processes launched w/ pipeInput read lines queued by send() on their stdin (written by the worker thread), so a
+	long-lived process can be signalled w/o launching a new one for every event. The pipes are non-blocking, so a
+	process that isn't reading its input only delays its own lines (whatever doesn't fit in the pipe stays queued and is
+	retried on the next poll). Closing their input (or destroying the runner) sends them EOF.
+*/
+class ProcessRunner {
+protected:
+#ifdef G3D_WINDOWS
+	typedef HANDLE NativeHandle;
+	typedef HANDLE PipeHandle;
+#else
+	typedef pid_t NativeHandle;
+	typedef int PipeHandle;
+#endif
+
+	struct Entry {
+		CommandProcess	process;
+		NativeHandle	handle = NativeHandle();
+		int				after = -1;						///< Id of a process that must finish before this one is launched
+		bool			terminate = false;				///< Has termination been requested?
+		bool			pipeInput = false;				///< Was the process launched w/ a stdin pipe?
+		bool			inputOpen = false;				///< Is input (the write end of the stdin pipe) open?
+		bool			closeInput = false;				///< Close input once the queued lines are written
+		bool			inputQueued = false;			///< Has input been queued (or closed) since the last write?
+		PipeHandle		input = PipeHandle();
+		String			pending;						///< Input queued (or only partially written) for the process's stdin
+	};
+
+	Array<Entry>			m_processes;				///< Pending and running processes
+	Array<CommandProcess>	m_finished;					///< Finished processes (not yet taken)
+	int						m_nextId = 0;
+
+	bool					m_running = true;
+	std::thread				m_thread;
+	mutable std::mutex		m_mutex;
+	std::condition_variable	m_cv;
+
+	void threadEntry();
+
+	/** Launch the process (without the lock held, w/ a stdin pipe if pipeInput), returns false and sets error on failure */
+	static bool spawn(const String& command, bool foreground, bool pipeInput, NativeHandle& handle, PipeHandle& input, String& error);
+	/** Check whether the process has exited (and get its exit code) */
+	static bool exited(NativeHandle handle, int& exitCode);
+	static void kill(NativeHandle handle);
+	/** Release the handle (w/o terminating the process) */
+	static void release(NativeHandle handle);
+	/** Write as much of the data as fits in a (non-blocking) stdin pipe, returns the bytes written or -1 if the pipe is broken */
+	static int write(PipeHandle input, const String& data);
+	static void closePipe(PipeHandle input);
+
+	int find(int id) const;
+	/** Is the entry waiting to be launched (and not waiting on another process)? */
+	bool launchable(const Entry& e) const;
+	/** Does the entry have input to write (or close)? */
+	static bool hasInput(const Entry& e) { return e.inputOpen && (e.pending.length() > 0 || e.closeInput); }
+	/** Move an entry to the finished list (and release its handle) */
+	void finish(int idx, CommandProcess::Status status);
+
+public:
+	ProcessRunner();
+	~ProcessRunner();
+
+	/** Queue a command to run (once the after process finishes, if provided), returns an id for polling/terminating it
+		@param pipeInput - Connect the process's stdin to a pipe written w/ send() */
+	int launch(const String& command, bool foreground, bool blocking, const String& owner, const String& event, int after = -1, bool pipeInput = false);
+
+	/** Queue a line (include the newline) for a process launched w/ pipeInput, returns false if it isn't running/pending */
+	bool send(int id, const String& line);
+	/** Close a process's input (once queued lines are written), so it reads EOF */
+	void closeInput(int id);
+
+	/** Request termination of a process (if it hasn't finished already) */
+	void terminate(int id);
+
+	/** Is the process pending or running? */
+	bool running(int id) const;
+	/** Are any of the processes pending or running? */
+	bool anyRunning(const Array<int>& ids) const;
+
+	/** Append the processes that finished since the last call to finished */
+	void takeFinished(Array<CommandProcess>& finished);
+};
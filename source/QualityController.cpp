@@ -0,0 +1,107 @@
+#include "QualityController.h"
+
+QualityLevel::QualityLevel(const Any& any) {
+	AnyTableReader reader(any);
+	int settingsVersion = 1;
+	reader.getIfPresent("settingsVersion", settingsVersion);
+	switch (settingsVersion) {
+	case 1:
+		reader.getIfPresent("name", name);
+		reader.getIfPresent("ambientOcclusion", ambientOcclusion);
+		reader.getIfPresent("antialiasing", antialiasing);
+		reader.getIfPresent("bloomStrength", bloomStrength);
+		reader.getIfPresent("shadows", shadows);
+		break;
+	default:
+		throw format("Did not recognize quality level settings version: %d", settingsVersion);
+		break;
+	}
+}
+
+Any QualityLevel::toAny(const bool forceAll) const {
+	Any a(Any::TABLE);
+	QualityLevel def;
+	if (forceAll || def.name != name)							a["name"] = name;
+	if (forceAll || def.ambientOcclusion != ambientOcclusion)	a["ambientOcclusion"] = ambientOcclusion;
+	if (forceAll || def.antialiasing != antialiasing)			a["antialiasing"] = antialiasing;
+	if (forceAll || def.bloomStrength != bloomStrength)			a["bloomStrength"] = bloomStrength;
+	if (forceAll || def.shadows != shadows)						a["shadows"] = shadows;
+	return a;
+}
+
+bool QualityLevel::operator!=(const QualityLevel& other) const {
+	return name != other.name ||
+		ambientOcclusion != other.ambientOcclusion ||
+		antialiasing != other.antialiasing ||
+		bloomStrength != other.bloomStrength ||
+		shadows != other.shadows;
+}
+
+Array<QualityLevel> QualityLevel::defaultLadder() {
+	return {
+		QualityLevel("high",	true,	true,	0.5f,	true),
+		QualityLevel("noAO",	false,	true,	0.5f,	true),
+		QualityLevel("noBloom",	false,	true,	0.0f,	true),
+		QualityLevel("noAA",	false,	false,	0.0f,	true),
+		QualityLevel("minimal",	false,	false,	0.0f,	false),
+	};
+}
+
+void QualityController::configure(const Array<QualityLevel>& ladder, const Settings& settings, RealTime targetFrameTime) {
+	m_ladder = ladder;
+	if (m_ladder.size() == 0) m_ladder.append(QualityLevel());
+	m_settings = settings;
+	m_settings.windowFrames = max(1, m_settings.windowFrames);
+	m_targetFrameTime = targetFrameTime;
+	m_level = 0;
+	m_window.resize(m_settings.windowFrames);
+	resetWindow();
+}
+
+void QualityController::resetWindow() {
+	m_windowPos = 0;
+	m_windowCount = 0;
+	m_windowSum = 0.0;
+	m_framesUnderUpgrade = 0;
+}
+
+bool QualityController::addFrameTime(float frameTime) {
+	if (!enabled()) return false;
+
+	// Update the rolling window
+	if (m_windowCount == m_window.size()) {
+		m_windowSum -= m_window[m_windowPos];
+	}
+	else {
+		m_windowCount++;
+	}
+	m_window[m_windowPos] = frameTime;
+	m_windowSum += frameTime;
+	m_windowPos = (m_windowPos + 1) % m_window.size();
+
+	// Only make decisions once the window is full
+	if (m_windowCount < m_window.size()) return false;
+
+	const double mean = m_windowSum / m_windowCount;
+	if (mean > m_settings.downgradeThreshold * m_targetFrameTime) {
+		m_framesUnderUpgrade = 0;
+		if (m_level < m_ladder.size() - 1) {
+			m_level++;
+			resetWindow();
+			return true;
+		}
+	}
+	else if (mean < m_settings.upgradeThreshold * m_targetFrameTime) {
+		m_framesUnderUpgrade++;
+		if (m_level > 0 && m_framesUnderUpgrade >= m_settings.upgradeFrames) {
+			m_level--;
+			resetWindow();
+			return true;
+		}
+	}
+	else {
+		// In the hysteresis band, hold the current level
+		m_framesUnderUpgrade = 0;
+	}
+	return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** A single step on the adaptive quality ladder (rendering features to enable at this level) */
+class QualityLevel {
+public:
+	String	name = "high";							///< Name of this level (for logging)
+	bool	ambientOcclusion = true;				///< Enable screen space ambient occlusion
+	bool	antialiasing = true;					///< Enable (film) antialiasing
+	float	bloomStrength = 0.5f;					///< Bloom strength (0 to disable bloom)
+	bool	shadows = true;							///< Allow lights that cast shadows to do so
+
+	QualityLevel() {}
+	QualityLevel(const String& name, bool ambientOcclusion, bool antialiasing, float bloomStrength, bool shadows) :
+		name(name), ambientOcclusion(ambientOcclusion), antialiasing(antialiasing), bloomStrength(bloomStrength), shadows(shadows) {}
+	QualityLevel(const Any& any);
+
+	Any toAny(const bool forceAll = false) const;
+	bool operator!=(const QualityLevel& other) const;
+	bool operator==(const QualityLevel& other) const { return !(*this != other); }
+
+	/** Default ladder (highest quality first) */
+	static Array<QualityLevel> defaultLadder();
+
+	/** The fixed low quality level used for the (manual) emergency turbo mode */
+	static QualityLevel turbo() { return QualityLevel("turbo", false, false, 0.0f, true); }
+};
+
+/** Closed-loop controller that picks a level from a quality ladder based on recent frame times
+
+	Frame (work) times are averaged over a rolling window and compared to the target frame duration.
+	The controller steps down one level (lower quality) as soon as a full window averages over the downgrade threshold,
+	but only steps back up after the window average has stayed under the (lower) upgrade threshold for a longer run of frames.
+	The window is cleared after every change so each decision only considers frames rendered at the current level.
+
+	The controller is pure logic (frame times are provided by the caller), so it can be driven by a synthetic frame time stream.
+*/
+class QualityController {
+public:
+	struct Settings {
+		float	downgradeThreshold = 0.9f;			///< Step down when the mean frame time exceeds this fraction of the target frame duration
+		float	upgradeThreshold = 0.6f;			///< Step up when the mean frame time stays under this fraction of the target frame duration
+		int		windowFrames = 30;					///< Number of frames averaged for each decision
+		int		upgradeFrames = 240;				///< Number of (consecutive) frames under the upgrade threshold required to step up
+	};
+
+protected:
+	Array<QualityLevel>	m_ladder;
+	Settings			m_settings;
+	RealTime			m_targetFrameTime = 0.0;	///< Target frame duration (in seconds), 0 disables the controller
+	int					m_level = 0;				///< Current index into the ladder (0 is highest quality)
+
+	Array<float>		m_window;					///< Ring buffer of recent frame times
+	int					m_windowPos = 0;
+	int					m_windowCount = 0;
+	double				m_windowSum = 0.0;
+	int					m_framesUnderUpgrade = 0;	///< Consecutive frames w/ a window mean under the upgrade threshold
+
+	void resetWindow();
+
+public:
+	QualityController() { configure(QualityLevel::defaultLadder(), Settings(), 0.0); }
+
+	/** Set the ladder/thresholds and target frame duration (in seconds), resets to the highest quality level */
+	void configure(const Array<QualityLevel>& ladder, const Settings& settings, RealTime targetFrameTime);
+
+	/** Add the (work) time of the most recent frame (in seconds), returns true if the quality level changed */
+	bool addFrameTime(float frameTime);
+
+	/** Mean of the frame times in the current window (in seconds) */
+	float meanFrameTime() const { return m_windowCount > 0 ? (float)(m_windowSum / m_windowCount) : 0.0f; }
+
+	int level() const { return m_level; }
+	int levelCount() const { return m_ladder.size(); }
+	const QualityLevel& current() const { return m_ladder[m_level]; }
+	bool enabled() const { return m_targetFrameTime > 0.0 && m_ladder.size() > 1; }
+};
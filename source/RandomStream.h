@@ -0,0 +1,76 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** A counter-based (SplitMix64) random number stream
+
+	Each draw hashes the stream's key w/ a counter, so a stream's values only depend on its seed, its stream id, and the
+	number of values drawn from it. Give each independent consumer (e.g. each target) its own stream so its values don't
+	depend on how many values other consumers drew (or in which order they drew them). Streams are tiny and copyable,
+	but a single stream must not be drawn from by more than one thread at a time.
+*/
+class RandomStream {
+protected:
+	uint64	m_key = 0;					///< Key for this stream (derived from the seed and stream id)
+	uint64	m_counter = 0;				///< Number of values drawn so far
+
+	static const uint64 Gamma = 0x9E3779B97F4A7C15ull;
+
+	/** SplitMix64 finalizer */
+	static uint64 mix(uint64 z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+public:
+	RandomStream(uint64 seed = 0, uint64 stream = 0) : m_key(mix(mix(seed + Gamma) + stream)) {}
+
+	/** Next 64 random bits */
+	uint64 bits64() { return mix(m_key + Gamma * ++m_counter); }
+	/** Next 32 random bits */
+	uint32 bits() { return uint32(bits64() >> 32); }
+
+	/** Uniform random float in [0, 1) */
+	float uniform() { return float(bits64() >> 40) * (1.0f / 16777216.0f); }
+	/** Uniform random float in [low, high] */
+	float uniform(float low, float high) { return low + (high - low) * uniform(); }
+
+	/** Uniform random integer in [low, high] */
+	int integer(int low, int high) {
+		const double u = double(bits64() >> 11) * (1.0 / 9007199254740992.0);
+		return min(high, low + int(u * (double(high) - double(low) + 1.0)));
+	}
+
+	/** Normally distributed random float (Box-Muller, one draw of two values per call) */
+	float gaussian(float mean, float stdev) {
+		const float u1 = 1.0f - uniform();				// (0, 1] to avoid log(0)
+		const float u2 = uniform();
+		return mean + stdev * sqrt(-2.0f * log(u1)) * cos(2.0f * pif() * u2);
+	}
+
+	/** Randomly returns either +1 or -1 */
+	float sign() { return (uniform() < 0.5f) ? -1.0f : 1.0f; }
+
+	/** Uniform random point inside the box */
+	Point3 interiorPoint(const AABox& box) {
+		Point3 p;
+		p.x = uniform(box.low().x, box.high().x);
+		p.y = uniform(box.low().y, box.high().y);
+		p.z = uniform(box.low().z, box.high().z);
+		return p;
+	}
+
+	/** Uniformly distributed random unit vector */
+	Vector3 direction() {
+		Vector3 v;
+		do {
+			v.x = uniform(-1.0f, 1.0f);
+			v.y = uniform(-1.0f, 1.0f);
+			v.z = uniform(-1.0f, 1.0f);
+		} while (v.squaredLength() > 1.0f || v.squaredLength() < 1e-6f);
+		return v.direction();
+	}
+
+	/** Number of values drawn from this stream */
+	uint64 counter() const { return m_counter; }
+};
@@ -0,0 +1,104 @@
+#include "RawInputThread.h"
+#include "TextLogSink.h"
+#include "TraceRecorder.h"
+#include "ThreadPolicy.h"
+
+static LRESULT CALLBACK rawInputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	if (msg == WM_INPUT) {
+		RawInputThread* thread = (RawInputThread*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+		if (notNull(thread)) thread->onRawInput(lParam);
+	}
+	return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+void RawInputThread::start(TimedInputQueue* queue) {
+	stop();
+	m_queue = queue;
+	m_running = true;
+	m_thread = std::thread(&RawInputThread::threadEntry, this);
+}
+
+void RawInputThread::stop() {
+	// Join even if not running (the thread stops itself if raw input can't be registered)
+	m_running = false;
+	if (m_thread.joinable()) m_thread.join();
+}
+
+void RawInputThread::onRawInput(LPARAM lParam) {
+	const RealTime time = System::time();
+	RAWINPUT raw;
+	UINT size = sizeof(raw);
+	if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) return;
+	if (raw.header.dwType != RIM_TYPEMOUSE) return;
+
+	if (!(raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) {
+		m_motionX += raw.data.mouse.lLastX;
+		m_motionY += raw.data.mouse.lLastY;
+	}
+
+	const USHORT flags = raw.data.mouse.usButtonFlags;
+	if (flags == 0) return;							// Motion only
+	const struct { USHORT down; USHORT up; GKey key; } buttons[] = {
+		{ RI_MOUSE_LEFT_BUTTON_DOWN,	RI_MOUSE_LEFT_BUTTON_UP,	GKey::LEFT_MOUSE },
+		{ RI_MOUSE_MIDDLE_BUTTON_DOWN,	RI_MOUSE_MIDDLE_BUTTON_UP,	GKey::MIDDLE_MOUSE },
+		{ RI_MOUSE_RIGHT_BUTTON_DOWN,	RI_MOUSE_RIGHT_BUTTON_UP,	GKey::RIGHT_MOUSE },
+	};
+	for (const auto& b : buttons) {
+		if (flags & b.down) m_queue->push(TimedInputEvent(TimedInputEvent::ButtonDown, b.key, time));
+		if (flags & b.up) m_queue->push(TimedInputEvent(TimedInputEvent::ButtonUp, b.key, time));
+	}
+}
+
+void RawInputThread::threadEntry() {
+	TraceRecorder::common().setThreadName("RawInput");
+	ThreadPolicy::applyRole("helper", "RawInput");
+
+	// Raw input is delivered to a (hidden) message-only window owned by this thread
+	const HINSTANCE instance = GetModuleHandle(NULL);
+	WNDCLASSEX wc = {};
+	wc.cbSize = sizeof(wc);
+	wc.lpfnWndProc = rawInputWndProc;
+	wc.hInstance = instance;
+	wc.lpszClassName = TEXT("FPSciRawInput");
+	RegisterClassEx(&wc);
+	HWND hwnd = CreateWindowEx(0, wc.lpszClassName, TEXT(""), 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, instance, NULL);
+	if (hwnd == NULL) {
+		logPrintfAsync("Could not create raw input window (error %u), raw input thread stopped\n", (unsigned)GetLastError());
+		m_running = false;
+		return;
+	}
+	SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)this);
+
+	// Receive mouse input even though this window never has focus (legacy mouse messages are still sent to the app window)
+	RAWINPUTDEVICE device;
+	device.usUsagePage = 0x01;			// Generic desktop
+	device.usUsage = 0x02;				// Mouse
+	device.dwFlags = RIDEV_INPUTSINK;
+	device.hwndTarget = hwnd;
+	if (!RegisterRawInputDevices(&device, 1, sizeof(device))) {
+		logPrintfAsync("Could not register for raw mouse input (error %u), raw input thread stopped\n", (unsigned)GetLastError());
+		DestroyWindow(hwnd);
+		m_running = false;
+		return;
+	}
+	logPrintfAsync("Started raw input thread\n");
+
+	// Wake at least every 10ms to check for stop()
+	MSG msg;
+	while (m_running) {
+		MsgWaitForMultipleObjects(0, NULL, FALSE, 10, QS_ALLINPUT);
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+	}
+
+	device.dwFlags = RIDEV_REMOVE;
+	device.hwndTarget = NULL;
+	RegisterRawInputDevices(&device, 1, sizeof(device));
+	DestroyWindow(hwnd);
+	if (m_queue->dropped() > 0) {
+		logPrintfAsync("Raw input queue dropped %llu events\n", (unsigned long long)m_queue->dropped());
+	}
+	logPrintfAsync("Stopped raw input thread\n");
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+#include <thread>
+
+/** A button event stamped w/ the (System::time()) time it was received */
+struct TimedInputEvent {
+	enum Type {
+		ButtonDown,
+		ButtonUp
+	};
+
+	Type		type = ButtonDown;
+	GKey		key;						///< Button (e.g. GKey::LEFT_MOUSE)
+	RealTime	time = 0.0;					///< Time the event was received (System::time())
+
+	TimedInputEvent() {}
+	TimedInputEvent(Type type, GKey key, RealTime time) : type(type), key(key), time(time) {}
+};
+
+/** Lock-free single producer/single consumer queue of timestamped input events
+
+	Only one thread may push (e.g. the raw input thread, or a test injecting events) and only one thread may pop.
+*/
+class TimedInputQueue {
+public:
+	static const int Capacity = 1024;		///< Max queued events (must be a power of 2)
+
+protected:
+	TimedInputEvent			m_events[Capacity];
+	std::atomic<uint64>		m_readPos;		///< Next event to pop (only advanced by the consumer)
+	std::atomic<uint64>		m_writePos;		///< Next slot to fill (only advanced by the producer)
+	std::atomic<uint64>		m_dropped;		///< Events dropped because the queue was full
+
+public:
+	TimedInputQueue() : m_readPos(0), m_writePos(0), m_dropped(0) {}
+
+	/** Add an event (producer only), returns false (and drops the event) if the queue is full */
+	bool push(const TimedInputEvent& e) {
+		const uint64 pos = m_writePos.load(std::memory_order_relaxed);
+		if (pos - m_readPos.load(std::memory_order_acquire) >= Capacity) {
+			m_dropped++;
+			return false;
+		}
+		m_events[pos & (Capacity - 1)] = e;
+		m_writePos.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Pop the oldest event if it was received at or before the provided time (consumer only) */
+	bool popUntil(RealTime time, TimedInputEvent& e) {
+		const uint64 pos = m_readPos.load(std::memory_order_relaxed);
+		if (pos == m_writePos.load(std::memory_order_acquire)) return false;
+		const TimedInputEvent& next = m_events[pos & (Capacity - 1)];
+		if (next.time > time) return false;
+		e = next;
+		m_readPos.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const { return m_readPos.load(std::memory_order_acquire) == m_writePos.load(std::memory_order_acquire); }
+	uint64 dropped() const { return m_dropped; }
+};
+
+/** Reads raw mouse button events (Windows Raw Input) on its own thread and queues them w/ high resolution timestamps
+
+	Relative mouse motion is also accumulated (see motion()), so consumers can sample motion that arrived mid-frame.
+
+	Events are received at device rate on a message-only window, independent of the frame rate, so button presses
+	keep the time they actually arrived rather than the time the next frame's input stage observed them.
+*/
+class RawInputThread {
+protected:
+	std::thread				m_thread;
+	std::atomic<bool>		m_running;
+	TimedInputQueue*		m_queue = nullptr;
+	std::atomic<int64>		m_motionX;		///< Accumulated relative mouse motion (in mouse counts)
+	std::atomic<int64>		m_motionY;
+
+	void threadEntry();
+
+public:
+	RawInputThread() : m_running(false), m_motionX(0), m_motionY(0) {}
+	~RawInputThread() { stop(); }
+
+	/** Start reading raw input into the provided queue (this thread becomes the queue's producer) */
+	void start(TimedInputQueue* queue);
+	void stop();
+	bool running() const { return m_running; }
+
+	/** Total relative mouse motion (in mouse counts) received since the thread was created, difference two samples to get a delta */
+	void motion(int64& x, int64& y) const {
+		x = m_motionX.load(std::memory_order_relaxed);
+		y = m_motionY.load(std::memory_order_relaxed);
+	}
+
+	/** Handle a WM_INPUT message (called on the raw input thread) */
+	void onRawInput(LPARAM lParam);
+};
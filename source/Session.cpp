@@ -32,6 +32,7 @@
 #include "PlayerEntity.h"
 #include "Dialogs.h"
 #include "Weapon.h"
+#include "TraceRecorder.h"
 
 TrialCount::TrialCount(const Any& any) {
 	int settingsVersion = 1;
@@ -62,7 +63,7 @@ Any TrialCount::toAny(const bool forceAll) const {
 }
 
 SessionConfig::SessionConfig(const Any& any) : FpsConfig(any, defaultConfig()) {
-	TrialCount::defaultCount = timing.defaultTrialCount;
+	TrialCount::defaultCount = timing.get().defaultTrialCount;
 	AnyTableReader reader(any);
 	switch (settingsVersion) {
 	case 1:
@@ -108,6 +109,7 @@ float SessionConfig::getTrialsPerBlock(void) const {
 
 Session::Session(FPSciApp* app, shared_ptr<SessionConfig> config) : m_app(app), m_config(config), m_weapon(app->weapon) {
 	m_hasSession = notNull(m_config);
+	if (m_hasSession) compileTemplates();
 }
 
 Session::Session(FPSciApp* app) : m_app(app), m_weapon(app->weapon) {
@@ -122,15 +124,11 @@ bool Session::hasNextCondition() const{
 }
 
 bool Session::nextCondition() {
-	Array<int> unrunTrialIdxs;
-	for (int i = 0; i < m_remainingTrials.size(); i++) {
-		if (m_remainingTrials[i] > 0 || m_remainingTrials[i] == -1) {
-			unrunTrialIdxs.append(i);
-		}
-	}
-	if (unrunTrialIdxs.size() == 0) return false;
-	int idx = Random::common().integer(0, unrunTrialIdxs.size()-1);
-	m_currTrialIdx = unrunTrialIdxs[idx];
+	// The trial order is compiled at session start, just move to the next scheduled trial
+	const ScheduledTrial* trial = m_schedule.trial(m_scheduleIdx);
+	if (isNull(trial)) return false;
+	m_currTrialIdx = trial->trialIdx;
+	m_scheduleIdx++;
 	return true;
 }
 
@@ -144,7 +142,7 @@ bool Session::blockComplete() const{
 
 bool Session::updateBlock(bool init) {
 	for (int i = 0; i < m_trials.size(); i++) {
-		const Array<shared_ptr<TargetConfig>>& targets = m_trials[i];
+		const Array<shared_ptr<const TargetConfig>>& targets = m_trials[i];
 		if (init) { // If this is the first block in the session
 			m_completedTrials.append(0);							// This increments across blocks (unique trial index)
 			m_remainingTrials.append(m_config->trials[i].count);	// This is reset across blocks (tracks progress)
@@ -161,7 +159,7 @@ void Session::onInit(String filename, String description) {
 	// Initialize presentation states
 	currentState = PresentationState::initial;
 	if (m_config) {
-		m_feedbackMessage = formatFeedback(m_config->targetView.showRefTarget ? m_config->feedback.initialWithRef: m_config->feedback.initialNoRef);
+		setFeedback(m_config->targetView->showRefTarget ? m_feedbackTemplates.initialWithRef : m_feedbackTemplates.initialNoRef);
 	}
 
 	// Get the player from the app
@@ -173,20 +171,71 @@ void Session::onInit(String filename, String description) {
 
 	// Check for valid session
 	if (m_hasSession) {
-		if (m_config->logger.enable) {
+		// Iterate over the sessions here and add a config for each
+		m_trials = m_app->experimentConfig.getTargetsByTrial(m_config->id);
+		const bool resume = m_resumeState.resumable() && m_resumeState.completedTrials.size() == m_trials.size();
+
+		if (m_config->logger->enable) {
 			UserConfig user = *m_app->currentUser();
-			// Setup the logger and create results file
-			logger = FPSciLogger::create(filename, user.id, m_config, description);
-			logger->logTargetTypes(m_app->experimentConfig.getSessionTargets(m_config->id));			// Log target info at start of session
-			logger->logUserConfig(user, m_config->id, m_config->player.turnScale);						// Log user info at start of session
+			// Setup the logger and create results file (a resumed session continues its existing entries)
+			logger = FPSciLogger::create(filename, user.id, m_config, description, resume ? m_resumeState.startTime : "");
+			if (!resume) {
+				logger->logTargetTypes(m_app->experimentConfig.getSessionTargets(m_config->id));		// Log target info at start of session
+				logger->logUserConfig(user, m_config->id, m_config->player->turnScale);					// Log user info at start of session
+			}
 			m_dbFilename = filename.substr(0, filename.length() - 3);
+			if (m_config->logger->logProfilerTrace) {
+				TraceRecorder::common().clear();
+			}
+			// Hitch snapshots include the most recent profiler zones
+			if (m_config->logger->logProfilerTrace || m_config->logger->logHitches) {
+				TraceRecorder::common().setEnabled(true);
+			}
 		}
 
 		runSessionCommands("start");				// Run start of session commands
 
-		// Iterate over the sessions here and add a config for each
-		m_trials = m_app->experimentConfig.getTargetsByTrial(m_config->id);
+		// Compile the trial schedule (a resumed session recompiles the same schedule from its journaled seed)
+		const uint32 seed = resume ? m_resumeState.seed : Random::common().bits();
+		Array<int> trialCounts;
+		for (const TrialCount& trial : m_config->trials) { trialCounts.append(trial.count); }
+		m_schedule.compile(trialCounts, m_config->blockCount, m_trials, seed);
+		m_weapon->setRandomStream(RandomStream(seed, WeaponStream));		// Fire spread is reproducible from the seed too
+		m_scheduleIdx = 0;
+		logPrintfAsync("Compiled %d%s trials for session %s (seed %u)\n", m_schedule.size(), m_schedule.complete() ? "" : "+", m_config->id.c_str(), seed);
+		if (m_config->logger->exportTrialSchedule) {
+			const String scheduleFilename = format("%s_%s_schedule.csv", filename.substr(0, filename.length() - 3).c_str(), m_config->id.c_str());
+			if (!m_schedule.exportCsv(scheduleFilename)) {
+				logPrintfAsync("Could not export trial schedule to %s\n", scheduleFilename.c_str());
+			}
+		}
 		updateBlock(true);
+
+		// Create the session's targets up front (spawning a trial's targets then only reuses them)
+		m_targetPool.setScene(m_scene);
+		prewarmTargetPool();
+		logPrintfAsync("Pooled %d targets for session %s\n", m_targetPool.size(), m_config->id.c_str());
+
+		// Start (or continue) the session journal
+		const String journalFilename = m_app->sessionJournalFilename();
+		if (resume) {
+			m_completedTrials = m_resumeState.completedTrials;
+			m_remainingTrials = m_resumeState.remainingTrials;
+			m_currBlock = m_resumeState.block;
+			m_scheduleIdx = m_resumeState.trialOrder.size();		// Skip the trials that were already run
+			nextCondition();
+			m_journal.resume(journalFilename);
+			logPrintfAsync("Resumed session %s at block %d after %d completed trials.\n", m_config->id.c_str(), m_currBlock, m_resumeState.trialOrder.size());
+		}
+		else {
+			SessionJournal::State header;
+			header.sessionId = m_config->id;
+			header.userId = m_app->currentUser()->id;
+			header.seed = seed;
+			header.dbFilename = filename.substr(0, filename.length() - 3);
+			if (notNull(logger)) header.startTime = logger->openTime();
+			m_journal.begin(journalFilename, header);
+		}
 	}
 	else {	// Invalid session, move to displaying message
 		currentState = PresentationState::sessionFeedback;
@@ -195,17 +244,20 @@ void Session::onInit(String filename, String description) {
 
 void Session::randomizePosition(const shared_ptr<TargetEntity>& target) const {
 	static const Point3 initialSpawnPos = m_camera->frame().translation;
-	shared_ptr<TargetConfig> config = m_targetConfigs[m_currTrialIdx][target->paramIdx()];
+	shared_ptr<const TargetConfig> config = m_targetConfigs[m_currTrialIdx][target->paramIdx()];
 	const bool isWorldSpace = config->destSpace == "world";
 	Point3 loc;
 
 	if (isWorldSpace) {
-		loc = config->spawnBounds.randomInteriorPoint();		// Set a random position in the bounds
+		loc = target->rng().interiorPoint(config->spawnBounds);		// Set a random position in the bounds
 		target->resetMotionParams();							// Reset the target motion behavior
 	}
 	else {
-		const float rot_pitch = (config->symmetricEccV ? randSign() : 1) * Random::common().uniform(config->eccV[0], config->eccV[1]);
-		const float rot_yaw = (config->symmetricEccH ? randSign() : 1) * Random::common().uniform(config->eccH[0], config->eccH[1]);
+		RandomStream& rng = target->rng();
+		const float signPitch = config->symmetricEccV ? rng.sign() : 1.0f;
+		const float rot_pitch = signPitch * rng.uniform(config->eccV[0], config->eccV[1]);
+		const float signYaw = config->symmetricEccH ? rng.sign() : 1.0f;
+		const float rot_yaw = signYaw * rng.uniform(config->eccH[0], config->eccH[1]);
 		const CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, rot_yaw - 180.0f/(float)pi()*initialHeadingRadians, rot_pitch, 0.0f);
 		loc = f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
 	}
@@ -219,12 +271,11 @@ void Session::initTargetAnimation() {
 
 	// In task state, spawn a test target. Otherwise spawn a target at straight ahead.
 	if (currentState == PresentationState::trialTask) {
-		if (m_config->targetView.previewWithRef && m_config->targetView.showRefTarget) {
+		if (m_config->targetView->previewWithRef && m_config->targetView->showRefTarget) {
 			// Activate the preview targets
-			for (shared_ptr<TargetEntity> target : m_targetArray) {
-				target->setCanHit(true);
+			for (const shared_ptr<TargetEntity>& target : m_targets.all()) {
+				m_targets.setHittable(target->handle(), true);
 				m_app->updateTargetColor(target);
-				m_hittableTargets.append(target);
 			}
 		}
 		else {
@@ -237,12 +288,12 @@ void Session::initTargetAnimation() {
 		auto t = spawnReferenceTarget(
 			f.pointToWorldSpace(Point3(0, 0, -m_targetDistance)),
 			initialSpawnPos,
-			m_config->targetView.refTargetSize,
-			m_config->targetView.refTargetColor
+			m_config->targetView->refTargetSize,
+			m_config->targetView->refTargetColor
 		);
-		m_hittableTargets.append(t);
+		m_targets.setHittable(t->handle(), true);
 
-		if (m_config->targetView.previewWithRef) {
+		if (m_config->targetView->previewWithRef) {
 			spawnTrialTargets(initialSpawnPos, true);		// Spawn all the targets in preview mode
 		}
 	}
@@ -255,45 +306,93 @@ void Session::initTargetAnimation() {
 }
 
 void Session::spawnTrialTargets(Point3 initialSpawnPos, bool previewMode) {
+	BEGIN_TRACE_EVENT("Session::spawnTrialTargets");
+	// Spawn parameters were drawn when the schedule was compiled
+	const ScheduledTrial* scheduled = m_schedule.trial(m_scheduleIdx - 1);
+	const Color3 spawnColor = previewMode ? m_config->targetView->previewColor : m_config->targetView->healthColors[0];
+	// Pre-spawned targets are placed relative to the player, discard them if the player moved since they were spawned
+	if (previewMode || m_preSpawnPos != initialSpawnPos) clearPreSpawnedTargets();
 	// Iterate through the targets
 	for (int i = 0; i < m_targetConfigs[m_currTrialIdx].size(); i++) {
-		const Color3 spawnColor = previewMode ? m_config->targetView.previewColor : m_config->targetView.healthColors[0];
-		shared_ptr<TargetConfig> target = m_targetConfigs[m_currTrialIdx][i];
-		const String name = format("%s_%d_%d_%s_%d", m_config->id, m_currTrialIdx, m_completedTrials[m_currTrialIdx], target->id, i);
-
-		const float spawn_eccV = (target->symmetricEccV ? randSign() : 1) * Random::common().uniform(target->eccV[0], target->eccV[1]);
-		const float spawn_eccH = (target->symmetricEccH ? randSign() : 1) * Random::common().uniform(target->eccH[0], target->eccH[1]);
-		const float targetSize = G3D::Random().common().uniform(target->size[0], target->size[1]);
-		bool isWorldSpace = target->destSpace == "world";
+		const bool preSpawned = i < m_preSpawnedTargets.size();
+		const shared_ptr<TargetEntity> t = preSpawned ? m_preSpawnedTargets[i] : spawnTrialTarget(i, initialSpawnPos, spawnColor);
 
 		// Log the target if desired
-		if (m_config->logger.enable) {
-			const String spawnTime = FPSciLogger::genUniqueTimestamp();
-			logger->addTarget(name, target, spawnTime, targetSize, Point2(spawn_eccH, spawn_eccV));
+		if (m_config->logger->enable) {
+			const ScheduledTarget& spawn = scheduled->targets[i];
+			const String spawnTime = preSpawned ? m_taskStartTime : FPSciLogger::genUniqueTimestamp();		// Pre-spawned targets appear at the start of the task
+			logger->addTarget(t->logName(), m_targetConfigs[m_currTrialIdx][i], spawnTime, spawn.size, Point2(spawn.eccH, spawn.eccV));
 		}
 
-		CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, spawn_eccH - (initialHeadingRadians * 180.0f / (float)pi()), spawn_eccV, 0.0f);
+		// Show (pre-spawned) targets and set whether they can be hit based on whether we are in preview mode
+		t->setFrozen(false);
+		m_targets.setVisible(t->handle(), true);
+		m_targets.setHittable(t->handle(), !previewMode);
+	}
+	m_preSpawnedTargets.fastClear();
+	END_TRACE_EVENT();
+}
 
-		// Check for case w/ destination array
-		shared_ptr<TargetEntity> t;
-		if (target->destinations.size() > 0) {
-			Point3 offset = isWorldSpace ? target->destinations[0].position : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-			t = spawnDestTarget(target, offset, spawnColor, i, name);
-		}
-		// Otherwise check if this is a jumping target
-		else if (target->jumpEnabled) {
-			Point3 offset = isWorldSpace ? target->spawnBounds.randomInteriorPoint() : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-			t = spawnJumpingTarget(target, offset, initialSpawnPos, spawnColor, m_targetDistance, i, name);
-		}
-		else {
-			Point3 offset = isWorldSpace ? target->spawnBounds.randomInteriorPoint() : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-			t = spawnFlyingTarget(target, offset, initialSpawnPos, spawnColor, i, name);
-		}
+shared_ptr<TargetEntity> Session::spawnTrialTarget(int i, const Point3& initialSpawnPos, const Color3& spawnColor) {
+	shared_ptr<const TargetConfig> target = m_targetConfigs[m_currTrialIdx][i];
+
+	const ScheduledTarget& spawn = m_schedule.trial(m_scheduleIdx - 1)->targets[i];
+	const RandomStream rng(m_schedule.seed(), targetStream(m_scheduleIdx - 1, i));		// Same stream for the trial's preview and task targets
+	const float spawn_eccV = spawn.eccV;
+	const float spawn_eccH = spawn.eccH;
+	const float targetSize = spawn.size;
+	bool isWorldSpace = target->destSpace == "world";
+
+	CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, spawn_eccH - (initialHeadingRadians * 180.0f / (float)pi()), spawn_eccV, 0.0f);
+
+	shared_ptr<TargetEntity> t;
+	// Check for case w/ destination array
+	if (target->destinations.size() > 0) {
+		Point3 offset = isWorldSpace ? target->destinations[0].position : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
+		t = spawnDestTarget(target, offset, targetSize, spawnColor, rng, i);
+	}
+	// Otherwise check if this is a jumping target
+	else if (target->jumpEnabled) {
+		Point3 offset = isWorldSpace ? spawn.position : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
+		t = spawnJumpingTarget(target, offset, initialSpawnPos, targetSize, spawnColor, rng, m_targetDistance, i);
+	}
+	else {
+		Point3 offset = isWorldSpace ? spawn.position : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
+		t = spawnFlyingTarget(target, offset, initialSpawnPos, targetSize, spawnColor, rng, i);
+	}
+
+	// The log name is only needed when logging (otherwise the pooled target's entity name is used)
+	if (notNull(logger)) {
+		t->formatLogName("%s_%d_%d_%s_%d", m_config->id.c_str(), m_currTrialIdx, m_completedTrials[m_currTrialIdx], target->id.c_str(), i);
+	}
+	return t;
+}
+
+bool Session::preSpawnEnabled() const {
+	// Preview targets (shown w/ the reference) are spawned during feedback and activated at the start of the task instead
+	return m_config->targetView->preSpawnTargets && !(m_config->targetView->previewWithRef && m_config->targetView->showRefTarget);
+}
 
-		// Set whether the target can be hit based on whether we are in preview mode
-		t->setCanHit(!previewMode);
-		previewMode ? m_unhittableTargets.append(t) : m_hittableTargets.append(t);
+void Session::preSpawnNextTarget() {
+	if (m_preSpawnedTargets.size() >= m_targetConfigs[m_currTrialIdx].size()) return;
+	const Point3 initialSpawnPos = m_player->getCameraFrame().translation;
+	if (initialSpawnPos != m_preSpawnPos) {
+		clearPreSpawnedTargets();					// The player moved, start over from their new position
+		m_preSpawnPos = initialSpawnPos;
 	}
+	BEGIN_TRACE_EVENT("Session::preSpawnNextTarget");
+	const shared_ptr<TargetEntity> t = spawnTrialTarget(m_preSpawnedTargets.size(), initialSpawnPos, m_config->targetView->healthColors[0]);
+	m_targets.setVisible(t->handle(), false);		// Hidden (and unhittable) until the task starts
+	t->setFrozen(true);								// Don't start moving until then either
+	m_preSpawnedTargets.append(t);
+	END_TRACE_EVENT();
+}
+
+void Session::clearPreSpawnedTargets() {
+	for (const shared_ptr<TargetEntity>& target : m_preSpawnedTargets) {
+		destroyTarget(target);
+	}
+	m_preSpawnedTargets.fastClear();
 }
 
 void Session::processResponse()
@@ -313,14 +412,15 @@ void Session::processResponse()
 	if (notNull(logger)) {
 		logger->updateSessionEntry((m_remainingTrials[m_currTrialIdx] == 0), m_completedTrials[m_currTrialIdx]);			// Update session entry in database
 	}
+	m_journal.recordTrial(m_currTrialIdx, m_currBlock, m_completedTrials, m_remainingTrials);		// Record progress (for resume)
 
 	// Check for whether all targets have been destroyed
 	if (m_destroyedTargets == totalTargets) {
-		m_totalRemainingTime += (double(m_config->timing.maxTrialDuration) - m_taskExecutionTime);
-		m_feedbackMessage = formatFeedback(m_config->feedback.trialSuccess);
+		m_totalRemainingTime += (double(m_config->timing->maxTrialDuration) - m_taskExecutionTime);
+		setFeedback(m_feedbackTemplates.trialSuccess);
 	}
 	else {
-		m_feedbackMessage = formatFeedback(m_config->feedback.trialFailure);
+		setFeedback(m_feedbackTemplates.trialFailure);
 	}
 }
 
@@ -328,25 +428,39 @@ void Session::updatePresentationState()
 {
 	// This updates presentation state and also deals with data collection when each trial ends.
 	PresentationState newState;
-	int remainingTargets = m_hittableTargets.size();
+	int remainingTargets = m_targets.hittable().size();
 	float stateElapsedTime = m_timer.getTime();
 	newState = currentState;
 
+	// The next state waits for blocking commands (the frame loop keeps running)
+	if (m_blockingProcesses.size() > 0) {
+		if (m_app->processRunner().anyRunning(m_blockingProcesses)) return;
+		m_blockingProcesses.fastClear();
+		if (m_statePending) {
+			m_statePending = false;
+			enterState(m_pendingState);
+			return;
+		}
+	}
+
 	if (currentState == PresentationState::initial)
 	{
-		if (m_config->player.stillBetweenTrials) {
+		if (m_config->player->stillBetweenTrials) {
 			m_player->setMoveEnable(false);
 		}
-		if (!(m_app->shootButtonUp && m_config->timing.clickToStart)) {
+		if (!(m_app->shootButtonUp && m_config->timing->clickToStart)) {
 			newState = PresentationState::trialFeedback;
 		}
 	}
 	else if (currentState == PresentationState::pretrial)
 	{
-		if (stateElapsedTime > m_config->timing.pretrialDuration)
+		if (stateElapsedTime <= m_config->timing->pretrialDuration && preSpawnEnabled()) {
+			preSpawnNextTarget();						// Spawn the trial's targets (hidden) one per frame while waiting
+		}
+		else if (stateElapsedTime > m_config->timing->pretrialDuration)
 		{
 			newState = PresentationState::trialTask;
-			if (m_config->player.stillBetweenTrials) {
+			if (m_config->player->stillBetweenTrials) {
 				m_player->setMoveEnable(true);
 			}
 
@@ -357,16 +471,17 @@ void Session::updatePresentationState()
 	}
 	else if (currentState == PresentationState::trialTask)
 	{
-		if ((stateElapsedTime > m_config->timing.maxTrialDuration) || (remainingTargets <= 0) || (m_weapon->remainingAmmo() == 0))
+		if ((stateElapsedTime > m_config->timing->maxTrialDuration) || (remainingTargets <= 0) || (m_weapon->remainingAmmo() == 0))
 		{
 			m_taskEndTime = FPSciLogger::genUniqueTimestamp();
+			sendEvent("trial_end", m_taskEndTime);
 			processResponse();
 			clearTargets(); // clear all remaining targets
 			newState = PresentationState::trialFeedback;
-			if (m_config->player.stillBetweenTrials) {
+			if (m_config->player->stillBetweenTrials) {
 				m_player->setMoveEnable(false);
 			}
-			if (m_config->player.resetPositionPerTrial) {
+			if (m_config->player->resetPositionPerTrial) {
 				m_player->respawn();
 			}
 
@@ -382,7 +497,7 @@ void Session::updatePresentationState()
 	}
 	else if (currentState == PresentationState::trialFeedback)
 	{
-		if ((stateElapsedTime > m_config->timing.trialFeedbackDuration) && (remainingTargets <= 0))
+		if ((stateElapsedTime > m_config->timing->trialFeedbackDuration) && (remainingTargets <= 0))
 		{
 			if (blockComplete()) {
 				m_currBlock++;		// Increment the block index
@@ -397,7 +512,7 @@ void Session::updatePresentationState()
 						else if (!m_app->dialog->visible()) {														// Check for whether dialog is closed (otherwise we are waiting for input)
 							if (m_app->dialog->complete) {															// Has this dialog box been completed? (or was it closed without an answer?)
 								m_config->questionArray[m_currQuestionIdx].result = m_app->dialog->result;			// Store response w/ quesiton
-								if (m_config->logger.enable) {
+								if (m_config->logger->enable) {
 									logger->addQuestion(m_config->questionArray[m_currQuestionIdx], m_config->id);	// Log the question and its answer
 								}
 								m_currQuestionIdx++;																
@@ -414,18 +529,22 @@ void Session::updatePresentationState()
 						}
 					}
 					else {
-						if (m_config->logger.enable) {
+						if (m_config->logger->enable) {
 							endLogging();
 						}
 						m_app->markSessComplete(m_config->id);														// Add this session to user's completed sessions
+						m_journal.markComplete();																	// Nothing left to resume
 
-						m_feedbackMessage = formatFeedback(m_config->feedback.sessComplete);						// Update the feedback message
+						setFeedback(m_feedbackTemplates.sessComplete);						// Update the feedback message
+						if (m_app->startupConfig.developerMode) {
+							m_feedbackMessage += format("\n(%d frame hitches this session)", m_hitchCount);		// Hitch summary for developers
+						}
 						m_currQuestionIdx = -1;
 						newState = PresentationState::sessionFeedback;
 					}
 				}
 				else {					// Block is complete but session isn't
-					m_feedbackMessage = formatFeedback(m_config->feedback.blockComplete);
+					setFeedback(m_feedbackTemplates.blockComplete);
 					updateBlock();
 					newState = PresentationState::initial;
 				}
@@ -439,7 +558,7 @@ void Session::updatePresentationState()
 	}
 	else if (currentState == PresentationState::sessionFeedback) {
 		if (m_hasSession) {
-			if (stateElapsedTime > m_config->timing.sessionFeedbackDuration && (!m_config->timing.sessionFeedbackRequireClick || !m_app->shootButtonUp)) {
+			if (stateElapsedTime > m_config->timing->sessionFeedbackDuration && (!m_config->timing->sessionFeedbackRequireClick || !m_app->shootButtonUp)) {
 				newState = PresentationState::complete;
         
 				// Save current user config and status
@@ -451,14 +570,14 @@ void Session::updatePresentationState()
 
 				Array<String> remaining = m_app->updateSessionDropDown();
 				if (remaining.size() == 0) {
-					m_feedbackMessage = formatFeedback(m_config->feedback.allSessComplete); // Update the feedback message
+					setFeedback(m_feedbackTemplates.allSessComplete); // Update the feedback message
 					moveOn = false;
 					if (m_app->experimentConfig.closeOnComplete || m_config->closeOnComplete) {
 						m_app->quitRequest();
 					}
 				}
 				else {
-					m_feedbackMessage = formatFeedback(m_config->feedback.sessComplete);	// Update the feedback message
+					setFeedback(m_feedbackTemplates.sessComplete);	// Update the feedback message
 					if (m_config->closeOnComplete) {
 						m_app->quitRequest();
 					}
@@ -473,7 +592,7 @@ void Session::updatePresentationState()
 		else {
 			// Go ahead and move to the complete state since there aren't any valid sessions
 			newState = PresentationState::complete;
-			m_feedbackMessage = formatFeedback("All sessions complete!");
+			m_feedbackMessage = "All sessions complete!";
 			moveOn = false;
 		}
 	}
@@ -484,20 +603,35 @@ void Session::updatePresentationState()
 
 	if (currentState != newState)
 	{ // handle state transition.
-		m_timer.startTimer();
-		if (newState == PresentationState::trialTask) {
-			m_taskStartTime = FPSciLogger::genUniqueTimestamp();
+		if (m_blockingProcesses.size() > 0) {
+			// Enter the new state once the blocking commands (run for this transition) complete
+			m_pendingState = newState;
+			m_statePending = true;
 		}
-		currentState = newState;
-		//If we switched to task, call initTargetAnimation to handle new trial
-		if ((newState == PresentationState::trialTask) || (newState == PresentationState::trialFeedback && hasNextCondition() && m_config->targetView.showRefTarget)) {
-			initTargetAnimation();
+		else {
+			enterState(newState);
 		}
 	}
 }
 
+void Session::enterState(PresentationState newState) {
+	m_timer.startTimer();
+	if (newState == PresentationState::trialTask) {
+		m_taskStartTime = FPSciLogger::genUniqueTimestamp();
+		m_trialCounters = StageCounters::Totals();
+		if (notNull(logger) && m_config->logger->logPerfCounters) logger->beginTrialContextSwitches();
+		sendEvent("trial_start", m_taskStartTime);
+	}
+	currentState = newState;
+	//If we switched to task, call initTargetAnimation to handle new trial
+	if ((newState == PresentationState::trialTask) || (newState == PresentationState::trialFeedback && hasNextCondition() && m_config->targetView->showRefTarget)) {
+		initTargetAnimation();
+	}
+}
+
 void Session::onSimulation(RealTime rdt, SimTime sdt, SimTime idt)
 {
+	BEGIN_TRACE_EVENT("Session::onSimulation");
 	// 1. Update presentation state and send task performance to psychophysics library.
 	updatePresentationState();
 
@@ -505,14 +639,14 @@ void Session::onSimulation(RealTime rdt, SimTime sdt, SimTime idt)
 	if (currentState == PresentationState::trialTask)
 	{
 		accumulateTrajectories();
-		accumulateFrameInfo(rdt, sdt, idt);
 	}
+	END_TRACE_EVENT();
 }
 
 void Session::recordTrialResponse(int destroyedTargets, int totalTargets)
 {
-	if (!m_config->logger.enable) return;		// Skip this if the logger is disabled
-	if (m_config->logger.logTrialResponse) {
+	if (!m_config->logger->enable) return;		// Skip this if the logger is disabled
+	if (m_config->logger->logTrialResponse) {
 		// Trials table. Record trial start time, end time, and task completion time.
 		FPSciLogger::TrialValues trialValues = {
 			"'" + m_config->id + "'",
@@ -527,18 +661,33 @@ void Session::recordTrialResponse(int destroyedTargets, int totalTargets)
 		};
 		logger->logTrial(trialValues);
 	}
+	if (m_config->logger->logPerfCounters) {
+		// Trial counters table (the logger thread adds the context switches and its writes since the last trial)
+		FPSciLogger::TrialCounters counterValues = {
+			"'" + m_config->id + "'",
+			String(std::to_string(m_currTrialIdx)),
+			String(std::to_string(m_completedTrials[m_currTrialIdx])),
+			format("'Block %d'", m_currBlock),
+			String(std::to_string(m_trialCounters.frames)),
+		};
+		for (int i = 0; i < StageCounters::StageCount; i++) {
+			counterValues.append(String(std::to_string(m_trialCounters.cycles[i])));
+		}
+		counterValues.append(String(std::to_string(m_trialCounters.pageFaults)));
+		logger->logTrialCounters(counterValues);
+	}
 }
 
 void Session::accumulateTrajectories()
 {
-	if (notNull(logger) && m_config->logger.logTargetTrajectories) {
-		for (shared_ptr<TargetEntity> target : m_targetArray) {
-			if (!target->isLogged()) continue;					   
+	if (notNull(logger) && m_config->logger->logTargetTrajectories) {
+		for (const shared_ptr<TargetEntity>& target : m_targets.all()) {
+			if (!m_targets.hasFlags(target->handle(), TargetRegistry::Logged)) continue;					   
 			//// below for 2D direction calculation (azimuth and elevation)
 			//Point3 t = targetPosition.direction();
 			//float az = atan2(-t.z, -t.x) * 180 / pif();
 			//float el = atan2(t.y, sqrtf(t.x * t.x + t.z * t.z)) * 180 / pif();
-			TargetLocation location = TargetLocation(FPSciLogger::getFileTime(), target->name(), target->frame().translation);
+			TargetLocation location = TargetLocation(FPSciLogger::getFileTime(), target->logName(), target->frame().translation);
 			logger->logTargetLocation(location);
 		}
 	}
@@ -548,29 +697,209 @@ void Session::accumulateTrajectories()
 
 void Session::accumulatePlayerAction(PlayerActionType action, String targetName)
 {
-	if (notNull(logger) && m_config->logger.logPlayerActions) {
-		BEGIN_PROFILER_EVENT("accumulatePlayerAction");
+	if (notNull(logger) && m_config->logger->logPlayerActions) {
+		BEGIN_TRACE_EVENT("accumulatePlayerAction");
 		// recording target trajectories
 		Point2 dir = getViewDirection();
 		Point3 loc = getPlayerLocation();
 		PlayerAction pa = PlayerAction(FPSciLogger::getFileTime(), dir, loc, action, targetName);
 		logger->logPlayerAction(pa);
-		END_PROFILER_EVENT();
+		END_TRACE_EVENT();
 	}
 	
 	// Count hits here
 	if (action == PlayerActionType::Hit || action == PlayerActionType::Destroy) { m_hitCount++; }
 }
 
-void Session::accumulateFrameInfo(RealTime t, float sdt, float idt) {
-	if (notNull(logger) && m_config->logger.logFrameInfo) {
-		logger->logFrameInfo(FrameInfo(FPSciLogger::getFileTime(), sdt));
+void Session::accumulateFrameInfo(const FrameInfo& info) {
+	if (currentState == PresentationState::trialTask && notNull(logger) && m_config->logger->logFrameInfo) {
+		logger->logFrameInfo(info);
+	}
+}
+
+void Session::accumulateStageCounters(const StageCounters::Totals& counters) {
+	if (currentState == PresentationState::trialTask) {
+		m_trialCounters.add(counters);
+	}
+}
+
+void Session::logShotLatency(const ShotLatency& shot) {
+	if (isNull(logger)) return;
+	FPSciLogger::ShotLatencyValues values = {
+		"'" + FPSciLogger::formatFileTime(FPSciLogger::getFileTime()) + "'",
+		"'" + m_config->id + "'",
+		String(std::to_string(m_currTrialIdx)),
+		String(std::to_string((m_currTrialIdx >= 0 && m_currTrialIdx < m_completedTrials.size()) ? m_completedTrials[m_currTrialIdx] : -1)),
+		format("'Block %d'", m_currBlock),
+		String(std::to_string(shot.inputToFire())),
+		String(std::to_string(shot.fireToRender())),
+		String(std::to_string(shot.renderToPresent())),
+		String(std::to_string(shot.total())),
+		String(std::to_string(shot.frameDelay)),
+	};
+	logger->logShotLatency(values);
+}
+
+static String presentationStateToString(PresentationState state) {
+	switch (state) {
+	case PresentationState::initial: return "initial";
+	case PresentationState::pretrial: return "pretrial";
+	case PresentationState::trialTask: return "trialTask";
+	case PresentationState::trialFeedback: return "trialFeedback";
+	case PresentationState::sessionFeedback: return "sessionFeedback";
+	case PresentationState::complete: return "complete";
+	}
+	return "unknown";
+}
+
+void Session::logHitch(HitchInfo& hitch) {
+	m_hitchCount++;
+	if (isNull(logger) || !m_config->logger->logHitches) return;
+
+	// Fill in the session state for this hitch
+	hitch.sessionId = m_config->id;
+	hitch.state = presentationStateToString(currentState);
+	hitch.block = m_currBlock;
+	if (m_currTrialIdx >= 0 && m_currTrialIdx < m_completedTrials.size()) {
+		hitch.trialIdx = m_currTrialIdx;
+		hitch.trialCount = m_completedTrials[m_currTrialIdx];
+	}
+	hitch.targetCount = m_targets.size();
+	if (notNull(m_weapon)) {
+		hitch.projectileCount = m_weapon->projectileCount();
+		hitch.decalCount = m_weapon->decalCount();
+	}
+
+	hitch.loggerQueueBytes = logger->pendingBytes();
+	logger->logHitch(hitch);
+}
+
+void Session::logQualityChange(int frameNumber, int fromLevel, int toLevel, const String& levelName, float meanFrameTime, float budget) {
+	logPrintfAsync("Adaptive quality: level %d -> %d (%s), mean frame time = %.2fms (budget %.2fms)\n",
+		fromLevel, toLevel, levelName.c_str(), meanFrameTime * 1000.f, budget * 1000.f);
+	if (notNull(logger)) {
+		FPSciLogger::QualityChange change = {
+			"'" + FPSciLogger::formatFileTime(FPSciLogger::getFileTime()) + "'",
+			"'" + m_config->id + "'",
+			String(std::to_string(frameNumber)),
+			String(std::to_string(fromLevel)),
+			String(std::to_string(toLevel)),
+			"'" + levelName + "'",
+			String(std::to_string(meanFrameTime)),
+			String(std::to_string(budget)),
+		};
+		logger->logQualityChange(change);
+	}
+}
+
+void Session::runTrialCommands(String evt) {
+	evt = toLower(evt);
+	const bool start = (evt == "start");
+	const Array<CommandSpec>& cmds = start ? m_config->commands->trialStartCmds : m_config->commands->trialEndCmds;
+	const Array<TextTemplate>& templates = start ? m_commandTemplates.trialStart : m_commandTemplates.trialEnd;
+	int after = -1;
+	for (int i = 0; i < cmds.size(); i++) {
+		const int id = runCommand(cmds[i], templates[i], evt + " of trial", after);
+		if (cmds[i].blocking) after = id;		// Later commands are launched once blocking ones complete
+		m_trialProcesses.append(id);
+	}
+}
+
+void Session::closeTrialProcesses() {
+	for (int id : m_trialProcesses) {
+		m_app->processRunner().terminate(id);
+	}
+	m_trialProcesses.fastClear();
+}
+
+void Session::runSessionCommands(String evt) {
+	evt = toLower(evt);
+	const bool start = (evt == "start");
+	const Array<CommandSpec>& cmds = start ? m_config->commands->sessionStartCmds : m_config->commands->sessionEndCmds;
+	const Array<TextTemplate>& templates = start ? m_commandTemplates.sessionStart : m_commandTemplates.sessionEnd;
+	int after = -1;
+	for (int i = 0; i < cmds.size(); i++) {
+		const int id = runCommand(cmds[i], templates[i], evt + " of session", after);
+		if (cmds[i].blocking) after = id;		// Later commands are launched once blocking ones complete
+		m_sessProcesses.append(id);
+	}
+
+	if (start) {
+		// Trial event processes run for the whole session (once any blocking start commands complete)
+		for (int i = 0; i < m_config->commands->trialEventCmds.size(); i++) {
+			const CommandSpec& cmd = m_config->commands->trialEventCmds[i];
+			m_commandTemplates.trialEvents[i].render(m_commandVariables, m_commandBuffer);
+			m_eventProcesses.append(m_app->processRunner().launch(m_commandBuffer, cmd.foreground, false, m_config->id, "trial events", after, true));
+		}
+		sendEvent("session_start", FPSciLogger::genUniqueTimestamp());
+	}
+	else {
+		sendEvent("session_end", FPSciLogger::genUniqueTimestamp());
+		closeEventProcesses();
+	}
+}
+
+void Session::closeSessionProcesses() {
+	for (int id : m_sessProcesses) {
+		m_app->processRunner().terminate(id);
+	}
+	m_sessProcesses.fastClear();
+}
+
+void Session::sendEvent(const char* evt, const String& timestamp) {
+	if (m_eventProcesses.size() == 0) return;
+	const String line = format("%s\t%s\t%s\t%d\t%d\n", timestamp.c_str(), evt, m_config->id.c_str(), m_currBlock, m_currTrialIdx);
+	for (int id : m_eventProcesses) {
+		m_app->processRunner().send(id, line);
+	}
+}
+
+void Session::closeEventProcesses() {
+	for (int id : m_eventProcesses) {
+		m_app->processRunner().closeInput(id);
+	}
+	m_eventProcesses.fastClear();
+}
+
+int Session::runCommand(const CommandSpec& cmd, const TextTemplate& cmdTemplate, const String& evt, int after) {
+	cmdTemplate.render(m_commandVariables, m_commandBuffer);
+	const int id = m_app->processRunner().launch(m_commandBuffer, cmd.foreground, cmd.blocking, m_config->id, evt, after);
+	if (cmd.blocking) {		// The next state waits for this command to complete
+		m_blockingProcesses.append(id);
+	}
+	return id;
+}
+
+void Session::logCommand(const CommandProcess& process) {
+	if (process.status == CommandProcess::Status::Failed) {
+		logPrintfAsync("Failed to run %s command: \"%s\". %s\n", process.event.c_str(), process.command.c_str(), process.error.c_str());
+	}
+	else {
+		logPrintfAsync("Command \"%s\" (%s) %s w/ code %d after %.3fs\n", process.command.c_str(), process.event.c_str(),
+			CommandProcess::statusName(process.status), process.exitCode, process.duration());
+	}
+	if (notNull(logger) && notNull(m_config) && process.owner == m_config->id) {
+		String command;
+		for (char c : process.command) {
+			command += c;
+			if (c == '\'') command += c;		// Escape quotes (commands are user provided)
+		}
+		FPSciLogger::CommandResult result = {
+			"'" + m_config->id + "'",
+			"'" + process.event + "'",
+			"'" + command + "'",
+			process.blocking ? "1" : "0",
+			"'" + String(CommandProcess::statusName(process.status)) + "'",
+			String(std::to_string(process.exitCode)),
+			String(std::to_string(process.duration())),
+		};
+		logger->logCommand(result);
 	}
 }
 
 float Session::getRemainingTrialTime() {
 	if (isNull(m_config)) return 10.0;
-	return m_config->timing.maxTrialDuration - m_timer.getTime();
+	return m_config->timing->maxTrialDuration - m_timer.getTime();
 }
 
 float Session::getProgress() {
@@ -589,136 +918,144 @@ int Session::getScore() {
 	return (int)(10.0 * m_totalRemainingTime);
 }
 
-String Session::formatCommand(const String& input) {
-	const char delimiter = '%';			///< Start of all valid substrings
-	String formatted = input;			///< Output string
-	int foundIdx = 0;					///< Index for searching for substrings
+void Session::addFeedbackVariables(TemplateVariables& variables, Session* s) {
+	variables.addFloat("totalTimeLeftS", [s]() { return (float)s->m_totalRemainingTime; });			// Sum of time remaining over all completed trials
+	variables.addInt("lastBlock", [s]() { return s->m_currBlock - 1; });								// The last (completed) block in this session
+	variables.addInt("currBlock", [s]() { return s->m_currBlock; });									// The current block of the session (next block at end of session)
+	variables.addInt("totalBlocks", [s]() { return s->m_config->blockCount; });						// The total blocks specified in the session
+	variables.addInt("trialTaskTimeMs", [s]() { return (int)(s->m_taskExecutionTime * 1000); });		// The time spent in the task state of this trial (in ms)
+	variables.addInt("trialTargetsDestroyed", [s]() { return s->m_destroyedTargets; });				// The number of targets destroyed in this trial
+	variables.addString("trialTotalTargets", [s]() {													// The number of targets in this trial ("infinite" if any target respawns infinitely)
+		const int totalTargets = s->totalTrialTargets();
+		return (totalTargets > 0) ? format("%d", totalTargets) : String("infinite");
+	});
+	variables.addInt("trialShotsHit", [s]() { return s->m_hitCount; });								// The number of shots hit in this trial
+	variables.addInt("trialTotalShots", [s]() { return s->m_weapon->shotsTaken(); });					// The number of shots taken in this trial
+	variables.addInt("sessHitches", [s]() { return s->m_hitchCount; });								// The number of frame hitches detected in this session
+}
 
-	const String loggerComPort = "%loggerComPort";
-	const String syncComPort = "%loggerSyncComPort";
-	const String dbFilename = "%dbFilename";
+void Session::addCommandVariables(TemplateVariables& variables, Session* s) {
+	variables.addString("loggerComPort", [s]() { return s->m_app->systemConfig.loggerComPort; });
+	variables.addString("loggerSyncComPort", [s]() { return s->m_app->systemConfig.syncComPort; });
+	variables.addString("dbFilename", [s]() {
+		if (s->m_dbFilename.empty()) throw "No database filename found to support the %dbFilename substring!";
+		return s->m_dbFilename;
+	});
+}
 
-	while ((foundIdx = (int)formatted.find(delimiter, (size_t)foundIdx)) > -1) {
-		if (!formatted.compare(foundIdx, loggerComPort.length(), loggerComPort)) {
-			if (m_app->systemConfig.loggerComPort.empty()) {
-				throw "Found \"%loggerComPort\" substring in a command, but no \"loggerComPort\" is provided in the config!";
-			}
-			formatted = formatted.substr(0, foundIdx) + m_app->systemConfig.loggerComPort + formatted.substr(foundIdx + loggerComPort.length());
-		}
-		else if (!formatted.compare(foundIdx, syncComPort.length(), syncComPort)) {
-			if (m_app->systemConfig.syncComPort.empty()) {
-				throw "Found \"%loggerSyncComPort\" substring in a command, but no \"loggerSyncComPort\" is provided in the config!";
+void Session::validateTemplates(const SessionConfig& config) {
+	// Only the variable names are needed to compile (these are never rendered)
+	static const TemplateVariables feedbackVariables = []() { TemplateVariables v; addFeedbackVariables(v, nullptr); return v; }();
+	static const TemplateVariables commandVariables = []() { TemplateVariables v; addCommandVariables(v, nullptr); return v; }();
+	FeedbackTemplates feedback;
+	CommandTemplates commands;
+	compileTemplates(config, feedbackVariables, commandVariables, feedback, commands);
+}
+
+void Session::compileTemplates() {
+	m_feedbackVariables = TemplateVariables();
+	addFeedbackVariables(m_feedbackVariables, this);
+	m_commandVariables = TemplateVariables();
+	addCommandVariables(m_commandVariables, this);
+	compileTemplates(*m_config, m_feedbackVariables, m_commandVariables, m_feedbackTemplates, m_commandTemplates);
+
+	// Commands can reference the logger COM ports, check those are configured now (rather than when the command is run)
+	const CommandTemplates& commands = m_commandTemplates;
+	for (const Array<TextTemplate>* templates : { &commands.sessionStart, &commands.sessionEnd, &commands.trialStart, &commands.trialEnd, &commands.trialEvents }) {
+		for (const TextTemplate& command : *templates) {
+			if (command.references("loggerComPort", m_commandVariables) && m_app->systemConfig.loggerComPort.empty()) {
+				throw String("Found \"%loggerComPort\" substring in a command, but no \"loggerComPort\" is provided in the config!");
 			}
-			formatted = formatted.substr(0, foundIdx) + m_app->systemConfig.syncComPort + formatted.substr(foundIdx + syncComPort.length());
-		}
-		else if (!formatted.compare(foundIdx, dbFilename.length(), dbFilename)) {
-			if (m_dbFilename.empty()) {
-				throw "No database filename found to support the %dbFilename substring!";
+			if (command.references("loggerSyncComPort", m_commandVariables) && m_app->systemConfig.syncComPort.empty()) {
+				throw String("Found \"%loggerSyncComPort\" substring in a command, but no \"loggerSyncComPort\" is provided in the config!");
 			}
-			formatted = formatted.substr(0, foundIdx) + m_dbFilename + formatted.substr(foundIdx + dbFilename.length());
-		}
-		else {
-			foundIdx++;
 		}
 	}
-	return formatted;
 }
 
-String Session::formatFeedback(const String& input) {
-	const char delimiter = '%';			///< Start of all valid substrings
-	String formatted = input;			///< Output string
-	int foundIdx = 0;					///< Index for searching for substrings
-
-	// Substrings for replacement
-	const String totalTimeLeftS			= "%totalTimeLeftS";				///< Sum of time remaining over all completed trials
-	const String lastBlock				= "%lastBlock";						///< The last (completed) block in this session
-	const String currBlock				= "%currBlock";						///< The current block of the session (next block at end of session)
-	const String totalBlocks			= "%totalBlocks";					///< The total blocks specified in the session
-	const String trialTaskTimeMs		= "%trialTaskTimeMs";				///< The time spent in the task state of this trial (in ms)
-	const String trialTargetsDestroyed	= "%trialTargetsDestroyed";			///< The number of targets destroyed in this trial
-	const String trialTotalTargets		= "%trialTotalTargets";				///< The number of targets in this trial ("infinite" if any target respawns infinitely)
-	const String trialShotsHit			= "%trialShotsHit";					///< The number of shots hit in this trial
-	const String trialTotalShots		= "%trialTotalShots";				///< The number of shots taken in this trial
+void Session::compileTemplates(const SessionConfig& config, const TemplateVariables& feedbackVariables, const TemplateVariables& commandVariables,
+	FeedbackTemplates& feedbackTemplates, CommandTemplates& commandTemplates) {
+	const FeedbackConfig& feedback = *config.feedback;
+	const String sessionStr = format(" in session \"%s\"", config.id.c_str());
+	try {
+		feedbackTemplates.initialWithRef.compile(feedback.initialWithRef, feedbackVariables);
+		feedbackTemplates.initialNoRef.compile(feedback.initialNoRef, feedbackVariables);
+		feedbackTemplates.trialSuccess.compile(feedback.trialSuccess, feedbackVariables);
+		feedbackTemplates.trialFailure.compile(feedback.trialFailure, feedbackVariables);
+		feedbackTemplates.blockComplete.compile(feedback.blockComplete, feedbackVariables);
+		feedbackTemplates.sessComplete.compile(feedback.sessComplete, feedbackVariables);
+		feedbackTemplates.allSessComplete.compile(feedback.allSessComplete, feedbackVariables);
+	}
+	catch (const String& error) {
+		throw "Feedback message error" + sessionStr + ": " + error;
+	}
 
-	// Walk through the string looking for instances of the delimiter
-	while ((foundIdx = (int)formatted.find(delimiter, (size_t)foundIdx)) > -1) {
-		if(!formatted.compare(foundIdx, totalTimeLeftS.length(), totalTimeLeftS)){
-			formatted = formatted.substr(0, foundIdx) + format("%.2f", m_totalRemainingTime) + formatted.substr(foundIdx + totalTimeLeftS.length());
-		}
-		else if (!formatted.compare(foundIdx, lastBlock.length(), lastBlock)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_currBlock - 1) + formatted.substr(foundIdx + lastBlock.length());
-		}
-		else if (!formatted.compare(foundIdx, currBlock.length(), currBlock)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_currBlock) + formatted.substr(foundIdx + currBlock.length());
-		}
-		else if (!formatted.compare(foundIdx, totalBlocks.length(), totalBlocks)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_config->blockCount) + formatted.substr(foundIdx + totalBlocks.length());
-		}
-		else if (!formatted.compare(foundIdx, trialTaskTimeMs.length(), trialTaskTimeMs)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", (int)(m_taskExecutionTime * 1000)) + formatted.substr(foundIdx + trialTaskTimeMs.length());
-		}
-		else if (!formatted.compare(foundIdx, trialTargetsDestroyed.length(), trialTargetsDestroyed)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_destroyedTargets) + formatted.substr(foundIdx + trialTargetsDestroyed.length());
-		}
-		else if (!formatted.compare(foundIdx, trialTotalTargets.length(), trialTotalTargets)) {
-			String totalTargetsString;
-			int totalTargets = totalTrialTargets();
-			if (totalTargets > 0) {
-				// Finite target count
-				totalTargetsString += format("%d", totalTargets);
+	auto compileCommands = [&](const Array<CommandSpec>& cmds, Array<TextTemplate>& templates) {
+		templates.resize(cmds.size());
+		for (int i = 0; i < cmds.size(); i++) {
+			try {
+				templates[i].compile(cmds[i].cmdStr, commandVariables, false);		// Commands can have their own % references (e.g. %PATH%)
 			}
-			else { 
-				// Inifinite target count case
-				totalTargetsString += "infinite";
+			catch (const String& error) {
+				throw "Command error" + sessionStr + ": " + error;
 			}
-			formatted = formatted.substr(0, foundIdx) + totalTargetsString + formatted.substr(foundIdx + trialTotalTargets.length());
-		}
-		else if (!formatted.compare(foundIdx, trialShotsHit.length(), trialShotsHit)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_hitCount) + formatted.substr(foundIdx + trialShotsHit.length());
-		}
-		else if (!formatted.compare(foundIdx, trialTotalShots.length(), trialTotalShots)) {
-			formatted = formatted.substr(0, foundIdx) + format("%d", m_weapon->shotsTaken()) + formatted.substr(foundIdx + trialTotalShots.length());
 		}
-		else {
-			// Bump the found index past this character (not a valid substring)
-			foundIdx++;
-		}
-	}
-	return formatted;
-}
-
-String Session::getFeedbackMessage() {
-	return m_feedbackMessage;
+	};
+	const CommandConfig& commands = *config.commands;
+	compileCommands(commands.sessionStartCmds, commandTemplates.sessionStart);
+	compileCommands(commands.sessionEndCmds, commandTemplates.sessionEnd);
+	compileCommands(commands.trialStartCmds, commandTemplates.trialStart);
+	compileCommands(commands.trialEndCmds, commandTemplates.trialEnd);
+	compileCommands(commands.trialEventCmds, commandTemplates.trialEvents);
 }
 
 void Session::endLogging() {
 	if (notNull(logger)) {
 
-		//m_logger->logUserConfig(*m_app->currentUser(), m_config->id, m_config->player.turnScale);
+		//m_logger->logUserConfig(*m_app->currentUser(), m_config->id, m_config->player->turnScale);
 		logger->flush(false);
 		logger.reset();
+
+		if (m_config->logger->logProfilerTrace) {
+			TraceRecorder::common().exportChromeTrace(format("%s_%s_%s_trace.json", m_dbFilename.c_str(), m_config->id.c_str(), FPSciLogger::genFileTimestamp().c_str()));
+		}
+		TraceRecorder::common().setEnabled(m_app->startupConfig.developerMode);			// Keep recording in developer mode (for the export key)
+	}
+	if (m_hitchCount > 0) {
+		logPrintfAsync("Detected %d frame hitch(es) in session %s\n", m_hitchCount, m_config->id.c_str());
 	}
+	logPrintfAsync("Spawned %d targets in session %s (%d reused from the pool, %d created, %d created up front to prewarm the pool)\n",
+		m_targetPool.reused() + m_targetPool.created(), m_config->id.c_str(), m_targetPool.reused(), m_targetPool.created(), m_targetPool.prewarmed());
 }
 
 shared_ptr<TargetEntity> Session::spawnDestTarget(
-	shared_ptr<TargetConfig> config,
+	shared_ptr<const TargetConfig> config,
 	const Point3& position,
+	const float targetSize,
 	const Color3& color,
+	const RandomStream& rng,
 	const int paramIdx,
 	const String& name)
 {
-	// Create the target
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
+	// Create the target (or reuse a pooled one)
 	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, TARGET_MODEL_SCALE_COUNT - 1);
-
-	const shared_ptr<TargetEntity>& target = TargetEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], position, scaleIndex, paramIdx);
+	const shared_ptr<Model>& model = (*m_targetModels)[config->id][scaleIndex];
+	shared_ptr<TargetEntity> target = m_targetPool.acquire(config->id);
+	if (isNull(target)) {
+		target = TargetEntity::create(config, pooledTargetName(config->id), m_scene, model, position, scaleIndex, paramIdx);
+		m_targetPool.add(target);
+	}
+	else {
+		target->reuse(config, model, position, scaleIndex, paramIdx);
+	}
+	if (!name.empty()) target->setLogName(name);		// Otherwise logged by its (pooled) entity name
+	target->rng() = rng;
 
 	// Update parameters for the target
 	target->setHitSound(config->hitSound, m_app->soundTable, config->hitSoundVol);
 	target->setDestoyedSound(config->destroyedSound, m_app->soundTable, config->destroyedSoundVol);
 	target->setFrame(position);
-	target->setColor(color);
+	target->setPose(m_targetPool.pose(color));
 
 	// Add target to array and scene
 	insertTarget(target);
@@ -732,11 +1069,20 @@ shared_ptr<FlyingEntity> Session::spawnReferenceTarget(
 	const Color3& color)
 {
 	const int scaleIndex = clamp(iRound(log(size) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, TARGET_MODEL_SCALE_COUNT - 1);
-	const shared_ptr<FlyingEntity>& target = FlyingEntity::create("reference", m_scene, (*m_targetModels)["reference"][scaleIndex], CFrame());
+	const shared_ptr<Model>& model = (*m_targetModels)["reference"][scaleIndex];
+	shared_ptr<FlyingEntity> target = dynamic_pointer_cast<FlyingEntity>(m_targetPool.acquire(""));		// The reference target has no config id
+	if (isNull(target)) {
+		target = FlyingEntity::create("reference", m_scene, model, CFrame());
+		m_targetPool.add(target);
+	}
+	else {
+		target->reset();
+		target->setModel(model);
+	}
 
 	// Setup additional target parameters
 	target->setFrame(position);
-	target->setColor(color);
+	target->setPose(m_targetPool.pose(color));
 
 	// Add target to array and scene
 	insertTarget(target);
@@ -744,20 +1090,29 @@ shared_ptr<FlyingEntity> Session::spawnReferenceTarget(
 }
 
 shared_ptr<FlyingEntity> Session::spawnFlyingTarget(
-	shared_ptr<TargetConfig> config,
+	shared_ptr<const TargetConfig> config,
 	const Point3& position,
 	const Point3& orbitCenter,
+	const float targetSize,
 	const Color3& color,
+	const RandomStream& rng,
 	const int paramIdx,
 	const String& name)
 {
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
 	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, TARGET_MODEL_SCALE_COUNT - 1);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
 	const bool isWorldSpace = config->destSpace == "world";
 
-	// Setup the target
-	const shared_ptr<FlyingEntity>& target = FlyingEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], orbitCenter, scaleIndex, paramIdx);
+	// Setup the target (or reuse a pooled one)
+	const shared_ptr<Model>& model = (*m_targetModels)[config->id][scaleIndex];
+	shared_ptr<FlyingEntity> target = dynamic_pointer_cast<FlyingEntity>(m_targetPool.acquire(config->id));
+	if (isNull(target)) {
+		target = FlyingEntity::create(config, pooledTargetName(config->id), m_scene, model, orbitCenter, scaleIndex, paramIdx, rng);
+		m_targetPool.add(target);
+	}
+	else {
+		target->reuse(config, model, orbitCenter, scaleIndex, paramIdx, rng);
+	}
+	if (!name.empty()) target->setLogName(name);		// Otherwise logged by its (pooled) entity name
 	target->setFrame(position);
 	target->setWorldSpace(isWorldSpace);
 	if (isWorldSpace) {
@@ -765,7 +1120,7 @@ shared_ptr<FlyingEntity> Session::spawnFlyingTarget(
 	}
 	target->setHitSound(config->hitSound, m_app->soundTable,  config->hitSoundVol);
 	target->setDestoyedSound(config->destroyedSound, m_app->soundTable, config->destroyedSoundVol);
-	target->setColor(color);
+	target->setPose(m_targetPool.pose(color));
 
 	// Add the target to the scene/target array
 	insertTarget(target);
@@ -773,21 +1128,30 @@ shared_ptr<FlyingEntity> Session::spawnFlyingTarget(
 }
 
 shared_ptr<JumpingEntity> Session::spawnJumpingTarget(
-	shared_ptr<TargetConfig> config,
+	shared_ptr<const TargetConfig> config,
 	const Point3& position,
 	const Point3& orbitCenter,
+	const float targetSize,
 	const Color3& color,
+	const RandomStream& rng,
 	const float targetDistance,
 	const int paramIdx,
 	const String& name)
 {
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
 	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, TARGET_MODEL_SCALE_COUNT - 1);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
 	const bool isWorldSpace = config->destSpace == "world";
 
-	// Setup the target
-	const shared_ptr<JumpingEntity>& target = JumpingEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], scaleIndex, orbitCenter, targetDistance, paramIdx);
+	// Setup the target (or reuse a pooled one)
+	const shared_ptr<Model>& model = (*m_targetModels)[config->id][scaleIndex];
+	shared_ptr<JumpingEntity> target = dynamic_pointer_cast<JumpingEntity>(m_targetPool.acquire(config->id));
+	if (isNull(target)) {
+		target = JumpingEntity::create(config, pooledTargetName(config->id), m_scene, model, scaleIndex, orbitCenter, targetDistance, paramIdx, rng);
+		m_targetPool.add(target);
+	}
+	else {
+		target->reuse(config, model, scaleIndex, orbitCenter, targetDistance, paramIdx, rng);
+	}
+	if (!name.empty()) target->setLogName(name);		// Otherwise logged by its (pooled) entity name
 	target->setFrame(position);
 	target->setWorldSpace(isWorldSpace);
 	if (isWorldSpace) {
@@ -795,7 +1159,7 @@ shared_ptr<JumpingEntity> Session::spawnJumpingTarget(
 	}
 	target->setHitSound(config->hitSound, m_app->soundTable, config->hitSoundVol);
 	target->setDestoyedSound(config->destroyedSound, m_app->soundTable, config->destroyedSoundVol);
-	target->setColor(color);
+	target->setPose(m_targetPool.pose(color));
 
 	// Add the target to the scene/target array
 	insertTarget(target);
@@ -803,34 +1167,58 @@ shared_ptr<JumpingEntity> Session::spawnJumpingTarget(
 }
 
 void Session::insertTarget(shared_ptr<TargetEntity> target) {
-	target->setShouldBeSaved(false);
-	m_targetArray.append(target);
-	m_scene->insert(target);
+	// Pooled targets are already in the scene
+	m_targets.add(target, TargetRegistry::Visible | (target->isLogged() ? TargetRegistry::Logged : 0));
 }
 
-void Session::destroyTarget(shared_ptr<TargetEntity> target) {
-	// Remove target from the scene
-	m_scene->removeEntity(target->name());
-	// Remove target from master list
-	for (int i = 0; i < m_targetArray.size(); i++) {
-		if (m_targetArray[i]->name() == target->name()) { m_targetArray.fastRemove(i); }
-	}
-	// Remove target from (un)hittable array
-	for (int i = 0; i < m_hittableTargets.size(); i++) {
-		if (m_hittableTargets[i]->name() == target->name()) { 
-			m_hittableTargets.fastRemove(i); 
-			return;	// Target can't be both hittable and unhittable
-		}
-	}
-	for (int i = 0; i < m_unhittableTargets.size(); i++) {
-		if (m_unhittableTargets[i]->name() == target->name()) { m_unhittableTargets.fastRemove(i); }
-	}
+String Session::pooledTargetName(const String& configId) const {
+	return format("%s_target_%s_%d", m_config->id.c_str(), configId.c_str(), m_targetPool.size());
+}
 
+void Session::destroyTarget(shared_ptr<TargetEntity> target) {
+	// Remove target from the registry
+	if (!m_targets.remove(target)) return;			// Already destroyed (don't release it to the pool twice)
+	// Hide the target (it stays in the scene for reuse)
+	m_targetPool.release(target);
 }
 
 /** Clear all targets one by one */
 void Session::clearTargets() {
-	for(auto target : m_targetArray) {
-		destroyTarget(target);
+	while (m_targets.size() > 0) {
+		destroyTarget(m_targets.all().last());		// Removes the target from the registry
+	}
+	m_preSpawnedTargets.fastClear();
+}
+
+void Session::clearTargetPool() {
+	clearTargets();
+	m_targetPool.clear();
+}
+
+void Session::prewarmTargetPool() {
+	// Spawn (and release) each trial's targets once, so the pool holds as many targets of each config as any trial uses
+	const RandomStream rng;
+	const Color3 color = m_config->targetView->healthColors[0];
+	m_targetPool.setPrewarming(true);
+	for (const Array<shared_ptr<const TargetConfig>>& trial : m_trials) {
+		for (int i = 0; i < trial.size(); i++) {
+			const shared_ptr<const TargetConfig>& config = trial[i];
+			if (config->destinations.size() > 0) {
+				spawnDestTarget(config, Point3::zero(), config->size[0], color, rng, i);
+			}
+			else if (config->jumpEnabled) {
+				spawnJumpingTarget(config, Point3::zero(), Point3::zero(), config->size[0], color, rng, m_targetDistance, i);
+			}
+			else {
+				spawnFlyingTarget(config, Point3::zero(), Point3::zero(), config->size[0], color, rng, i);
+			}
+		}
+		clearTargets();
+	}
+	if (m_config->targetView->showRefTarget) {
+		spawnReferenceTarget(Point3::zero(), Point3::zero(), m_config->targetView->refTargetSize, m_config->targetView->refTargetColor);
+		clearTargets();
 	}
+	m_targetPool.pose(m_config->targetView->previewColor);
+	m_targetPool.setPrewarming(false);
 }
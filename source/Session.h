@@ -29,6 +29,15 @@
 
 #include <G3D/G3D.h>
 #include "FpsConfig.h"
+#include "TextLogSink.h"
+#include "SessionJournal.h"
+#include "StageCounters.h"
+#include "LatencyTracker.h"
+#include "TrialSchedule.h"
+#include "TextTemplate.h"
+#include "ProcessRunner.h"
+#include "TargetPool.h"
+#include "TargetRegistry.h"
 #include <ctime>
 
 class FPSciApp;
@@ -52,9 +61,24 @@ public:
 };
 
  struct FrameInfo {
-	FILETIME time;
-	//float idt = 0.0f;
-	float sdt = 0.0f;
+	FILETIME time;						///< Time the frame completed (after swap)
+	int frameNumber = 0;				///< Frame number (since the start of the session)
+	float rdt = 0.0f;					///< Real (wall clock) time step
+	float sdt = 0.0f;					///< Simulation time step
+	float idt = 0.0f;					///< Ideal (target) time step
+
+	// Per-stage durations (in seconds)
+	float inputTime = 0.0f;				///< User input processing
+	float simulationTime = 0.0f;		///< Simulation
+	float poseTime = 0.0f;				///< Pose
+	float waitTime = 0.0f;				///< Frame limiter wait
+	float graphicsTime = 0.0f;			///< Graphics (render)
+	float swapTime = 0.0f;				///< Swap buffers
+
+	bool missedDeadline = false;		///< The frame's work used the whole frame duration (no time left to wait)
+
+	Point2 view = Point2::zero();		///< Displayed view direction (azimuth, elevation in degrees), including any late latch
+	Vector2 lateLatch = Vector2::zero();	///< Rotation applied by the late latch (yaw, pitch in degrees)
 
 	FrameInfo() {};
 
@@ -64,6 +88,23 @@ public:
 	}
 };
 
+/** Diagnostic snapshot of a frame that exceeded its time budget */
+struct HitchInfo {
+	FrameInfo frame;					///< Timing breakdown for the frame
+	float frameTime = 0.0f;				///< Total (wall clock) duration of the frame
+	float budget = 0.0f;				///< Frame time budget (target frame duration)
+	String sessionId;					///< Current session
+	String state;						///< Presentation state during the frame
+	int trialIdx = -1;					///< Current trial (trial_id in the Trials table)
+	int trialCount = -1;				///< Completed count for the current trial (trial_index in the Trials table)
+	int block = 0;						///< Current block
+	int targetCount = 0;				///< Number of targets in the scene
+	int projectileCount = 0;			///< Number of projectiles in flight
+	int decalCount = 0;					///< Number of decals in the scene
+	size_t loggerQueueBytes = 0;		///< Results pending in the logger queues (in bytes)
+	String zones;						///< Most recent profiler zones (see TraceRecorder::recentEventsToString())
+};
+
 struct TargetLocation {
 	FILETIME time;
 	String name = "";
@@ -163,23 +204,43 @@ protected:
 	int m_hitCount = 0;									///< Count of total hits in this trial
 	bool m_hasSession;									///< Flag indicating whether psych helper has loaded a valid session
 	int	m_currBlock = 1;								///< Index to the current block of trials
-	Array<Array<shared_ptr<TargetConfig>>> m_trials;	///< Storage for trials (to repeat over blocks)
+	Array<Array<shared_ptr<const TargetConfig>>> m_trials;	///< Storage for trials (to repeat over blocks)
 	String m_feedbackMessage;							///< Message to show when trial complete
+	
+	// Feedback messages and commands (compiled from the config when the session is created)
+	struct FeedbackTemplates {
+		TextTemplate initialWithRef, initialNoRef, trialSuccess, trialFailure, blockComplete, sessComplete, allSessComplete;
+	};
+	struct CommandTemplates {
+		Array<TextTemplate> sessionStart, sessionEnd, trialStart, trialEnd, trialEvents;
+	};
+	TemplateVariables m_feedbackVariables;				///< Variables available to feedback messages
+	TemplateVariables m_commandVariables;				///< Variables available to commands
+	FeedbackTemplates m_feedbackTemplates;
+	CommandTemplates m_commandTemplates;
+	String m_commandBuffer;								///< Reused buffer for formatted commands
+	int m_hitchCount = 0;								///< Number of frame hitches detected during this session
+	StageCounters::Totals m_trialCounters;				///< CPU counters accumulated over the current trial task
 
 	// Target management
 	Table<String, Array<shared_ptr<ArticulatedModel>>>* m_targetModels;
-	int m_lastUniqueID = 0;									///< Counter for creating unique names for various entities
 	
-	Array<shared_ptr<TargetEntity>> m_targetArray;			///< Array of drawn targets
-	Array<shared_ptr<TargetEntity>> m_hittableTargets;		///< Array of targets that can be hit
-	Array<shared_ptr<TargetEntity>> m_unhittableTargets;	///< Array of targets that can't be hit
+	TargetRegistry m_targets;								///< Spawned targets (and whether they can be hit)
+	TargetPool m_targetPool;								///< Destroyed targets (kept hidden in the scene for reuse)
+	Array<shared_ptr<TargetEntity>> m_preSpawnedTargets;	///< The next trial's targets (hidden and unhittable until the task starts)
+	Point3 m_preSpawnPos;									///< Player position the targets were pre-spawned relative to
 
 
-	int m_currTrialIdx;										///< Current trial
+	int m_currTrialIdx = -1;								///< Current trial
 	int m_currQuestionIdx = -1;								///< Current question index
 	Array<int> m_remainingTrials;							///< Completed flags
 	Array<int> m_completedTrials;								///< Count of completed trials
-	Array<Array<shared_ptr<TargetConfig>>> m_targetConfigs;	///< Target configurations by trial
+	Array<Array<shared_ptr<const TargetConfig>>> m_targetConfigs;	///< Target configurations by trial
+	TrialSchedule m_schedule;								///< Trial order and target spawn parameters (compiled at session start)
+	int m_scheduleIdx = 0;									///< Index of the next trial to run in m_schedule
+
+	SessionJournal m_journal;								///< Journal of session progress (for resuming an interrupted session)
+	SessionJournal::State m_resumeState;					///< State to resume from (if resuming an interrupted session)
 
 	// Time-based parameters
 	RealTime m_taskExecutionTime;						///< Task completion time for the most recent trial
@@ -190,8 +251,12 @@ protected:
 	// Could move timer above to stopwatch in future
 	//Stopwatch stopwatch;			
 
-	Array<HANDLE> m_sessProcesses;						///< Handles for session-level processes
-	Array<HANDLE> m_trialProcesses;						///< Handles for trial-level processes
+	Array<int> m_sessProcesses;							///< Ids of session-level processes (in the app's ProcessRunner)
+	Array<int> m_trialProcesses;						///< Ids of trial-level processes
+	Array<int> m_blockingProcesses;						///< Ids of blocking processes the next state is waiting on
+	Array<int> m_eventProcesses;						///< Ids of processes receiving session/trial events on stdin
+	enum PresentationState m_pendingState;				///< State to enter once blocking processes complete
+	bool m_statePending = false;						///< Is a state transition waiting on blocking processes?
 
 	// Target parameters
 	const float m_targetDistance = 1.0f;				///< Actual distance to target
@@ -200,52 +265,50 @@ protected:
 	Session(FPSciApp* app);
 
 	~Session(){
-		clearTargets();					// Clear the targets when the session is done
+		clearTargetPool();				// Remove the (pooled) targets from the scene when the session is done
+		closeEventProcesses();			// Let trial event processes know the session is over (they see EOF)
 		// For now leave "orphaned" processes to allow (session) end commands to run until completion
 		//closeTrialProcesses();		// Close any trial processes affiliated with this session
 		//closeSessionProcesses();		// Close any processes affiliated with this session
 	}
 
-	inline void runTrialCommands(String evt) {
-		evt = toLower(evt);
-		auto cmds = (evt == "start") ? m_config->commands.trialStartCmds : m_config->commands.trialEndCmds;
-		for (auto cmd : cmds) { 
-			m_trialProcesses.append(runCommand(cmd, evt + " of trial")); 
-		}
-	}
-
-	inline void closeTrialProcesses() {
-		for (auto handle : m_trialProcesses) { 
-			TerminateProcess(handle, 0); 
-		}
-		m_trialProcesses.clear();
-	}
-
-	inline void runSessionCommands(String evt) {
-		evt = toLower(evt);
-		auto cmds = (evt == "start") ? m_config->commands.sessionStartCmds : m_config->commands.sessionEndCmds;
-		for (auto cmd : cmds) { 
-			m_sessProcesses.append(runCommand(cmd, evt + " of session")); 
-		}
-	}
-
-	inline void closeSessionProcesses() {
-		for (auto handle : m_sessProcesses) { 
-			TerminateProcess(handle, 0); 
-		}
-		m_sessProcesses.clear();
-	}
-
-	String formatFeedback(const String& input);
-	String formatCommand(const String& input);
-
-	/** Insert a target into the target array/scene */
+	/** Run the start/end of trial commands */
+	void runTrialCommands(String evt);
+	/** Terminate any (still running) trial-level processes */
+	void closeTrialProcesses();
+	/** Run the start/end of session commands */
+	void runSessionCommands(String evt);
+	/** Terminate any (still running) session-level processes */
+	void closeSessionProcesses();
+	/** Send an event line (w/ the given timestamp) to the trial event processes */
+	void sendEvent(const char* evt, const String& timestamp);
+	/** Close the trial event processes' input (they are expected to exit on EOF) */
+	void closeEventProcesses();
+
+	/** Bind the template variables to this session and compile the config's feedback messages and commands (validated at
+		experiment load, see validateTemplates(), only the system config dependent checks are made here)
+	*/
+	void compileTemplates();
+	/** Add the variables available to feedback messages/commands (session is only read when rendering, null to only compile) */
+	static void addFeedbackVariables(TemplateVariables& variables, Session* session);
+	static void addCommandVariables(TemplateVariables& variables, Session* session);
+	/** Compile a session config's feedback messages and commands (throws a String describing any unknown variable) */
+	static void compileTemplates(const SessionConfig& config, const TemplateVariables& feedbackVariables, const TemplateVariables& commandVariables,
+		FeedbackTemplates& feedback, CommandTemplates& commands);
+	/** Render a feedback message template into the current feedback message */
+	void setFeedback(const TextTemplate& message) { message.render(m_feedbackVariables, m_feedbackMessage); }
+
+	/** Register a (pooled) target as spawned (visible, but not hittable until setHittable() is called) */
 	inline void insertTarget(shared_ptr<TargetEntity> target);
+	/** Scene name for a new pooled target */
+	String pooledTargetName(const String& configId) const;
+	/** Create each trial's targets (and the reference target) once, so spawning them later reuses pooled targets */
+	void prewarmTargetPool();
 
 	/** Get the total target count for the current trial */
 	int totalTrialTargets() const {
 		int totalTargets = 0;
-		for (shared_ptr<TargetConfig> target : m_targetConfigs[m_currTrialIdx]) {
+		for (shared_ptr<const TargetConfig> target : m_targetConfigs[m_currTrialIdx]) {
 			if (target->respawnCount == -1) {
 				totalTargets = -1;		// Ininite spawn case
 				break;
@@ -258,9 +321,11 @@ protected:
 	}
 
 	shared_ptr<TargetEntity> spawnDestTarget(
-		shared_ptr<TargetConfig> config,
+		shared_ptr<const TargetConfig> config,
 		const Point3& position,
+		const float size,
 		const Color3& color,
+		const RandomStream& rng,
 		const int paramIdx,
 		const String& name = "");
 
@@ -272,19 +337,23 @@ protected:
 	);
 
 	shared_ptr<FlyingEntity> spawnFlyingTarget(
-		shared_ptr<TargetConfig> config,
+		shared_ptr<const TargetConfig> config,
 		const Point3& position,
 		const Point3& orbitCenter,
+		const float size,
 		const Color3& color,
+		const RandomStream& rng,
 		const int paramIdx,
 		const String& name = ""
 	);
 
 	shared_ptr<JumpingEntity> spawnJumpingTarget(
-		shared_ptr<TargetConfig> config,
+		shared_ptr<const TargetConfig> config,
 		const Point3& position,
 		const Point3& orbitCenter,
+		const float size,
 		const Color3& color,
+		const RandomStream& rng,
 		const float targetDistance,
 		const int paramIdx,
 		const String& name = ""
@@ -303,48 +372,11 @@ protected:
 		return m_camera->frame().translation;
 	}
 
-	HANDLE runCommand(CommandSpec cmd, String evt) {
-		STARTUPINFO si;
-		PROCESS_INFORMATION pi;
-		ZeroMemory(&si, sizeof(si));
-		si.cb = sizeof(si);
-		ZeroMemory(&pi, sizeof(pi));
-
-		// Run the (formatted command)
-		LPSTR command = LPSTR(formatCommand(cmd.cmdStr).c_str());
-		bool success;
-		if (cmd.foreground) {	// Run process in the foreground
-			success = CreateProcess(NULL, command, NULL, NULL, FALSE, CREATE_NEW_CONSOLE, NULL, NULL, &si, &pi);
-		}
-		else {				// Run process silently in the background
-			success = CreateProcess(NULL, command, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
-		}
-
-		if (!success) {
-			logPrintf("Failed to run %s command: \"%s\". %s\n", evt, cmd, GetLastErrorString());
-		}
-
-		if (cmd.blocking) {	// Optional blocking behavior
-			WaitForSingleObject(pi.hProcess, INFINITE);
-		}
-
-		return pi.hProcess;
-	}
+	/** Queue a command to run (in the app's ProcessRunner, once the after process completes), returns the process id */
+	int runCommand(const CommandSpec& cmd, const TextTemplate& cmdTemplate, const String& evt, int after = -1);
 
-	String GetLastErrorString() {
-		DWORD error = GetLastError();
-		if (error) {
-			LPVOID lpMsgBuf;
-			DWORD bufLen = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, error, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPTSTR)&lpMsgBuf, 0, NULL);
-			if (bufLen) {
-				LPCSTR lpMsgStr = (LPCSTR)lpMsgBuf;
-				std::string result(lpMsgStr, lpMsgStr + bufLen);
-				LocalFree(lpMsgBuf);
-				return String(result);
-			}
-		}
-		return String();
-	}
+	/** Enter a new presentation state */
+	void enterState(enum PresentationState newState);
 
 public:
 	float initialHeadingRadians = 0.0f;
@@ -357,9 +389,19 @@ public:
 		return createShared<Session>(app, config);
 	}
 
+	/** Check a session config's feedback messages and commands compile (throws a String describing any error) */
+	static void validateTemplates(const SessionConfig& config);
+
 	void randomizePosition(const shared_ptr<TargetEntity>& target) const;
 	void initTargetAnimation();
 	void spawnTrialTargets(Point3 initialSpawnPos, bool previewMode = false);
+	/** Spawn the current trial's i-th target (w/o logging it) */
+	shared_ptr<TargetEntity> spawnTrialTarget(int i, const Point3& initialSpawnPos, const Color3& spawnColor);
+	/** Are the trial's targets spawned (hidden) during the pretrial state? */
+	bool preSpawnEnabled() const;
+	/** Spawn the next of the trial's targets (hidden, unhittable and frozen) ahead of the task */
+	void preSpawnNextTarget();
+	void clearPreSpawnedTargets();
 
 	bool blockComplete() const;
 	bool nextCondition();
@@ -367,22 +409,39 @@ public:
 
 	void endLogging();
 
-	/** randomly returns either +1 or -1 **/	
-	static float randSign() {
-		if (Random::common().uniform() > 0.5) {
-			return 1;
-		} else {
-			return -1;
-		}
-	}
+	/** Random stream id for the weapon (all of the session's streams are derived from its schedule seed, the schedule uses stream 0) */
+	static const uint64 WeaponStream = 1;
+	/** Random stream id for the target at the given index in the given scheduled trial */
+	static uint64 targetStream(int scheduleIdx, int targetIdx) { return (uint64(scheduleIdx + 1) << 20) | uint64(targetIdx); }
 	
 	void updatePresentationState();
 	void onInit(String filename, String description);
+
+	/** The session's compiled trial schedule */
+	const TrialSchedule& schedule() const { return m_schedule; }
+
+	/** Resume from the progress recorded in a session journal (call before onInit) */
+	void setResumeState(const SessionJournal::State& state) { m_resumeState = state; }
+	/** Mark the session as abandoned (the user moved on to another session), so it isn't resumed */
+	void abandon() { m_journal.markAbandoned(); }
+
 	void onSimulation(RealTime rdt, SimTime sdt, SimTime idt);
 	void processResponse();
 	void recordTrialResponse(int destroyedTargets, int totalTargets);
 	void accumulateTrajectories();
-	void accumulateFrameInfo(RealTime rdt, float sdt, float idt);
+	/** Log timing info for a completed frame (only logged during the trial task) */
+	void accumulateFrameInfo(const FrameInfo& info);
+	/** Count a frame that exceeded its time budget, and log it (filling in the session state for the snapshot) if hitches are logged */
+	void logHitch(HitchInfo& hitch);
+	int hitchCount() const { return m_hitchCount; }
+	/** Accumulate CPU counters for a completed frame (only accumulated during the trial task) */
+	void accumulateStageCounters(const StageCounters::Totals& counters);
+	/** Log the (software) input to present latency of a shot */
+	void logShotLatency(const ShotLatency& shot);
+	/** Log a finished command (to the results db if it was run by this session) */
+	void logCommand(const CommandProcess& process);
+	/** Log a change of the adaptive quality level */
+	void logQualityChange(int frameNumber, int fromLevel, int toLevel, const String& levelName, float meanFrameTime, float budget);
 
 	void countDestroy() {
 		m_destroyedTargets++;
@@ -393,11 +452,13 @@ public:
 
 	/** clear all targets (used when clearing remaining targets at the end of a trial) */
 	void clearTargets();
+	/** clear all targets and remove the pooled targets from the scene (used before changing scenes) */
+	void clearTargetPool();
 
 	float getRemainingTrialTime();
 	float getProgress();
 	int getScore();
-	String getFeedbackMessage();
+	const String& getFeedbackMessage() const { return m_feedbackMessage; }
 
 	/** queues action with given name to insert into database when trial completes
 	@param action - one of "aim" "hit" "miss" or "invalid (shots limited by fire rate)" */
@@ -406,19 +467,16 @@ public:
 	bool updateBlock(bool init = false);
 
 	bool moveOn = false;								///< Flag indicating session is complete
+	/** Is the session waiting on blocking commands (before entering its next state)? */
+	bool waitingOnCommands() const { return m_blockingProcesses.size() > 0; }
 	enum PresentationState currentState;			///< Current presentation state
 
 	const Array<shared_ptr<TargetEntity>>& targetArray() const {
-		return m_targetArray;
+		return m_targets.all();
 	}
 
-	/** dynamically allocates a new array of pointers to the hittable targets in the session */
+	/** The targets in the session that can be hit */
 	const Array<shared_ptr<TargetEntity>>& hittableTargets() const {
-		return m_hittableTargets;
-	}
-
-	/** dynamically allocates a new array of pointers to the unhittable (visible but inactive) targets in the session */
-	const Array<shared_ptr<TargetEntity>>& unhittableTargets() const {
-		return m_unhittableTargets;
+		return m_targets.hittable();
 	}
 };
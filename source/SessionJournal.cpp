@@ -0,0 +1,141 @@
+#include "SessionJournal.h"
+#include "TextLogSink.h"
+#include "ThreadPolicy.h"
+#include <io.h>
+
+static String joinCounts(const Array<int>& counts) {
+	String s;
+	for (int i = 0; i < counts.size(); i++) {
+		s += format(i == 0 ? "%d" : ",%d", counts[i]);
+	}
+	return s;
+}
+
+static Array<int> splitCounts(const String& s) {
+	Array<int> counts;
+	for (const String& token : stringSplit(s, ',')) {
+		if (!token.empty()) counts.append(atoi(token.c_str()));
+	}
+	return counts;
+}
+
+void SessionJournal::writeRecord(const String& record) {
+	if (isNull(m_file)) return;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_pending.append(record);
+	}
+	m_cv.notify_one();
+}
+
+void SessionJournal::writerThreadEntry() {
+	ThreadPolicy::applyRole("helper", "SessionJournal");
+	Array<String> records;
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true) {
+		m_cv.wait(lk, [this] { return !m_running || m_pending.size() > 0; });
+		if (m_pending.size() == 0) break;			// Stopped w/ nothing left to write
+		records.fastClear();
+		records.swap(m_pending, records);
+		lk.unlock();
+
+		for (const String& record : records) {
+			fputs(record.c_str(), m_file);
+			fputc('\n', m_file);
+		}
+		fflush(m_file);
+		_commit(_fileno(m_file));		// Make sure the records survive a crash
+
+		lk.lock();
+	}
+}
+
+void SessionJournal::startWriter() {
+	m_running = true;
+	m_thread = std::thread(&SessionJournal::writerThreadEntry, this);
+}
+
+void SessionJournal::begin(const String& filename, const State& header) {
+	close();
+	m_filename = filename;
+	m_file = fopen(filename.c_str(), "w");
+	if (isNull(m_file)) {
+		logPrintfAsync("Could not open session journal: %s\n", filename.c_str());
+		return;
+	}
+	startWriter();
+	writeRecord(format("session\t%s\t%s\t%u\t%s\t%s", header.sessionId.c_str(), header.userId.c_str(), header.seed, header.dbFilename.c_str(), header.startTime.c_str()));
+}
+
+void SessionJournal::resume(const String& filename) {
+	close();
+	m_filename = filename;
+	m_file = fopen(filename.c_str(), "a");
+	if (isNull(m_file)) {
+		logPrintfAsync("Could not open session journal: %s\n", filename.c_str());
+		return;
+	}
+	startWriter();
+}
+
+void SessionJournal::recordTrial(int trialIdx, int block, const Array<int>& completedTrials, const Array<int>& remainingTrials) {
+	writeRecord(format("trial\t%d\t%d\t%s\t%s", trialIdx, block, joinCounts(completedTrials).c_str(), joinCounts(remainingTrials).c_str()));
+}
+
+void SessionJournal::markComplete() {
+	writeRecord("complete");
+	close();
+}
+
+void SessionJournal::markAbandoned() {
+	writeRecord("abandoned");
+	close();
+}
+
+void SessionJournal::close() {
+	if (m_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			m_running = false;
+		}
+		m_cv.notify_one();
+		m_thread.join();				// Writes out (and commits) any queued records
+	}
+	if (notNull(m_file)) {
+		fclose(m_file);
+		m_file = nullptr;
+	}
+}
+
+SessionJournal::State SessionJournal::load(const String& filename) {
+	State state;
+	if (!FileSystem::exists(filename)) return state;
+
+	for (const String& line : stringSplit(readWholeFile(filename), '\n')) {
+		const Array<String> fields = stringSplit(trimWhitespace(line), '\t');
+		if (fields[0] == "session" && fields.size() >= 5) {
+			state.sessionId = fields[1];
+			state.userId = fields[2];
+			state.seed = (uint32)strtoul(fields[3].c_str(), nullptr, 10);
+			state.dbFilename = fields[4];
+			if (fields.size() > 5) state.startTime = fields[5];			// Not written by older versions
+		}
+		else if (fields[0] == "trial" && fields.size() == 5) {
+			// Skip records w/ a different trial count (e.g. a truncated final line)
+			const Array<int> completed = splitCounts(fields[3]);
+			const Array<int> remaining = splitCounts(fields[4]);
+			if (completed.size() != remaining.size()) continue;
+			state.trialOrder.append(atoi(fields[1].c_str()));
+			state.block = atoi(fields[2].c_str());
+			state.completedTrials = completed;
+			state.remainingTrials = remaining;
+		}
+		else if (fields[0] == "complete") {
+			state.complete = true;
+		}
+		else if (fields[0] == "abandoned") {
+			state.abandoned = true;
+		}
+	}
+	return state;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/** Append-only journal of session progress, used to resume a session after a crash (or forced quit)
+
+	The journal is a small tab-separated text file with one record per line:
+		session		<session id>	<user id>	<random seed>	<results filename (w/o .db)>	<session start time>
+		trial		<trial index>	<block>		<completed counts>	<remaining counts>
+		complete
+		abandoned
+	A new journal is started with each session and a "trial" record is appended (and committed to disk) as each trial completes.
+	Records are handed to a writer thread (started w/ the journal), so the caller never waits on the disk commit. close() waits
+	for the queued records to be committed.
+*/
+class SessionJournal {
+public:
+	/** Session progress recovered from a journal */
+	struct State {
+		String sessionId;						///< Session this journal was written for
+		String userId;							///< User running the session
+		String dbFilename;						///< Results filename (less the .db extension)
+		String startTime;						///< Start time of the session (identifies its row in the results file's Sessions table)
+		uint32 seed = 0;						///< Random seed used for the session
+		int block = 1;							///< Block index at the last completed trial
+		Array<int> trialOrder;					///< Trial indices in the order they were completed
+		Array<int> completedTrials;				///< Completed count (per trial index)
+		Array<int> remainingTrials;				///< Remaining count in this block (per trial index)
+		bool complete = false;					///< Whether the session ran to completion
+		bool abandoned = false;					///< Whether the user switched to another session before completing it
+
+		/** Does this state describe an interrupted session that can be resumed? */
+		bool resumable() const { return !sessionId.empty() && !complete && !abandoned && trialOrder.size() > 0; }
+	};
+
+protected:
+	String m_filename;
+	FILE* m_file = nullptr;						///< Only written by the writer thread (while it is running)
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	Array<String> m_pending;						///< Records waiting to be written (guarded by m_mutex)
+	bool m_running = false;						///< Whether the writer thread should keep running (guarded by m_mutex)
+
+	/** Queue a single record to be written and committed to disk (by the writer thread) */
+	void writeRecord(const String& record);
+
+	void writerThreadEntry();
+	/** Start the writer thread for the (open) journal file */
+	void startWriter();
+
+public:
+	~SessionJournal() { close(); }
+
+	/** Start a new journal (overwriting any existing one) */
+	void begin(const String& filename, const State& header);
+
+	/** Reopen an existing journal to continue appending to it */
+	void resume(const String& filename);
+
+	/** Record a completed trial along w/ the current session progress */
+	void recordTrial(int trialIdx, int block, const Array<int>& completedTrials, const Array<int>& remainingTrials);
+
+	/** Record that the session is complete and close the journal */
+	void markComplete();
+
+	/** Record that the session was left incomplete on purpose (so it isn't resumed) and close the journal */
+	void markAbandoned();
+
+	/** Wait for the queued records to be committed, then close the journal */
+	void close();
+
+	bool isOpen() const { return notNull(m_file); }
+
+	/** Read back the session state from a journal (returns an empty state if the file doesn't exist) */
+	static State load(const String& filename);
+};
@@ -0,0 +1,46 @@
+#include "SimulationThread.h"
+#include "TextLogSink.h"
+#include "TraceRecorder.h"
+#include "ThreadPolicy.h"
+
+void SimulationThread::start(float rateHz, const StepCallback& callback) {
+	stop();
+	if (rateHz <= 0.f) return;
+	m_step = 1.0 / rateHz;
+	m_callback = callback;
+	m_stepCount = 0;
+	m_lastStepTime = System::time();
+	m_pacer.resetStats();
+	m_running = true;
+	m_thread = std::thread(&SimulationThread::threadEntry, this);
+	logPrintfAsync("Started simulation thread at %.1f Hz\n", rateHz);
+}
+
+void SimulationThread::stop() {
+	if (!m_running) return;
+	m_running = false;
+	if (m_thread.joinable()) m_thread.join();
+	logPrintfAsync("Stopped simulation thread after %lld steps\n", (long long)m_stepCount.load());
+}
+
+void SimulationThread::threadEntry() {
+	TraceRecorder::common().setThreadName("Simulation");
+	ThreadPolicy::applyRole("helper", "Simulation");
+	RealTime deadline = System::time();
+	while (m_running) {
+		deadline += m_step;
+		const RealTime now = m_pacer.waitUntil(deadline);
+		// Don't try to catch up after a long stall (e.g. a scene load), skip ahead instead
+		if (now - deadline > MaxCatchUpSteps * m_step) {
+			deadline = now;
+		}
+
+		std::lock_guard<std::mutex> lk(m_mutex);
+		if (!m_running) break;
+		TraceRecorder::beginEvent("Simulation Step");
+		m_callback(m_step);
+		TraceRecorder::endEvent();
+		m_lastStepTime = System::time();
+		m_stepCount++;
+	}
+}
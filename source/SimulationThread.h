@@ -0,0 +1,50 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "FramePacer.h"
+
+/** Runs a fixed rate simulation step on its own thread (decoupled from rendering)
+
+	The step callback is called w/ mutex() held, any other thread must hold mutex() while touching simulated state.
+	Steps are paced to the step period w/ their own FramePacer, so step timing doesn't depend on how long rendering takes.
+*/
+class SimulationThread {
+public:
+	using StepCallback = std::function<void(SimTime)>;
+	static const int MaxCatchUpSteps = 8;				///< Max steps to run back-to-back after a stall (before skipping ahead)
+
+protected:
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::atomic<bool>		m_running;
+	SimTime					m_step = 0.0;				///< Step period (in seconds)
+	StepCallback			m_callback;
+	RealTime				m_lastStepTime = 0.0;		///< Time the last step completed (written w/ mutex held)
+	std::atomic<int64>		m_stepCount;
+	FramePacer				m_pacer;
+
+	void threadEntry();
+
+public:
+	SimulationThread() : m_running(false), m_stepCount(0) {}
+	~SimulationThread() { stop(); }
+
+	/** Start stepping the callback at the provided rate (in Hz) */
+	void start(float rateHz, const StepCallback& callback);
+	/** Stop (and join) the thread, don't call w/ mutex() held */
+	void stop();
+
+	bool running() const { return m_running; }
+	std::mutex& mutex() { return m_mutex; }
+	SimTime step() const { return m_step; }
+	int64 stepCount() const { return m_stepCount; }
+
+	/** Fraction of a step elapsed at the provided time since the last step (for interpolation), call w/ mutex() held */
+	float alpha(RealTime now) const {
+		if (m_step <= 0.0) return 1.f;
+		return clamp((float)((now - m_lastStepTime) / m_step), 0.f, 1.f);
+	}
+};
@@ -0,0 +1,70 @@
+#include "StageCounters.h"
+#include <psapi.h>
+#include <winternl.h>
+#include <vector>
+
+/** SYSTEM_THREAD_INFORMATION (winternl.h hides the context switch count in a reserved field) */
+struct ThreadInformation {
+	LARGE_INTEGER	kernelTime;
+	LARGE_INTEGER	userTime;
+	LARGE_INTEGER	createTime;
+	ULONG			waitTime;
+	PVOID			startAddress;
+	CLIENT_ID		clientId;
+	LONG			priority;
+	LONG			basePriority;
+	ULONG			contextSwitches;
+	ULONG			threadState;
+	ULONG			waitReason;
+};
+
+void StageCounters::Totals::add(const Totals& other) {
+	for (int i = 0; i < StageCount; i++) {
+		cycles[i] += other.cycles[i];
+	}
+	pageFaults += other.pageFaults;
+	frames += other.frames;
+}
+
+uint64 StageCounters::threadCycles() {
+	ULONG64 cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &cycles);
+	return (uint64)cycles;
+}
+
+uint64 StageCounters::threadContextSwitches(uint32 threadId) {
+	typedef NTSTATUS(NTAPI* QueryFn)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+	static const QueryFn query = (QueryFn)GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtQuerySystemInformation");
+	if (isNull(query)) return 0;
+
+	// Snapshot all processes (and their threads), growing the buffer until it fits
+	static std::vector<uint8> buffer(256 * 1024);
+	ULONG size = 0;
+	NTSTATUS status;
+	while ((status = query(SystemProcessInformation, buffer.data(), ULONG(buffer.size()), &size)) == (NTSTATUS)0xC0000004L) {		// STATUS_INFO_LENGTH_MISMATCH
+		buffer.resize(max(size_t(size) + 64 * 1024, buffer.size() * 2));
+	}
+	if (status < 0) return 0;
+
+	const HANDLE pid = (HANDLE)(ULONG_PTR)GetCurrentProcessId();
+	const HANDLE tid = (HANDLE)(ULONG_PTR)threadId;
+	const uint8* entry = buffer.data();
+	while (true) {
+		const SYSTEM_PROCESS_INFORMATION* process = (const SYSTEM_PROCESS_INFORMATION*)entry;
+		if (process->UniqueProcessId == pid) {
+			const ThreadInformation* threads = (const ThreadInformation*)(process + 1);
+			for (ULONG i = 0; i < process->NumberOfThreads; i++) {
+				if (threads[i].clientId.UniqueThread == tid) return (uint64)threads[i].contextSwitches;
+			}
+			return 0;
+		}
+		if (process->NextEntryOffset == 0) return 0;
+		entry += process->NextEntryOffset;
+	}
+}
+
+uint64 StageCounters::processPageFaults() {
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (uint64)counters.PageFaultCount;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Dynamic CPU counters sampled around the stages of a frame (the dynamic counterpart to SystemInfo)
+
+	Counts the CPU cycles charged to the calling thread (QueryThreadCycleTime) during each stage, and the process page faults per frame.
+	Windows does not expose hardware event counters (instructions, cache/branch misses) to user mode, so those are not sampled.
+	Context switches are only available from a (costly) snapshot of all threads in the system, so they are read per trial
+	(on the logger thread, see threadContextSwitches()) rather than per stage. When disabled, begin()/end() return immediately (no counters are read).
+*/
+class StageCounters {
+public:
+	enum Stage {
+		Input = 0,
+		Simulation,
+		Pose,
+		Wait,
+		Graphics,
+		Swap,
+		StageCount
+	};
+
+	/** Counter totals for one (or more) frames */
+	struct Totals {
+		uint64	cycles[StageCount] = { 0 };				///< CPU cycles charged to the (main) thread by stage
+		uint64	pageFaults = 0;							///< Process page faults
+		int		frames = 0;								///< Number of frames accumulated
+
+		void add(const Totals& other);
+	};
+
+	/** CPU cycles charged to the calling thread so far */
+	static uint64 threadCycles();
+
+	/** Page faults for the process so far */
+	static uint64 processPageFaults();
+
+	/** Context switches of a thread (of this process) so far (NtQuerySystemInformation), slow (snapshots every thread in the
+		system) so call it rarely and off of the main thread */
+	static uint64 threadContextSwitches(uint32 threadId);
+
+protected:
+	bool	m_enabled = false;
+	uint64	m_stageStart[StageCount] = { 0 };
+	uint64	m_frameStartPageFaults = 0;
+	Totals	m_frame;									///< Counters for the current frame
+
+public:
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	bool enabled() const { return m_enabled; }
+
+	/** Start counting a new frame */
+	void beginFrame() {
+		if (!m_enabled) return;
+		m_frame = Totals();
+		m_frame.frames = 1;
+		m_frameStartPageFaults = processPageFaults();
+	}
+
+	void begin(Stage stage) {
+		if (!m_enabled) return;
+		m_stageStart[stage] = threadCycles();
+	}
+
+	void end(Stage stage) {
+		if (!m_enabled) return;
+		m_frame.cycles[stage] += threadCycles() - m_stageStart[stage];
+	}
+
+	/** Finish counting the current frame, returns its totals */
+	const Totals& endFrame() {
+		if (m_enabled) m_frame.pageFaults = processPageFaults() - m_frameStartPageFaults;
+		return m_frame;
+	}
+};
@@ -0,0 +1,36 @@
+#include "StateDelayQueue.h"
+
+void StateDelayQueue::setDelay(int frames) {
+	frames = max(0, frames);
+	if (frames == m_delay && m_snapshots.size() == frames + 1) return;
+	m_delay = frames;
+	m_snapshots.resize(frames + 1);
+	clear();
+}
+
+void StateDelayQueue::clear() {
+	for (StateSnapshot& snapshot : m_snapshots) {
+		snapshot.fastClear();
+	}
+	m_index = 0;
+	m_count = 0;
+	m_current = 0;
+	m_delayed = 0;
+}
+
+StateSnapshot& StateDelayQueue::next() {
+	if (m_snapshots.size() == 0) m_snapshots.resize(1);
+	StateSnapshot& snapshot = m_snapshots[m_index];
+	snapshot.fastClear();
+	return snapshot;
+}
+
+const StateSnapshot& StateDelayQueue::advance() {
+	const int slots = m_snapshots.size();
+	m_current = m_index;
+	m_index = (m_index + 1) % slots;
+	m_count = min(m_count + 1, slots);
+	// Once full, the next slot to fill holds the oldest snapshot (captured delay() frames ago)
+	m_delayed = (m_count < slots) ? 0 : m_index;
+	return m_snapshots[m_delayed];
+}
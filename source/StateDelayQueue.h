@@ -0,0 +1,90 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <unordered_map>
+
+/** The (presented) simulation state needed to render a frame: the camera frame, the frames (and visibility) of the
+	scene's entities, and the target health bars drawn over them */
+struct StateSnapshot {
+	/** A target's health bar (where and how full it is drawn) */
+	struct HealthBar {
+		Point3	position;
+		float	health = 1.0f;
+	};
+
+	RealTime						time = 0.0;				///< System::time() the snapshot was captured (for time-based animation)
+	CFrame							camera;
+	Array<shared_ptr<Entity>>		entities;
+	Array<CFrame>					frames;					///< Frame of each entity (same order as entities)
+	Array<VisibleEntity*>			visibleEntities;		///< Each entity as a VisibleEntity (or nullptr if it isn't one)
+	Array<bool>						visible;				///< Visibility of each entity (true for non-VisibleEntities)
+	Array<HealthBar>				healthBars;				///< Health bars of the visible targets
+	std::unordered_map<const Entity*, int>	index;			///< Index of each entity (by pointer)
+
+	/** Clear the snapshot (keeping its storage) */
+	void fastClear() {
+		entities.fastClear();
+		frames.fastClear();
+		visibleEntities.fastClear();
+		visible.fastClear();
+		healthBars.fastClear();
+		index.clear();
+	}
+
+	void add(const shared_ptr<Entity>& entity, const CFrame& frame, VisibleEntity* visibleEntity = nullptr) {
+		index[entity.get()] = entities.size();
+		entities.append(entity);
+		frames.append(frame);
+		visibleEntities.append(visibleEntity);
+		visible.append(isNull(visibleEntity) || visibleEntity->visible());
+	}
+
+	/** Index of the entity in this snapshot (or -1 if not present) */
+	int indexOf(const shared_ptr<Entity>& entity) const {
+		const auto it = index.find(entity.get());
+		return (it == index.end()) ? -1 : it->second;
+	}
+
+	/** Put the i-th entity back in its captured frame (and visibility) */
+	void apply(int i) const {
+		entities[i]->setFrame(frames[i]);
+		if (notNull(visibleEntities[i])) visibleEntities[i]->setVisible(visible[i]);
+	}
+};
+
+/** Delays the rendered simulation state by a fixed number of frames
+
+	An alternative to delaying rendered framebuffers: each frame capture the state to present into next(), then call
+	advance() to get the state captured delay() frames ago and render that instead. This keeps delay() + 1 small snapshots
+	rather than delay() + 1 full resolution framebuffers, with the same frame delay.
+*/
+class StateDelayQueue {
+protected:
+	Array<StateSnapshot>	m_snapshots;					///< Ring of delay() + 1 snapshots (storage reused across frames)
+	int						m_delay = 0;					///< Frames of delay
+	int						m_index = 0;					///< Slot for the next snapshot
+	int						m_count = 0;					///< Number of snapshots captured (up to delay() + 1)
+	int						m_current = 0;					///< Slot of the last snapshot added
+	int						m_delayed = 0;					///< Slot of the last snapshot returned by advance()
+
+public:
+	/** Set the delay (in frames), clears the queue if it changes */
+	void setDelay(int frames);
+	int delay() const { return m_delay; }
+
+	/** Drop all captured snapshots */
+	void clear();
+
+	/** Snapshot to fill with the current frame's state (cleared, call advance() once filled) */
+	StateSnapshot& next();
+
+	/** Add the snapshot filled via next() and return the snapshot to render (delay() frames old, or the oldest captured) */
+	const StateSnapshot& advance();
+
+	/** The last snapshot added (by advance()) */
+	const StateSnapshot& current() const { return m_snapshots[m_current]; }
+	/** The last snapshot returned by advance() */
+	const StateSnapshot& delayed() const { return m_snapshots[m_delayed]; }
+
+	/** Number of frames the snapshot returned by advance() actually lags the current one (less than delay() until the queue fills) */
+	int currentLag() const { return max(0, m_count - 1); }
+};
@@ -1,4 +1,5 @@
 #include "SystemConfig.h"
+#include "TextLogSink.h"
 
 SystemConfig::SystemConfig(const Any& any) {
 	AnyTableReader reader(any);
@@ -21,6 +22,15 @@ SystemConfig::SystemConfig(const Any& any) {
 		else {
 			reader.getIfPresent("loggerSyncComPort", syncComPort);
 		}
+
+		reader.getIfPresent("preciseFramePacing", preciseFramePacing);
+		reader.getIfPresent("framePacerSpinUs", framePacerSpinUs);
+		reader.getIfPresent("simulationThread", simulationThread);
+		reader.getIfPresent("rawInputThread", rawInputThread);
+		reader.getIfPresent("processPriority", processPriority);
+		reader.getIfPresent("mainThread", mainThreadPolicy);
+		reader.getIfPresent("loggerThreads", loggerThreadPolicy);
+		reader.getIfPresent("helperThreads", helperThreadPolicy);
 		break;
 	default:
 		debugPrintf("Settings version '%d' not recognized in SystemConfig.\n", settingsVersion);
@@ -46,16 +56,44 @@ Any SystemConfig::toAny(const bool forceAll) const {
 	if (forceAll || def.loggerComPort != loggerComPort)	a["loggerComPort"] = loggerComPort;
 	if (forceAll || def.hasSync != hasSync)				a["hasLatencyLoggerSync"] = hasSync;
 	if (forceAll || def.syncComPort != syncComPort)		a["loggerSyncComPort"] = syncComPort;
+	if (forceAll || def.preciseFramePacing != preciseFramePacing)	a["preciseFramePacing"] = preciseFramePacing;
+	if (forceAll || def.framePacerSpinUs != framePacerSpinUs)		a["framePacerSpinUs"] = framePacerSpinUs;
+	if (forceAll || def.simulationThread != simulationThread)		a["simulationThread"] = simulationThread;
+	if (forceAll || def.rawInputThread != rawInputThread)			a["rawInputThread"] = rawInputThread;
+	if (forceAll || def.processPriority != processPriority)			a["processPriority"] = processPriority;
+	if (forceAll || def.mainThreadPolicy != mainThreadPolicy)		a["mainThread"] = mainThreadPolicy.toAny(forceAll);
+	if (forceAll || def.loggerThreadPolicy != loggerThreadPolicy)	a["loggerThreads"] = loggerThreadPolicy.toAny(forceAll);
+	if (forceAll || def.helperThreadPolicy != helperThreadPolicy)	a["helperThreads"] = helperThreadPolicy.toAny(forceAll);
 	return a;
 }
 
 void SystemConfig::printToLog() {
 	const String loggerComStr = hasLogger ? loggerComPort : "None";
 	const String syncComStr = hasSync ? syncComPort : "None";
-	logPrintf("-------------------\nLDAT-R Config:\n-------------------\n\tLogger Present: %s\n\tLogger COM Port: %s\n\tSync Card Present: %s\n\tSync COM Port: %s\n\n",
+	logPrintfAsync("-------------------\nLDAT-R Config:\n-------------------\n\tLogger Present: %s\n\tLogger COM Port: %s\n\tSync Card Present: %s\n\tSync COM Port: %s\n\n",
 		hasLogger ? "True" : "False",
 		loggerComStr.c_str(),
 		hasSync ? "True" : "False",
 		syncComStr.c_str()
 	);
+	logPrintfAsync("-------------------\nFrame Pacing:\n-------------------\n\tPrecise Frame Pacing: %s\n\tMin Spin Time: %.0f us\n\tSimulation Thread: %s\n\tRaw Input Thread: %s\n\n",
+		preciseFramePacing ? "True" : "False",
+		framePacerSpinUs,
+		simulationThread ? "True" : "False",
+		rawInputThread ? "True" : "False"
+	);
+	logPrintfAsync("-------------------\nThread Policy:\n-------------------\n\tProcess Priority: %s\n\tMain Thread: %s\n\tLogger Threads: %s\n\tHelper Threads: %s\n\n",
+		processPriority.c_str(),
+		mainThreadPolicy.toString().c_str(),
+		loggerThreadPolicy.toString().c_str(),
+		helperThreadPolicy.toString().c_str()
+	);
+}
+
+void SystemConfig::applyThreadPolicies() const {
+	ThreadPolicy::setRolePolicy("main", mainThreadPolicy);
+	ThreadPolicy::setRolePolicy("logger", loggerThreadPolicy);
+	ThreadPolicy::setRolePolicy("helper", helperThreadPolicy);
+	ThreadPolicy::applyProcessPriority(processPriority);
+	ThreadPolicy::applyRole("main", "Main");
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <G3D/G3D.h>
+#include "ThreadPolicy.h"
 
 /** System-specific configuration */
 class SystemConfig {
@@ -10,6 +11,25 @@ public:
 	bool	hasSync = false;		///< Indicates that a hardware sync will occur via serial card DTR signal
 	String	syncComPort = "";		///< Indicates the COM port that the sync is on when hasSync = True
 
+	// Frame pacing
+	bool	preciseFramePacing = false;		///< Use the hybrid sleep/spin frame pacer (instead of a sleep-only wait)
+	float	framePacerSpinUs = 2000.f;		///< Minimum time (in us) before the frame deadline to switch from sleeping to spinning
+
+	// Simulation
+	bool	simulationThread = false;		///< Run the (fixed rate) simulation on its own thread, decoupled from rendering
+
+	// Input
+	bool	rawInputThread = false;			///< Read (timestamped) mouse button events on their own thread at device rate
+
+	// Thread placement/priority
+	String			processPriority = "normal";		///< Priority class for the process
+	ThreadPolicy	mainThreadPolicy;				///< Policy for the main (input/simulation/render) thread
+	ThreadPolicy	loggerThreadPolicy;				///< Policy for the results (database) writer thread(s)
+	ThreadPolicy	helperThreadPolicy;				///< Policy for other helper threads (log.txt writer, simulation thread, raw input thread)
+
+	/** Register the thread policies (by role) and apply the process priority and main thread policy (call from the main thread) */
+	void applyThreadPolicies() const;
+
 	SystemConfig() {};
 	SystemConfig(const Any& any);
 
@@ -1,4 +1,5 @@
 #include "SystemInfo.h"
+#include "TextLogSink.h"
 
 SystemInfo SystemInfo::get(void) {
 	SystemInfo info;
@@ -27,7 +28,7 @@ SystemInfo SystemInfo::get(void) {
 			break;
 		default:
 			// Removed these are they are unnecessary prints...
-			//logPrintf("Couldn't get system info...\n");
+			//logPrintfAsync("Couldn't get system info...\n");
 			break;
 		}
 	}
@@ -92,6 +93,6 @@ Any SystemInfo::toAny(const bool forceAll) const {
 
 void SystemInfo::printToLog() {
 	// Print system info to log
-	logPrintf("\n-------------------\nSystem Info:\n-------------------\n\tHostname: %s\n\tUsername: %s\n\tProcessor: %s\n\tCore Count: %d\n\tMemory: %dMB\n\tGPU: %s\n\tDisplay: %s\n\tDisplay Resolution: %d x %d (px)\n\tDisplay Size: %d x %d (mm)\n\n",
+	logPrintfAsync("\n-------------------\nSystem Info:\n-------------------\n\tHostname: %s\n\tUsername: %s\n\tProcessor: %s\n\tCore Count: %d\n\tMemory: %dMB\n\tGPU: %s\n\tDisplay: %s\n\tDisplay Resolution: %d x %d (px)\n\tDisplay Size: %d x %d (mm)\n\n",
 		hostName, userName, cpuName, coreCount, memCapacityMB, gpuName, displayName, displayXRes, displayYRes, displayXSize, displayYSize);
 }
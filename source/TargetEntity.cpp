@@ -125,10 +125,10 @@ Any TargetConfig::toAny(const bool forceAll) const {
 
 // Find an arbitrary vector perpendicular to and in equal length as inputV.
 // The sampling distribution is uniform along the circular line, the set of possible candidates of a perpendicular vector.,
-Point3 findPerpendicularVector(Point3 inputV) { // Note that the output vector has equal length as the input vector.
+Point3 findPerpendicularVector(Point3 inputV, RandomStream& rng) { // Note that the output vector has equal length as the input vector.
 	Point3 perpen;
 	while (true) {
-		Point3 r = Point3::random();
+		Point3 r = rng.direction();
 		if (r.dot(inputV) > 0.1) { // avoid r being sharply aligned with the position vector
 			// calculate a perpendicular vector
 			perpen = r.cross(inputV.direction()) * inputV.length();
@@ -164,7 +164,7 @@ shared_ptr<TargetEntity> TargetEntity::create(
 }
 
 shared_ptr<TargetEntity> TargetEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
@@ -180,17 +180,43 @@ shared_ptr<TargetEntity> TargetEntity::create(
 	return target;
 }
 
-void TargetEntity::drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, Point2 size, Point3 offset, Point2 border, Array<Color4> colors, Color4 borderColor) const
+void TargetEntity::formatLogName(const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	va_list sizeArgs;
+	va_copy(sizeArgs, args);
+	const int length = vsnprintf(nullptr, 0, fmt, sizeArgs);
+	va_end(sizeArgs);
+	m_logName.resize(max(length, 0));
+	if (length > 0) vsnprintf(&m_logName[0], length + 1, fmt, args);
+	va_end(args);
+}
+
+void TargetEntity::reuse(
+	shared_ptr<const TargetConfig>		config,
+	const shared_ptr<Model>&		model,
+	const Point3&					offset,
+	int								scaleIdx,
+	int								paramIdx)
+{
+	reset();
+	setModel(model);
+	setFrame(CFrame(config->destinations[0].position));
+	TargetEntity::init(config->destinations, paramIdx, offset, config->respawnCount, scaleIdx, config->logTargetTrajectory);
+	m_id = config->id;
+}
+
+void TargetEntity::drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, const Point3& position, float health, Point2 size, Point3 offset, Point2 border, const Array<Color4>& colors, Color4 borderColor)
 {
 	// Abort if the target is not in front of the camera 
-	Vector3 diffVector = frame().translation - camera.frame().translation;
+	Vector3 diffVector = position - camera.frame().translation;
 	if (camera.frame().lookRay().direction().dot(diffVector) < 0.0f) {
 		return;
 	}
 
 	// Project entity position into image space
 	Rect2D viewport = Rect2D(framebuffer.vector2Bounds());
-	Point3 hudPoint = camera.project(frame().translation, viewport);
+	Point3 hudPoint = camera.project(position, viewport);
 
 	// Abort if the target is not in the view frustum
 	if (hudPoint == Point3::inf()) {
@@ -199,13 +225,13 @@ void TargetEntity::drawHealthBar(RenderDevice* rd, const Camera& camera, const F
 	hudPoint += offset;		// Apply offset in pixels
 
 	// Draws a bar
-	const Color4 color = colors[1]*(1.0f-m_health) + colors[0]*m_health;
+	const Color4 color = colors[1]*(1.0f-health) + colors[0]*health;
 
 	Draw::rect2D(
 		Rect2D::xywh(hudPoint.xy() - size * 0.5f - border, size + border + border), rd, borderColor
 	);
 	Draw::rect2D(
-		Rect2D::xywh(hudPoint.xy() - size * 0.5f, size*Point2(m_health, 1.0f)), rd, color
+		Rect2D::xywh(hudPoint.xy() - size * 0.5f, size*Point2(health, 1.0f)), rd, color
 	);
 
 }
@@ -216,7 +242,7 @@ void TargetEntity::setDestinations(const Array<Destination> destinationArray) {
 
 void TargetEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 	// Check whether we have any destinations yet...
-	if (m_destinations.size() < 2)
+	if (m_frozen || m_destinations.size() < 2)
 		return;
 
 	if (m_spawnTime == 0) m_spawnTime = absoluteTime;
@@ -299,21 +325,42 @@ shared_ptr<FlyingEntity> FlyingEntity::create(
 }
 
 shared_ptr<FlyingEntity> FlyingEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
 	const Point3&					orbitCenter,
 	int								scaleIdx,
-	int								paramIdx)
+	int								paramIdx,
+	const RandomStream&				rng)
 {
 	// Don't initialize in the constructor, where it is unsafe to throw Any parse exceptions
 	const shared_ptr<FlyingEntity>& flyingEntity = createShared<FlyingEntity>();
+	flyingEntity->m_rng = rng;
 
 	// Initialize each base class, which parses its own fields
 	flyingEntity->Entity::init(name, scene, CFrame(), shared_ptr<Entity::Track>(), true, true);
 	flyingEntity->VisibleEntity::init(model, true, Surface::ExpressiveLightScatteringProperties(), ArticulatedModel::PoseSpline());
-	flyingEntity->FlyingEntity::init(
+	flyingEntity->FlyingEntity::init(config, orbitCenter, scaleIdx, paramIdx);
+	return flyingEntity;
+}
+
+void FlyingEntity::reuse(
+	shared_ptr<const TargetConfig>		config,
+	const shared_ptr<Model>&		model,
+	const Point3&					orbitCenter,
+	int								scaleIdx,
+	int								paramIdx,
+	const RandomStream&				rng)
+{
+	reset();
+	m_rng = rng;
+	setModel(model);
+	FlyingEntity::init(config, orbitCenter, scaleIdx, paramIdx);
+}
+
+void FlyingEntity::init(shared_ptr<const TargetConfig> config, const Point3& orbitCenter, int scaleIdx, int paramIdx) {
+	init(
 		{ config->speed[0], config->speed[1] }, 
 		{ config->motionChangePeriod[0], config->motionChangePeriod[1] },
 		config->upperHemisphereOnly, 
@@ -323,8 +370,7 @@ shared_ptr<FlyingEntity> FlyingEntity::create(
 		config->respawnCount, 
 		scaleIdx, 
 		config->logTargetTrajectory);
-	flyingEntity->m_id = config->id;
-	return flyingEntity;
+	m_id = config->id;
 }
 
 
@@ -387,6 +433,7 @@ Any FlyingEntity::toAny(const bool forceAll) const {
 
 void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 	// Do not call Entity::onSimulation; that will override with spline animation
+	if (m_frozen) return;
 
 	if (!(isNaN(deltaTime) || (deltaTime == 0))) { // first frame?
 		m_previousFrame = m_frame;
@@ -400,11 +447,11 @@ void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		// Check for change in direction
 		if (absoluteTime > m_nextChangeTime) {
 			// Update the next change time
-			float motionChangeTime = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+			float motionChangeTime = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			m_nextChangeTime = absoluteTime + motionChangeTime;
 			// Velocity to use for this next interval
-			float vel = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
-			Point3 destination = m_bounds.randomInteriorPoint();
+			float vel = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+			Point3 destination = m_rng.interiorPoint(m_bounds);
 			if (m_axisLocks[0]) {
 				destination.x = pos.x;
 			}
@@ -455,8 +502,8 @@ void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		while ((deltaTime > 0.000001f) && m_angularSpeedRange[0] > 0.0f) {
 			if (m_destinationPoints.empty()) {
 				// Add destimation points if no destination points.
-				float motionChangePeriod = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
-				float angularSpeed = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+				float motionChangePeriod = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+				float angularSpeed = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
 				float angularDistance = motionChangePeriod * angularSpeed;
 				angularDistance = angularDistance > 170.f ? 170.0f : angularDistance; // replace with 170 deg if larger than 170.
 
@@ -467,7 +514,7 @@ void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 				// relative position to orbit center
 				Point3 relPos = m_frame.translation - m_orbitCenter;
 				// find a vector perpendicular to the current position
-				Point3 perpen = findPerpendicularVector(relPos);
+				Point3 perpen = findPerpendicularVector(relPos, m_rng);
 				// calculate destination point
 				Point3 dest = m_orbitCenter + rotateToward(relPos, perpen, angularDistance);
 				// add destination point.
@@ -567,22 +614,45 @@ shared_ptr<Entity> JumpingEntity::create(
 }
 
 shared_ptr<JumpingEntity> JumpingEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
 	int								scaleIdx,
 	const Point3&					orbitCenter,
 	float							targetDistance,
-	int								paramIdx)
+	int								paramIdx,
+	const RandomStream&				rng)
 {
 	// Don't initialize in the constructor, where it is unsafe to throw Any parse exceptions
 	const shared_ptr<JumpingEntity>& jumpingEntity = createShared<JumpingEntity>();
+	jumpingEntity->m_rng = rng;				// Set before init() (which draws the initial motion)
 
 	// Initialize each base class, which parses its own fields
 	jumpingEntity->Entity::init(name, scene, CFrame(), shared_ptr<Entity::Track>(), true, true);
 	jumpingEntity->VisibleEntity::init(model, true, Surface::ExpressiveLightScatteringProperties(), ArticulatedModel::PoseSpline());
-	jumpingEntity->JumpingEntity::init(
+	jumpingEntity->JumpingEntity::init(config, scaleIdx, orbitCenter, targetDistance, paramIdx);
+
+	return jumpingEntity;
+}
+
+void JumpingEntity::reuse(
+	shared_ptr<const TargetConfig>		config,
+	const shared_ptr<Model>&		model,
+	int								scaleIdx,
+	const Point3&					orbitCenter,
+	float							targetDistance,
+	int								paramIdx,
+	const RandomStream&				rng)
+{
+	reset();
+	m_rng = rng;							// Set before init() (which draws the initial motion)
+	setModel(model);
+	JumpingEntity::init(config, scaleIdx, orbitCenter, targetDistance, paramIdx);
+}
+
+void JumpingEntity::init(shared_ptr<const TargetConfig> config, int scaleIdx, const Point3& orbitCenter, float targetDistance, int paramIdx) {
+	init(
 		{ config->speed[0], config->speed[1] },
 		{ config->motionChangePeriod[0], config->motionChangePeriod[1] },
 		{ config->jumpPeriod[0], config->jumpPeriod[1] },
@@ -596,9 +666,7 @@ shared_ptr<JumpingEntity> JumpingEntity::create(
 		config->respawnCount,
 		scaleIdx,
 		config->logTargetTrajectory);
-	jumpingEntity->m_id = config->id;
-
-	return jumpingEntity;
+	m_id = config->id;
 }
 
 
@@ -642,9 +710,9 @@ void JumpingEntity::init(
 		m_axisLocks[i] = axisLock[i];
 	}
 	m_orbitRadius = orbitRadius;
-	float angularSpeed = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+	float angularSpeed = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
 	m_planarSpeedGoal = m_orbitRadius * (angularSpeed * pif() / 180.0f);
-	if (Random::common().uniform() > 0.5f) {
+	if (m_rng.uniform() > 0.5f) {
 		m_planarSpeedGoal = -m_planarSpeedGoal;
 	}
 	// [m/s] = [m/radians] * [radians/s]
@@ -652,8 +720,8 @@ void JumpingEntity::init(
 	m_speed.y = 0.0f;
 
 	m_inJump = false;
-	m_motionChangeTimer = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
-	m_jumpTimer = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+	m_motionChangeTimer = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+	m_jumpTimer = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 }
 
 Any JumpingEntity::toAny(const bool forceAll) const {
@@ -664,6 +732,7 @@ Any JumpingEntity::toAny(const bool forceAll) const {
 
 void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 	// Do not call Entity::onSimulation; that will override with spline animation
+	if (m_frozen) return;
 
 	if (!(isNaN(deltaTime) || (deltaTime == 0))) {
 		m_previousFrame = m_frame;
@@ -675,8 +744,8 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		m_simulatedPos = m_frame.translation;
 		m_standingHeight = m_frame.translation.y;
 		m_isFirstFrame = false;
-		m_acc.y = -Random::common().uniform(m_gravityRange[0], m_gravityRange[1]);
-		m_jumpSpeed = Random::common().uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
+		m_acc.y = -m_rng.uniform(m_gravityRange[0], m_gravityRange[1]);
+		m_jumpSpeed = m_rng.uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
 	}
 
 	if (m_worldSpace) {
@@ -685,11 +754,11 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		// Check for time for motion (direction) change
 		if (absoluteTime > m_nextChangeTime) {
 			// Update the next change time
-			float motionChangeTime = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+			float motionChangeTime = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			m_nextChangeTime = absoluteTime + motionChangeTime;
 			// Velocity to use for this next interval
-			float vel = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
-			Point3 destination = m_moveBounds.randomInteriorPoint();
+			float vel = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+			Point3 destination = m_rng.interiorPoint(m_moveBounds);
 			if (m_axisLocks[0]) {
 				destination.x = frame().translation.x;
 			}
@@ -737,7 +806,7 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 				m_jumpTime = 0;
 				pos.y = m_standingHeight;		// Reset to the original height
 				// Schedule the next jump here
-				float nextJump = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+				float nextJump = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 				m_nextJumpTime = absoluteTime + nextJump;
 			}
 			else {
@@ -821,7 +890,7 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 
 			/// Update motion state (includes updating acceleration)
 			if (t == m_motionChangeTimer) { // changing motion direction
-				float new_AngularSpeedGoal = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+				float new_AngularSpeedGoal = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
 				float new_planarSpeedGoal = m_orbitRadius * (new_AngularSpeedGoal * pif() / 180.0f);
 				// change direction
 				if (m_planarSpeedGoal > 0) {
@@ -835,7 +904,7 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 				else { // if not in jump, immediately apply direction change
 					m_speed.x = m_planarSpeedGoal;
 				}
-				m_motionChangeTimer = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+				m_motionChangeTimer = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			}
 			if (t == nextJumpStateChange) { // either starting or finishing jump
 				if (m_inJump) { // finishing jump
@@ -843,13 +912,13 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 					m_acc.y = 0; // remove gravity effect
 					m_speed.x = m_planarSpeedGoal; // instantly gain the running speed. (general behavior in games)
 					m_inJump = false;
-					m_jumpTimer = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+					m_jumpTimer = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 				}
 				else { // starting jump
 					m_acc.x = sign(m_planarSpeedGoal) * m_planarAcc;
-					float gravity = -Random::common().uniform(m_gravityRange[0], m_gravityRange[1]);
-					float jumpSpeed = Random::common().uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
-					float distance = Random::common().uniform(m_distanceRange[0], m_distanceRange[1]);
+					float gravity = -m_rng.uniform(m_gravityRange[0], m_gravityRange[1]);
+					float jumpSpeed = m_rng.uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
+					float distance = m_rng.uniform(m_distanceRange[0], m_distanceRange[1]);
 					m_acc.y = gravity * m_orbitRadius / distance;
 					m_speed.y = jumpSpeed * m_orbitRadius / distance;
 					m_planarAcc = m_acc.y / 3.f;
@@ -1,5 +1,7 @@
 #pragma once
 #include <G3D/G3D.h>
+#include "RandomStream.h"
+#include "TargetRegistry.h"
 
 struct Destination {
 public:
@@ -128,6 +130,10 @@ protected:
 	float m_hitSoundVol;							///< Volume to play hit sound at
 	shared_ptr<Sound> m_destroyedSound;				///< Sound to play when destroyed
 	float m_destroyedSoundVol;						///< Volume to play destroyed sound at
+	RandomStream m_rng;								///< This target's random stream (for its motion and respawn positions)
+	String m_logName;								///< Name to log this spawn as (pooled targets keep their entity name across spawns)
+	TargetHandle m_handle;							///< Handle in the session's target registry (invalid when not spawned)
+	bool m_frozen = false;							///< Skip simulation (while pooled or pre-spawned)
 
 	// Only used for flying/jumping entities
 	SimTime m_nextChangeTime = 0;
@@ -147,7 +153,7 @@ public:
 	);
 
 	static shared_ptr<TargetEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
@@ -162,10 +168,37 @@ public:
 		m_paramIdx = paramIdx;
 		m_scaleIdx = scaleIdx;
 		m_isLogged = isLogged;
+		m_destinations = dests;
 		destinationIdx = 0;
 	}
 
-	void setColor(const Color3& color) {
+	/** Re-initialize a (pooled) target for a new spawn from the config (see create()) */
+	void reuse(
+		shared_ptr<const TargetConfig>	config,
+		const shared_ptr<Model>&		model,
+		const Point3&					offset,
+		int								scaleIdx,
+		int								paramIdx
+	);
+
+	/** Reset the per-spawn state (health, motion, path progress) so the entity can be reused */
+	virtual void reset() {
+		m_health = 1.0f;
+		m_spawnTime = 0;
+		m_destinations.fastClear();
+		destinationIdx = 0;
+		m_offset = Point3::zero();
+		m_canHit = true;
+		m_worldSpace = false;
+		m_logName.clear();							// Keeps its storage (for the next spawn's log name)
+		m_frozen = false;
+		m_rng = RandomStream();
+		m_nextChangeTime = 0;
+		m_velocity = Vector3::zero();
+	}
+
+	/** Create a pose that colors the target (poses are never modified in place, so they can be shared between targets) */
+	static shared_ptr<ArticulatedModel::Pose> colorPose(const Color3& color) {
 		UniversalMaterial::Specification materialSpecification;
 		materialSpecification.setLambertian(Texture::Specification(color));
 		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
@@ -173,11 +206,19 @@ public:
 
 		const shared_ptr<ArticulatedModel::Pose>& amPose = ArticulatedModel::Pose::create();
 		amPose->materialTable.set("core/icosahedron_default", UniversalMaterial::create(materialSpecification));
-		setPose(amPose);
+		return amPose;
 	}
 
+	void setColor(const Color3& color) { setPose(colorPose(color)); }
+
+	void setLogName(const String& name) { m_logName = name; }
+	/** Set the log name from a printf-style format, reusing the (pooled) target's existing name storage */
+	void formatLogName(const char* fmt, ...);
+
 	void setWorldSpace(bool worldSpace) { m_worldSpace = worldSpace; }
 	void setCanHit(bool active) { m_canHit = active; }
+	/** Stop (or resume) simulating the target, motion starts from its current frame when resumed */
+	void setFrozen(bool frozen) { m_frozen = frozen; }
 
 	/** Attaches an existing sound from `soundTable` or creates the sound, adds it to `soundTable` and attaches it */
 	void setHitSound(const String& hitSoundFilename, Table<String, shared_ptr<Sound>>& soundTable, float hitSoundVol = 1.0f) {
@@ -245,6 +286,8 @@ public:
 	
 	/** Get the target ID */
 	const String& id() const { return m_id; }
+	/** Name to log this target as (its entity name unless set) */
+	const String& logName() const { return m_logName.empty() ? name() : m_logName; }
 	/** Getter for scale index */
 	int scaleIndex() const { return m_scaleIdx; }
 	/** Getter for logging */
@@ -263,8 +306,19 @@ public:
 	int paramIdx() const { return m_paramIdx; }
 	/** Getter for active/can hit */
 	bool canHit() const { return m_canHit; }
-
-	void drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, Point2 size, Point3 offset, Point2 border, Array<Color4> colors, Color4 borderColor) const;
+	/** Is simulation of the target stopped (see setFrozen())? */
+	bool frozen() const { return m_frozen; }
+	/** Handle in the session's target registry */
+	const TargetHandle& handle() const { return m_handle; }
+	void setHandle(const TargetHandle& handle) { m_handle = handle; }
+	/** This target's random stream */
+	RandomStream& rng() { return m_rng; }
+
+	void drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, Point2 size, Point3 offset, Point2 border, Array<Color4> colors, Color4 borderColor) const {
+		drawHealthBar(rd, camera, framebuffer, frame().translation, m_health, size, offset, border, colors, borderColor);
+	}
+	/** Draw a health bar for a target at position w/ the given health (e.g. from a delayed state snapshot) */
+	static void drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, const Point3& position, float health, Point2 size, Point3 offset, Point2 border, const Array<Color4>& colors, Color4 borderColor);
 	virtual void onSimulation(SimTime absoluteTime, SimTime deltaTime) override;
 	void setDestinations(const Array<Destination> destinationArray);
 
@@ -297,12 +351,31 @@ protected:
 
 	void init(Vector2 angularSpeedRange, Vector2 motionChangePeriodRange, bool upperHemisphereOnly, Point3 orbitCenter, int paramIdx, Array<bool> axisLock, int respawns = 0, int scaleIdx=0, bool isLogged=true);
 
+	void init(shared_ptr<const TargetConfig> config, const Point3& orbitCenter, int scaleIdx, int paramIdx);
+
 public:
 	bool tryRespawn() {
 		m_destinationPoints.fastClear();				// clear all destination points
 		return TargetEntity::tryRespawn();
 	}
 
+	void reset() override {
+		TargetEntity::reset();
+		m_destinationPoints.fastClear();
+		m_speed = 0.0f;
+		m_bounds = AABox();
+	}
+
+	/** Re-initialize a (pooled) target for a new spawn from the config (see create()) */
+	void reuse(
+		shared_ptr<const TargetConfig>	config,
+		const shared_ptr<Model>&		model,
+		const Point3&					orbitCenter,
+		int								scaleIdx,
+		int								paramIdx,
+		const RandomStream&				rng = RandomStream()
+	);
+
     /** Destinations must be no more than 170 degrees apart to avoid ambiguity in movement direction */
     void setDestinations(const Array<Point3>& destinationArray, const Point3 orbitCenter);
 
@@ -332,13 +405,14 @@ public:
 	);
 
 	static shared_ptr<FlyingEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
 		const Point3&					orbitCenter,
 		int								scaleIdx,
-		int								paramIdx
+		int								paramIdx,
+		const RandomStream&				rng = RandomStream()
 	);
 
 	/** Converts the current VisibleEntity to an Any.  Subclasses should
@@ -413,6 +487,7 @@ protected:
 		int scaleIdx=0,
 		bool isLogged=true
 	);
+	void init(shared_ptr<const TargetConfig> config, int scaleIdx, const Point3& orbitCenter, float targetDistance, int paramIdx);
 
 public:
 	bool tryRespawn() {
@@ -420,6 +495,25 @@ public:
 		return TargetEntity::tryRespawn();
 	}
 
+	void reset() override {
+		TargetEntity::reset();
+		m_isFirstFrame = true;
+		m_inJump = false;
+		m_nextJumpTime = 0;
+		m_moveBounds = AABox();
+	}
+
+	/** Re-initialize a (pooled) target for a new spawn from the config (see create()) */
+	void reuse(
+		shared_ptr<const TargetConfig>	config,
+		const shared_ptr<Model>&		model,
+		int								scaleIdx,
+		const Point3&					orbitCenter,
+		float							targetDistance,
+		int								paramIdx,
+		const RandomStream&				rng = RandomStream()
+	);
+
 	void setMoveBounds(AABox bounds) { m_moveBounds = bounds; }
 
 	/** For deserialization from Any / loading from file */
@@ -433,14 +527,15 @@ public:
 
 	/** For programmatic construction at runtime */
 	static shared_ptr<JumpingEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
 		int								scaleIdx,
 		const Point3&					orbitCenter,
 		float							targetDistance,
-		int								paramIdx
+		int								paramIdx,
+		const RandomStream&				rng = RandomStream()
 	);
 
 	/** Converts the current VisibleEntity to an Any.  Subclasses should
@@ -0,0 +1,53 @@
+#include "TargetPool.h"
+#include "TargetEntity.h"
+
+void TargetPool::setScene(Scene* scene) {
+	if (scene != m_scene) clear();
+	m_scene = scene;
+}
+
+shared_ptr<TargetEntity> TargetPool::acquire(const String& configId) {
+	Array<shared_ptr<TargetEntity>>* free = m_free.getPointer(configId);
+	if (isNull(free) || free->size() == 0) {
+		if (m_prewarming) m_prewarmed++;
+		else m_created++;
+		return nullptr;
+	}
+	const shared_ptr<TargetEntity> target = free->pop();
+	target->setVisible(true);
+	if (!m_prewarming) m_reused++;
+	return target;
+}
+
+void TargetPool::add(const shared_ptr<TargetEntity>& target) {
+	target->setShouldBeSaved(false);
+	m_targets.append(target);
+	m_scene->insert(target);
+}
+
+void TargetPool::release(const shared_ptr<TargetEntity>& target) {
+	target->setVisible(false);
+	target->setCanHit(false);
+	target->setFrozen(true);			// Idle targets don't need simulating
+	m_free.getCreate(target->id()).append(target);
+}
+
+void TargetPool::clear() {
+	if (notNull(m_scene)) {
+		for (const shared_ptr<TargetEntity>& target : m_targets) {
+			m_scene->removeEntity(target->name());
+		}
+	}
+	m_targets.fastClear();
+	m_free.clear();
+}
+
+const shared_ptr<ArticulatedModel::Pose>& TargetPool::pose(const Color3& color) {
+	int idx = m_colors.findIndex(color);
+	if (idx < 0) {
+		idx = m_colors.size();
+		m_colors.append(color);
+		m_poses.append(TargetEntity::colorPose(color));
+	}
+	return m_poses[idx];
+}
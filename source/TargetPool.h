@@ -0,0 +1,50 @@
+#pragma once
+#include <G3D/G3D.h>
+
+class TargetEntity;
+
+/** Target entities kept for reuse (by target config id), so spawning and destroying targets during a session doesn't
+	allocate entities or change the scene graph
+
+	Released targets stay in the scene, hidden and unhittable, until a later spawn w/ the same config re-initializes
+	them (see the TargetEntity reuse() methods). Targets are only removed from the scene by clear().
+*/
+class TargetPool {
+protected:
+	Scene*									m_scene = nullptr;
+	Table<String, Array<shared_ptr<TargetEntity>>>	m_free;			///< Released targets (by config id)
+	Array<shared_ptr<TargetEntity>>			m_targets;				///< All pooled targets (all are in the scene)
+	Array<Color3>							m_colors;
+	Array<shared_ptr<ArticulatedModel::Pose>>	m_poses;			///< Shared target poses (by color in m_colors)
+	int										m_reused = 0;			///< Spawns that reused a pooled target
+	int										m_created = 0;			///< Spawns that had to create a new target
+	int										m_prewarmed = 0;		///< Targets created to prewarm the pool (not counted as spawns)
+	bool									m_prewarming = false;	///< Count acquire() misses as prewarmed targets?
+
+public:
+	/** Set the scene targets are (and will be) inserted into, clears the pool if it changes */
+	void setScene(Scene* scene);
+
+	/** Get a released target for the config (or nullptr if there are none, create one and add() it) */
+	shared_ptr<TargetEntity> acquire(const String& configId);
+
+	/** Add a newly created target to the pool (and the scene) */
+	void add(const shared_ptr<TargetEntity>& target);
+
+	/** Hide the target and keep it for reuse */
+	void release(const shared_ptr<TargetEntity>& target);
+
+	/** Count targets created from here on as prewarming the pool (rather than as spawns) */
+	void setPrewarming(bool prewarming) { m_prewarming = prewarming; }
+
+	/** Remove all pooled targets from the scene */
+	void clear();
+
+	/** Shared pose for the color (created the first time it's used) */
+	const shared_ptr<ArticulatedModel::Pose>& pose(const Color3& color);
+
+	int size() const { return m_targets.size(); }
+	int reused() const { return m_reused; }
+	int created() const { return m_created; }
+	int prewarmed() const { return m_prewarmed; }
+};
@@ -0,0 +1,139 @@
+#include "TargetRegistry.h"
+#include "TargetEntity.h"
+
+const TargetRegistry::Slot* TargetRegistry::find(const TargetHandle& handle) const {
+	if (handle.slot < 0 || handle.slot >= m_slots.size()) return nullptr;
+	const Slot& slot = m_slots[handle.slot];
+	if (isNull(slot.target) || slot.generation != handle.generation) return nullptr;
+	return &slot;
+}
+
+void TargetRegistry::insertInSet(int slot) {
+	Slot& s = m_slots[slot];
+	if (active(s.flags)) {
+		s.setIdx = m_hittable.size();
+		m_hittable.append(s.target);
+		m_hittableSlots.append(slot);
+	}
+	else {
+		s.setIdx = m_inactive.size();
+		m_inactive.append(s.target);
+		m_inactiveSlots.append(slot);
+	}
+}
+
+void TargetRegistry::removeFromSet(int slot) {
+	Slot& s = m_slots[slot];
+	Array<int>& slots = active(s.flags) ? m_hittableSlots : m_inactiveSlots;
+	// Move the last target into the removed target's place
+	const int last = slots.last();
+	m_slots[last].setIdx = s.setIdx;
+	slots.fastRemove(s.setIdx);
+	if (active(s.flags)) m_hittable.fastRemove(s.setIdx);
+	else m_inactive.fastRemove(s.setIdx);
+	s.setIdx = -1;
+}
+
+TargetHandle TargetRegistry::add(const shared_ptr<TargetEntity>& target, uint8 flags) {
+	int slot;
+	if (m_freeSlots.size() > 0) {
+		slot = m_freeSlots.pop();
+	}
+	else {
+		slot = m_slots.size();
+		m_slots.next();
+	}
+	Slot& s = m_slots[slot];
+	s.target = target;
+	s.flags = flags;
+	s.allIdx = m_all.size();
+	m_all.append(target);
+	m_allSlots.append(slot);
+	insertInSet(slot);
+
+	TargetHandle handle;
+	handle.slot = slot;
+	handle.generation = s.generation;
+	target->setHandle(handle);
+	target->setCanHit((flags & Hittable) != 0);
+	target->setVisible((flags & Visible) != 0);
+	return handle;
+}
+
+bool TargetRegistry::remove(const TargetHandle& handle) {
+	if (isNull(find(handle))) return false;
+	const int slot = handle.slot;
+	Slot& s = m_slots[slot];
+	removeFromSet(slot);
+	const int last = m_allSlots.last();
+	m_slots[last].allIdx = s.allIdx;
+	m_allSlots.fastRemove(s.allIdx);
+	m_all.fastRemove(s.allIdx);
+
+	s.target->setHandle(TargetHandle());
+	s.target.reset();
+	s.allIdx = -1;
+	s.generation++;					// Invalidate outstanding handles to this slot
+	m_freeSlots.append(slot);
+	return true;
+}
+
+bool TargetRegistry::remove(const shared_ptr<TargetEntity>& target) {
+	const TargetHandle& handle = target->handle();
+	const Slot* slot = find(handle);
+	if (isNull(slot) || slot->target != target) return false;
+	return remove(handle);
+}
+
+void TargetRegistry::clear() {
+	for (const shared_ptr<TargetEntity>& target : m_all) {
+		target->setHandle(TargetHandle());
+	}
+	for (Slot& slot : m_slots) {
+		if (notNull(slot.target)) slot.generation++;
+		slot.target.reset();
+	}
+	m_freeSlots.fastClear();
+	for (int i = m_slots.size() - 1; i >= 0; i--) {
+		m_freeSlots.append(i);
+	}
+	m_all.fastClear();
+	m_allSlots.fastClear();
+	m_hittable.fastClear();
+	m_hittableSlots.fastClear();
+	m_inactive.fastClear();
+	m_inactiveSlots.fastClear();
+}
+
+shared_ptr<TargetEntity> TargetRegistry::get(const TargetHandle& handle) const {
+	const Slot* slot = find(handle);
+	return notNull(slot) ? slot->target : nullptr;
+}
+
+uint8 TargetRegistry::flags(const TargetHandle& handle) const {
+	const Slot* slot = find(handle);
+	return notNull(slot) ? slot->flags : 0;
+}
+
+void TargetRegistry::setFlags(const TargetHandle& handle, uint8 flags) {
+	if (isNull(find(handle))) return;
+	Slot& s = m_slots[handle.slot];
+	if (active(s.flags) != active(flags)) {
+		removeFromSet(handle.slot);
+		s.flags = flags;
+		insertInSet(handle.slot);
+	}
+	s.flags = flags;
+	s.target->setCanHit((flags & Hittable) != 0);
+	s.target->setVisible((flags & Visible) != 0);
+}
+
+void TargetRegistry::setHittable(const TargetHandle& handle, bool hittable) {
+	const uint8 f = flags(handle);
+	setFlags(handle, hittable ? (uint8)(f | Hittable) : (uint8)(f & ~Hittable));
+}
+
+void TargetRegistry::setVisible(const TargetHandle& handle, bool visible) {
+	const uint8 f = flags(handle);
+	setFlags(handle, visible ? (uint8)(f | Visible) : (uint8)(f & ~Visible));
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <G3D/G3D.h>
+
+class TargetEntity;
+
+/** Stable handle to a target in a TargetRegistry (a removed target's handle never refers to another target) */
+struct TargetHandle {
+	int		slot = -1;
+	uint32	generation = 0;
+
+	bool valid() const { return slot >= 0; }
+	bool operator==(const TargetHandle& other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const TargetHandle& other) const { return !(*this == other); }
+};
+
+/** The session's spawned targets, stored as a slot map
+
+	Each target gets a stable handle (also stored on the target) and a set of flags. Targets are kept in contiguous arrays
+	(all targets, hittable targets, and inactive targets to exclude from scene ray casts) that can be iterated w/o
+	copying, adding/removing a target or changing its flags is O(1) (array order changes on removal).
+*/
+class TargetRegistry {
+public:
+	enum Flags : uint8 {
+		Hittable	= 1 << 0,			///< Can be hit (while visible)
+		Logged		= 1 << 1,			///< Trajectory is logged
+		Visible		= 1 << 2
+	};
+
+protected:
+	struct Slot {
+		shared_ptr<TargetEntity>	target;						///< Target (null if the slot is free)
+		uint32						generation = 0;				///< Incremented each time the slot is freed
+		uint8						flags = 0;
+		int							allIdx = -1;				///< Index in m_all
+		int							setIdx = -1;				///< Index in m_hittable or m_inactive (see active())
+	};
+
+	Array<Slot>							m_slots;
+	Array<int>							m_freeSlots;
+	Array<shared_ptr<TargetEntity>>		m_all;
+	Array<int>							m_allSlots;				///< Slot of each target in m_all
+	Array<shared_ptr<TargetEntity>>		m_hittable;
+	Array<int>							m_hittableSlots;
+	Array<shared_ptr<Entity>>			m_inactive;				///< Targets that can't be hit (or aren't visible)
+	Array<int>							m_inactiveSlots;
+
+	static bool active(uint8 flags) { return (flags & Hittable) && (flags & Visible); }
+	const Slot* find(const TargetHandle& handle) const;
+	/** Add the slot to the hittable or inactive array (based on its flags) */
+	void insertInSet(int slot);
+	void removeFromSet(int slot);
+
+public:
+	/** Add a target w/ the given flags (applied to the target), returns its handle (also set on the target) */
+	TargetHandle add(const shared_ptr<TargetEntity>& target, uint8 flags);
+
+	/** Remove a target, returns false if it isn't in the registry */
+	bool remove(const TargetHandle& handle);
+	bool remove(const shared_ptr<TargetEntity>& target);
+
+	/** Remove all targets */
+	void clear();
+
+	/** Is the handle for a target in the registry? */
+	bool contains(const TargetHandle& handle) const { return notNull(find(handle)); }
+	/** Get a target from its handle (or nullptr if it was removed) */
+	shared_ptr<TargetEntity> get(const TargetHandle& handle) const;
+
+	uint8 flags(const TargetHandle& handle) const;
+	bool hasFlags(const TargetHandle& handle, uint8 flags) const { return (this->flags(handle) & flags) == flags; }
+	/** Replace a target's flags (and update the target's hittable/visible state to match) */
+	void setFlags(const TargetHandle& handle, uint8 flags);
+	void setHittable(const TargetHandle& handle, bool hittable);
+	void setVisible(const TargetHandle& handle, bool visible);
+
+	/** All targets (in the order they were added, until one is removed) */
+	const Array<shared_ptr<TargetEntity>>& all() const { return m_all; }
+	/** Targets that are visible and can be hit */
+	const Array<shared_ptr<TargetEntity>>& hittable() const { return m_hittable; }
+	/** Targets that can't be hit or aren't visible (for excluding them from scene ray casts) */
+	const Array<shared_ptr<Entity>>& inactive() const { return m_inactive; }
+
+	int size() const { return m_all.size(); }
+};
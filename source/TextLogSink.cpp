@@ -0,0 +1,137 @@
+#include "TextLogSink.h"
+#include "Logger.h"
+#include "ThreadPolicy.h"
+#include <io.h>
+
+TextLogSink::TextLogSink() : m_writePos(0), m_readPos(0), m_running(false) {
+	m_ring = new Slot[RingSize];
+	for (int i = 0; i < RingSize; i++) {
+		m_ring[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+TextLogSink::~TextLogSink() {
+	stop();
+	delete[] m_ring;
+}
+
+TextLogSink& TextLogSink::common() {
+	static TextLogSink sink;
+	return sink;
+}
+
+String TextLogSink::formatRecord(const String& text, const FILETIME& time, uint32 threadId) {
+	return format("[%s][%5u] ", FPSciLogger::formatFileTime(time).c_str(), threadId) + text;
+}
+
+bool TextLogSink::tryPush(const String& text, const FILETIME& time, uint32 threadId) {
+	// Bounded multi-producer handoff, each slot's sequence number tells producers/the consumer whose turn it is
+	uint64 pos = m_writePos.load(std::memory_order_relaxed);
+	Slot* slot;
+	for (;;) {
+		slot = &m_ring[pos & (RingSize - 1)];
+		const uint64 seq = slot->sequence.load(std::memory_order_acquire);
+		const int64 diff = (int64)seq - (int64)pos;
+		if (diff == 0) {
+			if (m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		}
+		else if (diff < 0) {
+			return false;				// Ring is full
+		}
+		else {
+			pos = m_writePos.load(std::memory_order_relaxed);
+		}
+	}
+	slot->time = time;
+	slot->threadId = threadId;
+	slot->text = text;
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+int TextLogSink::drain(FILE* f) {
+	int count = 0;
+	uint64 pos = m_readPos.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = m_ring[pos & (RingSize - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;		// Nothing more published
+		const String line = formatRecord(slot.text, slot.time, slot.threadId);
+		slot.text = "";
+		slot.sequence.store(pos + RingSize, std::memory_order_release);			// Hand the slot back to producers
+		m_readPos.store(++pos, std::memory_order_relaxed);
+		fputs(line.c_str(), f);
+		count++;
+	}
+	if (count > 0) fflush(f);
+	return count;
+}
+
+void TextLogSink::drainThreadEntry() {
+	ThreadPolicy::applyRole("helper", "TextLogSink");
+	FILE* f = Log::common()->getFile();
+	RealTime lastSync = System::time();
+	bool unsynced = false;
+	while (m_running) {
+		{
+			std::unique_lock<std::mutex> lk(m_wakeMutex);
+			m_wakeCV.wait_for(lk, std::chrono::microseconds((int64)(m_drainPeriodS * 1e6)));
+		}
+		unsynced |= drain(f) > 0;
+
+		// Periodically commit the file to disk (so a crash doesn't lose the tail of the log)
+		const RealTime now = System::time();
+		if (unsynced && now - lastSync > m_syncPeriodS) {
+			_commit(_fileno(f));
+			lastSync = now;
+			unsynced = false;
+		}
+	}
+	// Write out anything queued before stop() was called
+	drain(f);
+	_commit(_fileno(f));
+}
+
+void TextLogSink::start() {
+	if (m_running) return;
+	m_running = true;
+	m_thread = std::thread(&TextLogSink::drainThreadEntry, this);
+}
+
+void TextLogSink::stop() {
+	if (!m_running) return;
+	m_running = false;
+	m_wakeCV.notify_one();
+	m_thread.join();
+}
+
+size_t TextLogSink::pendingRecords() const {
+	return (size_t)(m_writePos.load(std::memory_order_relaxed) - m_readPos.load(std::memory_order_relaxed));
+}
+
+void TextLogSink::print(const String& text) {
+	const FILETIME time = FPSciLogger::getFileTime();
+	const uint32 threadId = (uint32)GetCurrentThreadId();
+	if (!m_running) {
+		Log::common()->print(formatRecord(text, time, threadId));
+		return;
+	}
+	while (!tryPush(text, time, threadId)) {
+		// Ring is full, wake the drain thread and wait for a free slot (rather than dropping the record)
+		m_wakeCV.notify_one();
+		std::this_thread::yield();
+	}
+	if (pendingRecords() > RingSize / 2) {
+		m_wakeCV.notify_one();
+	}
+}
+
+void TextLogSink::vprintf(const char* fmt, va_list argPtr) {
+	print(vformat(fmt, argPtr));
+}
+
+void logPrintfAsync(const char* fmt, ...) {
+	va_list argList;
+	va_start(argList, fmt);
+	TextLogSink::common().vprintf(fmt, argList);
+	va_end(argList);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/** Asynchronous sink for log.txt output
+
+	Records are formatted on the calling thread and pushed into a fixed-size lock-free ring (no locks or file I/O on the caller).
+	A background thread drains the ring into the G3D log file (log.txt), prefixing each record with its timestamp and thread id,
+	and periodically commits the file to disk. When the sink is not running, records are written synchronously instead.
+*/
+class TextLogSink {
+protected:
+	static const int RingSize = 4096;					///< Number of record slots in the ring (must be a power of 2)
+
+	/** A single (preformatted) log record slot */
+	struct Slot {
+		std::atomic<uint64> sequence;					///< Slot sequence number (used for lock-free handoff)
+		FILETIME time;									///< Time the record was created
+		uint32 threadId;								///< Id of the thread that created the record
+		String text;									///< Preformatted record text
+	};
+
+	Slot* m_ring = nullptr;								///< Ring storage (allocated once in the constructor)
+	std::atomic<uint64> m_writePos;						///< Next position to be claimed by a producer
+	std::atomic<uint64> m_readPos;						///< Next position to be drained (only advanced by the drain thread)
+
+	RealTime m_drainPeriodS = 0.005;					///< Max time between drains of the ring
+	RealTime m_syncPeriodS = 1.0;						///< Time between commits of log.txt to disk
+
+	std::atomic<bool> m_running;
+	std::thread m_thread;
+	std::mutex m_wakeMutex;								///< Only used by the drain thread to sleep between drains
+	std::condition_variable m_wakeCV;
+
+	TextLogSink();
+
+	/** Claim a slot and fill it, returns false if the ring is full */
+	bool tryPush(const String& text, const FILETIME& time, uint32 threadId);
+
+	/** Write out all available records, returns the number written */
+	int drain(FILE* f);
+
+	void drainThreadEntry();
+
+	/** Build the full line (w/ timestamp and thread id prefix) written to the log */
+	static String formatRecord(const String& text, const FILETIME& time, uint32 threadId);
+
+public:
+	~TextLogSink();
+
+	/** The sink shared by the application */
+	static TextLogSink& common();
+
+	/** Start the drain thread (records are written synchronously until this is called) */
+	void start();
+
+	/** Drain all pending records, commit the file, and stop the drain thread */
+	void stop();
+
+	bool running() const { return m_running; }
+
+	/** Number of records waiting to be written */
+	size_t pendingRecords() const;
+
+	/** Queue a (preformatted) record for output to log.txt */
+	void print(const String& text);
+	void vprintf(const char* fmt, va_list argPtr);
+};
+
+/** Drop-in replacement for logPrintf() that does not perform file I/O on the calling thread */
+void logPrintfAsync(const char* fmt, ...);
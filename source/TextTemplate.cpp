@@ -0,0 +1,96 @@
+#include "TextTemplate.h"
+
+void TemplateVariables::addInt(const String& name, const std::function<int()>& value) {
+	Variable v;
+	v.name = name;
+	v.append = [value](String& out) {
+		char buf[16];
+		snprintf(buf, sizeof(buf), "%d", value());
+		out += buf;
+	};
+	m_variables.append(v);
+}
+
+void TemplateVariables::addFloat(const String& name, const std::function<float()>& value, const char* fmt) {
+	Variable v;
+	v.name = name;
+	v.append = [value, fmt](String& out) {
+		char buf[64];
+		snprintf(buf, sizeof(buf), fmt, value());
+		out += buf;
+	};
+	m_variables.append(v);
+}
+
+void TemplateVariables::addString(const String& name, const std::function<String()>& value) {
+	Variable v;
+	v.name = name;
+	v.append = [value](String& out) { out += value(); };
+	m_variables.append(v);
+}
+
+int TemplateVariables::match(const String& text, size_t pos) const {
+	int best = -1;
+	for (int i = 0; i < m_variables.size(); i++) {
+		const String& name = m_variables[i].name;
+		if (best >= 0 && name.length() <= m_variables[best].name.length()) continue;
+		if (!text.compare(pos, name.length(), name)) best = i;
+	}
+	return best;
+}
+
+void TextTemplate::compile(const String& text, const TemplateVariables& variables, bool strict) {
+	m_source = text;
+	m_tokens.fastClear();
+
+	String literal;
+	size_t pos = 0;
+	while (pos < text.length()) {
+		const size_t found = text.find('%', pos);
+		if (found == std::string::npos) {
+			literal += text.substr(pos);
+			break;
+		}
+		literal += text.substr(pos, found - pos);
+		if (found + 1 < text.length() && text[found + 1] == '%') {
+			literal += "%%";			// Kept as is (e.g. for cmd.exe), but never starts a variable reference
+			pos = found + 2;
+			continue;
+		}
+		const int idx = variables.match(text, found + 1);
+		if (idx < 0) {
+			if (strict && found + 1 < text.length() && isalpha((unsigned char)text[found + 1])) {
+				size_t end = found + 1;
+				while (end < text.length() && isalnum((unsigned char)text[end])) end++;
+				throw format("Unknown variable \"%s\" in \"%s\"!", text.substr(found, end - found).c_str(), text.c_str());
+			}
+			literal += '%';				// Not a (known) variable reference, keep the %
+			pos = found + 1;
+			continue;
+		}
+		if (!literal.empty()) {
+			m_tokens.next().literal = literal;
+			literal.clear();
+		}
+		m_tokens.next().variable = idx;
+		pos = found + 1 + variables.name(idx).length();
+	}
+	if (!literal.empty()) {
+		m_tokens.next().literal = literal;
+	}
+}
+
+void TextTemplate::render(const TemplateVariables& variables, String& out) const {
+	out.clear();
+	for (const Token& token : m_tokens) {
+		if (token.variable < 0) out += token.literal;
+		else variables.append(token.variable, out);
+	}
+}
+
+bool TextTemplate::references(const String& name, const TemplateVariables& variables) const {
+	for (const Token& token : m_tokens) {
+		if (token.variable >= 0 && variables.name(token.variable) == name) return true;
+	}
+	return false;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <functional>
+
+/** A set of named variables (referenced as %name in a TextTemplate), each w/ a typed formatter */
+class TemplateVariables {
+public:
+	/** Appends a variable's (current) value to the output */
+	typedef std::function<void(String& out)> Formatter;
+
+protected:
+	struct Variable {
+		String		name;					///< Name (w/o the leading %)
+		Formatter	append;
+	};
+	Array<Variable> m_variables;
+
+public:
+	void addInt(const String& name, const std::function<int()>& value);
+	/** Add a float variable, formatted w/ the provided printf-style format */
+	void addFloat(const String& name, const std::function<float()>& value, const char* fmt = "%.2f");
+	void addString(const String& name, const std::function<String()>& value);
+
+	/** Index of the longest variable name starting at text[pos] (or -1 if none match) */
+	int match(const String& text, size_t pos) const;
+
+	const String& name(int idx) const { return m_variables[idx].name; }
+	void append(int idx, String& out) const { m_variables[idx].append(out); }
+};
+
+/** A string w/ %variable references, split into literals and variable references once (when compiled) so it can be
+	rendered repeatedly w/o rescanning it.
+
+	A % followed by a known variable name is replaced by that variable's value (the longest matching name is used). Any
+	other % followed by a letter is an unknown variable and is reported when a strict template is compiled (non-strict
+	templates, e.g. commands w/ Windows %PATH% or "for %i" references, keep them as is). %% is kept as is, but never
+	starts a variable reference, and any other % is kept as is (e.g. "50% done").
+*/
+class TextTemplate {
+protected:
+	struct Token {
+		String	literal;					///< Literal text (when variable < 0)
+		int		variable = -1;				///< Index of the variable to render (in the TemplateVariables it was compiled w/)
+	};
+	Array<Token>	m_tokens;
+	String			m_source;				///< The uncompiled template
+
+public:
+	TextTemplate() {}
+	/** Compile the template, throws a String describing any unknown variable (if strict) */
+	TextTemplate(const String& text, const TemplateVariables& variables, bool strict = true) { compile(text, variables, strict); }
+
+	void compile(const String& text, const TemplateVariables& variables, bool strict = true);
+
+	/** Render the template into out (replacing its contents, but reusing its storage) */
+	void render(const TemplateVariables& variables, String& out) const;
+
+	/** Does the template reference the named variable? */
+	bool references(const String& name, const TemplateVariables& variables) const;
+
+	const String& source() const { return m_source; }
+};
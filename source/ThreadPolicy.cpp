@@ -0,0 +1,145 @@
+#include "ThreadPolicy.h"
+#include "TextLogSink.h"
+#include <mutex>
+
+static std::mutex s_rolePoliciesMutex;
+static Table<String, ThreadPolicy> s_rolePolicies;		///< Policies by thread role (guarded by s_rolePoliciesMutex)
+
+static bool sameCores(const Array<int>& a, const Array<int>& b) {
+	if (a.size() != b.size()) return false;
+	for (int i = 0; i < a.size(); i++) {
+		if (a[i] != b[i]) return false;
+	}
+	return true;
+}
+
+static bool threadPriorityFromString(const String& priority, int& value) {
+	if (priority == "idle")				value = THREAD_PRIORITY_IDLE;
+	else if (priority == "lowest")		value = THREAD_PRIORITY_LOWEST;
+	else if (priority == "belowNormal")	value = THREAD_PRIORITY_BELOW_NORMAL;
+	else if (priority == "normal")		value = THREAD_PRIORITY_NORMAL;
+	else if (priority == "aboveNormal")	value = THREAD_PRIORITY_ABOVE_NORMAL;
+	else if (priority == "highest")		value = THREAD_PRIORITY_HIGHEST;
+	else if (priority == "timeCritical")	value = THREAD_PRIORITY_TIME_CRITICAL;
+	else return false;
+	return true;
+}
+
+static bool priorityClassFromString(const String& priorityClass, DWORD& value) {
+	if (priorityClass == "idle")				value = IDLE_PRIORITY_CLASS;
+	else if (priorityClass == "belowNormal")	value = BELOW_NORMAL_PRIORITY_CLASS;
+	else if (priorityClass == "normal")			value = NORMAL_PRIORITY_CLASS;
+	else if (priorityClass == "aboveNormal")	value = ABOVE_NORMAL_PRIORITY_CLASS;
+	else if (priorityClass == "high")			value = HIGH_PRIORITY_CLASS;
+	else if (priorityClass == "realtime")		value = REALTIME_PRIORITY_CLASS;
+	else return false;
+	return true;
+}
+
+ThreadPolicy::ThreadPolicy(const Any& any) {
+	AnyTableReader reader(any);
+	int settingsVersion = 1;
+	reader.getIfPresent("settingsVersion", settingsVersion);
+	switch (settingsVersion) {
+	case 1:
+		reader.getIfPresent("cores", cores);
+		reader.getIfPresent("priority", priority);
+		reader.getIfPresent("lowIoPriority", lowIoPriority);
+		break;
+	default:
+		throw format("Did not recognize thread policy settings version: %d", settingsVersion);
+		break;
+	}
+
+	int value;
+	if (!threadPriorityFromString(priority, value)) {
+		throw format("Unrecognized thread \"priority\" \"%s\". Valid options are \"idle\", \"lowest\", \"belowNormal\", \"normal\", \"aboveNormal\", \"highest\", or \"timeCritical\"", priority.c_str());
+	}
+	for (int core : cores) {
+		if (core < 0 || core >= 64) {
+			throw format("Thread policy core index %d is out of range (must be in [0, 63])!", core);
+		}
+	}
+}
+
+Any ThreadPolicy::toAny(const bool forceAll) const {
+	Any a(Any::TABLE);
+	ThreadPolicy def;
+	if (forceAll || !sameCores(def.cores, cores))				a["cores"] = cores;
+	if (forceAll || def.priority != priority)					a["priority"] = priority;
+	if (forceAll || def.lowIoPriority != lowIoPriority)			a["lowIoPriority"] = lowIoPriority;
+	return a;
+}
+
+bool ThreadPolicy::operator!=(const ThreadPolicy& other) const {
+	return !sameCores(cores, other.cores) ||
+		priority != other.priority ||
+		lowIoPriority != other.lowIoPriority;
+}
+
+String ThreadPolicy::toString() const {
+	String coreStr;
+	for (int i = 0; i < cores.size(); i++) {
+		coreStr += format(i == 0 ? "%d" : ",%d", cores[i]);
+	}
+	return format("cores = %s, priority = %s, I/O priority = %s",
+		cores.size() > 0 ? coreStr.c_str() : "any", priority.c_str(), lowIoPriority ? "low (background)" : "normal");
+}
+
+bool ThreadPolicy::applyToCurrentThread() const {
+	bool ok = true;
+	const HANDLE thread = GetCurrentThread();
+
+	if (cores.size() > 0) {
+		DWORD_PTR mask = 0;
+		for (int core : cores) { mask |= ((DWORD_PTR)1) << core; }
+		if (SetThreadAffinityMask(thread, mask) == 0) {
+			logPrintfAsync("Could not set thread affinity (error %u)\n", (unsigned)GetLastError());
+			ok = false;
+		}
+	}
+
+	int value = THREAD_PRIORITY_NORMAL;
+	threadPriorityFromString(priority, value);
+	if (!SetThreadPriority(thread, value)) {
+		logPrintfAsync("Could not set thread priority to %s (error %u)\n", priority.c_str(), (unsigned)GetLastError());
+		ok = false;
+	}
+
+	// Background mode can only be entered by the thread itself (this is why policies are applied from within each thread)
+	if (lowIoPriority && !SetThreadPriority(thread, THREAD_MODE_BACKGROUND_BEGIN)) {
+		logPrintfAsync("Could not lower thread I/O priority (error %u)\n", (unsigned)GetLastError());
+		ok = false;
+	}
+	return ok;
+}
+
+void ThreadPolicy::setRolePolicy(const String& role, const ThreadPolicy& policy) {
+	std::lock_guard<std::mutex> lk(s_rolePoliciesMutex);
+	s_rolePolicies.set(role, policy);
+}
+
+void ThreadPolicy::applyRole(const String& role, const String& threadName) {
+	ThreadPolicy policy;
+	{
+		std::lock_guard<std::mutex> lk(s_rolePoliciesMutex);
+		s_rolePolicies.get(role, policy);
+	}
+	const bool ok = policy.applyToCurrentThread();
+	logPrintfAsync("Thread policy for %s (%s thread %u): %s%s\n", threadName.c_str(), role.c_str(),
+		(unsigned)GetCurrentThreadId(), policy.toString().c_str(), ok ? "" : " (not fully applied)");
+}
+
+bool ThreadPolicy::applyProcessPriority(const String& priorityClass) {
+	DWORD value;
+	if (!priorityClassFromString(priorityClass, value)) {
+		logPrintfAsync("Unrecognized process priority \"%s\", using \"normal\"\n", priorityClass.c_str());
+		value = NORMAL_PRIORITY_CLASS;
+	}
+	if (!SetPriorityClass(GetCurrentProcess(), value)) {
+		logPrintfAsync("Could not set process priority to %s (error %u)\n", priorityClass.c_str(), (unsigned)GetLastError());
+		return false;
+	}
+	logPrintfAsync("Process priority: %s\n", priorityClass.c_str());
+	return true;
+}
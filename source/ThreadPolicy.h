@@ -0,0 +1,35 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Placement (core affinity) and scheduling priority for a thread
+
+	Policies are registered by thread role ("main", "logger", or "helper") from the system config,
+	then each thread applies the policy for its role to itself when it starts (see applyRole()).
+*/
+class ThreadPolicy {
+public:
+	Array<int>	cores;							///< Logical cores the thread may run on (empty to run on any core)
+	String		priority = "normal";			///< Thread priority ("idle", "lowest", "belowNormal", "normal", "aboveNormal", "highest", or "timeCritical")
+	bool		lowIoPriority = false;			///< Run the thread in background mode (lowers its I/O and CPU scheduling priority)
+
+	ThreadPolicy() {}
+	ThreadPolicy(const Any& any);
+
+	Any toAny(const bool forceAll = false) const;
+	bool operator!=(const ThreadPolicy& other) const;
+
+	/** Short description of the policy (for logging) */
+	String toString() const;
+
+	/** Apply this policy to the calling thread, returns false (and logs) if any part could not be applied */
+	bool applyToCurrentThread() const;
+
+	/** Set the policy used for a thread role */
+	static void setRolePolicy(const String& role, const ThreadPolicy& policy);
+
+	/** Apply the policy for a role to the calling thread and record it in the log */
+	static void applyRole(const String& role, const String& threadName);
+
+	/** Set the priority class of the process ("idle", "belowNormal", "normal", "aboveNormal", "high", or "realtime") */
+	static bool applyProcessPriority(const String& priorityClass);
+};
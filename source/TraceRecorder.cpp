@@ -0,0 +1,170 @@
+#include "TraceRecorder.h"
+#include "TextLogSink.h"
+#include <algorithm>
+
+static thread_local void* t_traceBuffer = nullptr;		///< The calling thread's TraceRecorder::ThreadBuffer
+static thread_local String t_threadName;				///< The calling thread's name (kept until it has a buffer)
+
+struct TraceRecorder::ThreadExit {
+	bool armed = false;
+	~ThreadExit() { if (armed) TraceRecorder::common().releaseThreadBuffer(); }
+};
+static thread_local TraceRecorder::ThreadExit t_traceExit;
+
+TraceRecorder::TraceRecorder() : m_enabled(false) {
+	m_startTime = System::time();
+}
+
+TraceRecorder::~TraceRecorder() {
+	for (ThreadBuffer* buffer : m_buffers) { delete buffer; }
+}
+
+TraceRecorder& TraceRecorder::common() {
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::threadBuffer() {
+	if (isNull(t_traceBuffer)) {
+		const uint32 threadId = (uint32)GetCurrentThreadId();
+		ThreadBuffer* buffer = nullptr;
+		{
+			std::lock_guard<std::mutex> lk(m_buffersMutex);
+			if (m_freeBuffers.size() > 0) {
+				// Reuse the buffer of an exited thread (discarding its events)
+				buffer = m_freeBuffers.pop();
+				buffer->clearedCount = buffer->count.load(std::memory_order_relaxed);
+				buffer->depth = 0;
+			}
+			else {
+				buffer = new ThreadBuffer();
+				m_buffers.append(buffer);
+			}
+			buffer->threadId = threadId;
+			buffer->threadName = t_threadName.empty() ? format("Thread %u", threadId) : t_threadName;
+		}
+		t_traceBuffer = buffer;
+		t_traceExit.armed = true;
+	}
+	return (ThreadBuffer*)t_traceBuffer;
+}
+
+void TraceRecorder::releaseThreadBuffer() {
+	if (isNull(t_traceBuffer)) return;
+	std::lock_guard<std::mutex> lk(m_buffersMutex);
+	m_freeBuffers.append((ThreadBuffer*)t_traceBuffer);
+	t_traceBuffer = nullptr;
+}
+
+void TraceRecorder::setThreadName(const String& name) {
+	t_threadName = name;
+	if (isNull(t_traceBuffer)) return;		// Named when (if) the thread records
+	std::lock_guard<std::mutex> lk(m_buffersMutex);
+	((ThreadBuffer*)t_traceBuffer)->threadName = name;
+}
+
+void TraceRecorder::record(ThreadBuffer* buffer, const char* name, bool begin) {
+	const uint64 idx = buffer->count.load(std::memory_order_relaxed);
+	Event& e = buffer->events[idx & (BufferSize - 1)];
+	e.name = name;
+	e.timeUs = (int64)((System::time() - m_startTime) * 1e6);
+	e.begin = begin;
+	buffer->count.store(idx + 1, std::memory_order_release);
+}
+
+void TraceRecorder::beginEvent(const char* name) {
+	TraceRecorder& recorder = common();
+	if (!recorder.m_enabled && isNull(t_traceBuffer)) return;		// Don't create buffers for threads until recording is enabled
+	ThreadBuffer* buffer = recorder.threadBuffer();
+	// Track the zone stack even when disabled so begin/end stay paired if recording is toggled mid-zone
+	if (buffer->depth < MaxDepth) buffer->stack[buffer->depth] = name;
+	buffer->depth++;
+	if (recorder.m_enabled) recorder.record(buffer, name, true);
+}
+
+void TraceRecorder::endEvent() {
+	TraceRecorder& recorder = common();
+	if (isNull(t_traceBuffer)) return;
+	ThreadBuffer* buffer = (ThreadBuffer*)t_traceBuffer;
+	if (buffer->depth == 0) return;									// Unmatched end (zone began before this thread had a buffer)
+	buffer->depth--;
+	const char* name = buffer->depth < MaxDepth ? buffer->stack[buffer->depth] : nullptr;
+	if (recorder.m_enabled) recorder.record(buffer, name, false);
+}
+
+void TraceRecorder::getRecentEvents(Array<ThreadEvent>& events, int maxPerThread) {
+	events.fastClear();
+	std::lock_guard<std::mutex> lk(m_buffersMutex);
+	for (ThreadBuffer* buffer : m_buffers) {
+		const uint64 count = buffer->count.load(std::memory_order_acquire);
+		// Leave some slack at the oldest end of the ring, those events may be overwritten while we copy
+		const uint64 available = min(count - buffer->clearedCount, (uint64)(BufferSize - 256));
+		const uint64 n = min(available, (uint64)max(0, maxPerThread));
+		for (uint64 i = count - n; i < count; i++) {
+			ThreadEvent e;
+			static_cast<Event&>(e) = buffer->events[i & (BufferSize - 1)];
+			e.threadId = buffer->threadId;
+			events.append(e);
+		}
+	}
+	std::stable_sort(events.begin(), events.end(), [](const ThreadEvent& a, const ThreadEvent& b) { return a.timeUs < b.timeUs; });
+}
+
+String TraceRecorder::recentEventsToString(int maxEvents) {
+	Array<ThreadEvent> events;
+	getRecentEvents(events, maxEvents);
+	if (events.size() == 0) return "";
+	const int start = max(0, events.size() - maxEvents);
+	const int64 lastUs = events.last().timeUs;
+	String out;
+	for (int i = start; i < events.size(); i++) {
+		const ThreadEvent& e = events[i];
+		out += format("%s%u %s %s %lld", i == start ? "" : ";", e.threadId, e.begin ? "B" : "E", notNull(e.name) ? e.name : "?", (long long)(e.timeUs - lastUs));
+	}
+	return out;
+}
+
+void TraceRecorder::clear() {
+	std::lock_guard<std::mutex> lk(m_buffersMutex);
+	for (ThreadBuffer* buffer : m_buffers) {
+		buffer->clearedCount = buffer->count.load(std::memory_order_acquire);
+	}
+}
+
+static String jsonEscape(const char* s) {
+	String out;
+	for (const char* c = s; notNull(c) && *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') out += '\\';
+		out += *c;
+	}
+	return out;
+}
+
+bool TraceRecorder::exportChromeTrace(const String& filename) {
+	Array<ThreadEvent> events;
+	getRecentEvents(events);
+
+	FILE* f = fopen(filename.c_str(), "w");
+	if (isNull(f)) {
+		logPrintfAsync("Could not open trace file: %s\n", filename.c_str());
+		return false;
+	}
+	const uint32 pid = (uint32)GetCurrentProcessId();
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	// Thread names (metadata events)
+	{
+		std::lock_guard<std::mutex> lk(m_buffersMutex);
+		for (int i = 0; i < m_buffers.size(); i++) {
+			fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+				i == 0 ? "" : ",\n", pid, m_buffers[i]->threadId, jsonEscape(m_buffers[i]->threadName.c_str()).c_str());
+		}
+	}
+	for (const ThreadEvent& e : events) {
+		fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%lld,\"pid\":%u,\"tid\":%u}",
+			jsonEscape(e.name).c_str(), e.begin ? "B" : "E", (long long)e.timeUs, pid, e.threadId);
+	}
+	fprintf(f, "\n]}\n");
+	fclose(f);
+	logPrintfAsync("Wrote %d trace events to %s\n", events.size(), filename.c_str());
+	return true;
+}
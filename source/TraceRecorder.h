@@ -0,0 +1,96 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+#include <mutex>
+
+/** Records profiler zones (begin/end events) into per-thread ring buffers for export as a Chrome trace (JSON)
+
+	Each thread writes only to its own buffer, so recording an event is a couple of stores and an atomic increment (no locks).
+	Buffers are fixed size, once full the oldest events are overwritten (so the buffers always hold the most recent history).
+	A thread's buffer is only created once it records while enabled, and is reused by later threads once its thread exits.
+	Zone names must be string literals (or otherwise outlive the recorder), only the pointer is stored.
+
+	Use the BEGIN_TRACE_EVENT/END_TRACE_EVENT macros below, these also forward to the G3D profiler.
+*/
+class TraceRecorder {
+public:
+	/** A single recorded begin/end event */
+	struct Event {
+		const char*	name = nullptr;				///< Zone name
+		int64		timeUs = 0;					///< Time of the event (in us since the recorder was created)
+		bool		begin = true;				///< Begin (true) or end (false) of the zone
+	};
+
+	/** A (copied) event w/ the id of the thread that recorded it */
+	struct ThreadEvent : public Event {
+		uint32		threadId = 0;
+	};
+
+protected:
+	static const int BufferSize = 1 << 16;		///< Events per thread (must be a power of 2)
+	static const int MaxDepth = 64;				///< Max zone nesting depth (per thread)
+
+	/** Per-thread storage (only written by the owning thread) */
+	struct ThreadBuffer {
+		uint32					threadId = 0;
+		String					threadName;
+		Event*					events = nullptr;
+		std::atomic<uint64>		count;					///< Total events written (write position)
+		uint64					clearedCount = 0;		///< Events before this position have been cleared
+		const char*				stack[MaxDepth];		///< Names of the open zones (to name end events)
+		int						depth = 0;
+
+		ThreadBuffer() : count(0) { events = new Event[BufferSize]; }
+		~ThreadBuffer() { delete[] events; }
+	};
+
+	std::atomic<bool>			m_enabled;
+	RealTime					m_startTime;
+	std::mutex					m_buffersMutex;			///< Only locked to add/release a thread (or export)
+	Array<ThreadBuffer*>		m_buffers;				///< All buffers (including free ones, their events are still exported)
+	Array<ThreadBuffer*>		m_freeBuffers;			///< Buffers of exited threads (reused before allocating)
+
+	TraceRecorder();
+
+	/** Get the buffer for the calling thread (reusing a free buffer or creating one if needed) */
+	ThreadBuffer* threadBuffer();
+	/** Return the calling thread's buffer (if any) to the free list */
+	void releaseThreadBuffer();
+	void record(ThreadBuffer* buffer, const char* name, bool begin);
+
+public:
+	/** Releases the calling thread's buffer (to the free list) when the thread exits (internal) */
+	struct ThreadExit;
+
+	~TraceRecorder();
+
+	static TraceRecorder& common();
+
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	bool enabled() const { return m_enabled; }
+
+	/** Name the calling thread in exported traces (doesn't create a buffer) */
+	void setThreadName(const String& name);
+
+	/** Record the begin/end of a zone on the calling thread */
+	static void beginEvent(const char* name);
+	static void endEvent();
+
+	/** Copy the most recent events (up to maxPerThread per thread) from all threads, sorted by time */
+	void getRecentEvents(Array<ThreadEvent>& events, int maxPerThread = BufferSize);
+
+	/** Summarize the most recent events (across all threads) as "<thread id> <B|E> <zone name> <time>" entries separated by ';'
+		Times are in us, relative to the most recent event.
+	*/
+	String recentEventsToString(int maxEvents);
+
+	/** Discard all recorded events */
+	void clear();
+
+	/** Write all recorded events to a Chrome trace (JSON) file, viewable in chrome://tracing or the Perfetto UI */
+	bool exportChromeTrace(const String& filename);
+};
+
+#define BEGIN_TRACE_EVENT(name) do { BEGIN_PROFILER_EVENT(name); TraceRecorder::beginEvent(name); } while (false)
+#define BEGIN_TRACE_EVENT_WITH_HINT(name, hint) do { BEGIN_PROFILER_EVENT_WITH_HINT(name, hint); TraceRecorder::beginEvent(name); } while (false)
+#define END_TRACE_EVENT() do { TraceRecorder::endEvent(); END_PROFILER_EVENT(); } while (false)
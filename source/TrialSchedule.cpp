@@ -0,0 +1,86 @@
+#include "TrialSchedule.h"
+#include "TargetEntity.h"
+
+void TrialSchedule::compile(const Array<int>& counts, int blockCount, const Array<Array<shared_ptr<const TargetConfig>>>& targets, uint32 seed) {
+	m_seed = seed;
+	m_rng = RandomStream(seed);
+	m_trials.fastClear();
+	m_targets = targets;
+	m_counts = counts;
+	m_remaining = counts;
+	m_blockCount = max(1, blockCount);			// The first block is always run
+	m_block = 1;
+	m_complete = false;
+
+	const bool unlimited = counts.contains(-1);
+	while ((!unlimited || m_trials.size() < Lookahead) && compileNext()) {}
+}
+
+bool TrialSchedule::compileNext() {
+	if (m_complete) return false;
+
+	// Move to the next block once all trials in this one are compiled
+	bool blockComplete = true;
+	for (int remaining : m_remaining) {
+		blockComplete = blockComplete && (remaining == 0);
+	}
+	if (blockComplete) {
+		if (m_block >= m_blockCount) {
+			m_complete = true;
+			return false;
+		}
+		m_block++;
+		m_remaining = m_counts;
+	}
+
+	// Pick from the trials w/ runs left in this block
+	Array<int> unrunTrialIdxs;
+	for (int i = 0; i < m_remaining.size(); i++) {
+		if (m_remaining[i] > 0 || m_remaining[i] == -1) unrunTrialIdxs.append(i);
+	}
+	if (unrunTrialIdxs.size() == 0) {
+		m_complete = true;
+		return false;
+	}
+	const int idx = unrunTrialIdxs[m_rng.integer(0, unrunTrialIdxs.size() - 1)];
+	if (m_remaining[idx] > 0) m_remaining[idx]--;
+
+	ScheduledTrial& trial = m_trials.next();
+	trial.trialIdx = idx;
+	trial.block = m_block;
+	trial.targets.resize(m_targets[idx].size());
+	for (int i = 0; i < m_targets[idx].size(); i++) {
+		const TargetConfig& config = *m_targets[idx][i];
+		ScheduledTarget& target = trial.targets[i];
+		// Draw each value in its own statement so the order of draws doesn't depend on the compiler
+		const float signV = config.symmetricEccV ? m_rng.sign() : 1.0f;
+		target.eccV = signV * m_rng.uniform(config.eccV[0], config.eccV[1]);
+		const float signH = config.symmetricEccH ? m_rng.sign() : 1.0f;
+		target.eccH = signH * m_rng.uniform(config.eccH[0], config.eccH[1]);
+		target.size = m_rng.uniform(config.size[0], config.size[1]);
+		if (config.destSpace == "world") target.position = m_rng.interiorPoint(config.spawnBounds);
+	}
+	return true;
+}
+
+const ScheduledTrial* TrialSchedule::trial(int index) {
+	while (index >= m_trials.size() && compileNext()) {}
+	return (index >= 0 && index < m_trials.size()) ? &m_trials[index] : nullptr;
+}
+
+bool TrialSchedule::exportCsv(const String& filename) const {
+	FILE* f = fopen(filename.c_str(), "w");
+	if (isNull(f)) return false;
+	fprintf(f, "seed,%u\n", m_seed);
+	fprintf(f, "order,trial_index,block,target_index,target_id,ecc_h,ecc_v,size,spawn_x,spawn_y,spawn_z\n");
+	for (int i = 0; i < m_trials.size(); i++) {
+		const ScheduledTrial& trial = m_trials[i];
+		for (int j = 0; j < trial.targets.size(); j++) {
+			const ScheduledTarget& target = trial.targets[j];
+			fprintf(f, "%d,%d,%d,%d,%s,%f,%f,%f,%f,%f,%f\n", i, trial.trialIdx, trial.block, j, m_targets[trial.trialIdx][j]->id.c_str(),
+				target.eccH, target.eccV, target.size, target.position.x, target.position.y, target.position.z);
+		}
+	}
+	fclose(f);
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "RandomStream.h"
+
+class TargetConfig;
+
+/** Spawn parameters for one target of a scheduled trial */
+struct ScheduledTarget {
+	float	eccH = 0.0f;						///< Horizontal spawn eccentricity (in degrees)
+	float	eccV = 0.0f;						///< Vertical spawn eccentricity (in degrees)
+	float	size = 0.0f;						///< Target size
+	Point3	position;							///< Spawn position (world space targets only, from the target's spawn bounds)
+};
+
+/** A single trial in a session's schedule */
+struct ScheduledTrial {
+	int		trialIdx = -1;						///< Index of the trial (in the session's trials array)
+	int		block = 1;							///< Block the trial is run in
+	Array<ScheduledTarget> targets;				///< Spawn parameters (by target index in the trial)
+};
+
+/** The ordered list of trials (and their target spawn parameters) for a session, compiled from a seed
+
+	Compiling the schedule does all of the sampling a session used to do at trial transitions, so the same seed always
+	produces the same run. Trials are picked the same way they were at runtime: uniformly from the trials w/ runs left in
+	the current block. Sessions w/ unlimited (count = -1) trials never complete a block, so only the next Lookahead
+	trials are compiled up front and the rest are compiled (deterministically) as they are needed.
+*/
+class TrialSchedule {
+public:
+	static const int Lookahead = 1000;			///< Trials compiled up front for sessions w/ unlimited trials
+
+protected:
+	uint32									m_seed = 0;
+	RandomStream							m_rng;				///< Stream for the schedule (stream 0 of m_seed)
+	Array<ScheduledTrial>					m_trials;
+	Array<Array<shared_ptr<const TargetConfig>>>	m_targets;	///< Target configs by trial index
+	Array<int>								m_counts;			///< Trial counts (per block)
+	Array<int>								m_remaining;		///< Remaining trials (in m_block) as of the last compiled trial
+	int										m_blockCount = 1;
+	int										m_block = 1;
+	bool									m_complete = false;	///< Have all trials in the session been compiled?
+
+	/** Compile the next trial, returns false if the session has no trials left */
+	bool compileNext();
+
+public:
+	/** Compile the schedule for a session w/ the given trial counts (per block, -1 for unlimited) and target configs (by trial) */
+	void compile(const Array<int>& counts, int blockCount, const Array<Array<shared_ptr<const TargetConfig>>>& targets, uint32 seed);
+
+	/** Get the scheduled trial at the given index (compiles more trials for sessions w/ unlimited trials), or nullptr if there is none */
+	const ScheduledTrial* trial(int index);
+
+	/** Number of trials compiled so far (all trials in the session if complete()) */
+	int size() const { return m_trials.size(); }
+	/** Have all the session's trials been compiled (false for sessions w/ unlimited trials) */
+	bool complete() const { return m_complete; }
+	uint32 seed() const { return m_seed; }
+
+	/** Write the compiled schedule to a CSV file (one row per target) for inspection */
+	bool exportCsv(const String& filename) const;
+};
@@ -1,4 +1,5 @@
 #include "UserConfig.h"
+#include "TextLogSink.h"
 
 template <class T>
 static bool operator!=(Array<T> a1, Array<T> a2) {
@@ -139,6 +140,6 @@ int UserTable::getUserIndex(String userId) const {
 
 void UserTable::printToLog() const {
 	for (UserConfig user : users) {
-		logPrintf("\tUser ID: %s, sensitivity = %f deg/mm, mouseDPI = %d\n", user.id.c_str(), user.mouseDegPerMm, user.mouseDPI);
+		logPrintfAsync("\tUser ID: %s, sensitivity = %f deg/mm, mouseDPI = %d\n", user.id.c_str(), user.mouseDegPerMm, user.mouseDPI);
 	}
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "UserStatus.h"
+#include "TextLogSink.h"
 
 UserSessionStatus::UserSessionStatus(const Any& any) {
 	int settingsVersion = 1; // used to allow different version numbers to be loaded differently
@@ -174,6 +175,6 @@ void UserStatusTable::printToLog() const {
 		}
 		completedSess = completedSess.substr(0, completedSess.length() - 2);
 
-		logPrintf("Subject ID: %s\nSession Order: [%s]\nCompleted Sessions: [%s]\n", status.id.c_str(), sessOrder.c_str(), completedSess.c_str());
+		logPrintfAsync("Subject ID: %s\nSession Order: [%s]\nCompleted Sessions: [%s]\n", status.id.c_str(), sessOrder.c_str(), completedSess.c_str());
 	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "WaypointManager.h"
 #include "FPSciApp.h"
+#include "TextLogSink.h"
 
 void WaypointManager::dropWaypoint(Destination dest, Point3 offset) {
 	// Apply the offset
@@ -23,7 +24,7 @@ void WaypointManager::dropWaypoint(Destination dest, Point3 offset) {
 	m_waypointIDs.append(pointID);
 
 	// Print to the log
-	logPrintf("Dropped waypoint... Time: %f, XYZ:[%f,%f,%f]\n", dest.time, dest.position[0], dest.position[1], dest.position[2]);
+	logPrintfAsync("Dropped waypoint... Time: %f, XYZ:[%f,%f,%f]\n", dest.time, dest.position[0], dest.position[1], dest.position[2]);
 }
 
 void WaypointManager::dropWaypoint(Point3 pos) {
@@ -1,4 +1,6 @@
 #include "Weapon.h"
+#include "PhysicsScene.h"
+#include "TraceRecorder.h"
 
 WeaponConfig::WeaponConfig(const Any& any) {
 	int settingsVersion = 1;
@@ -194,14 +196,14 @@ void Weapon::loadModels() {
 	m_bulletModel = ArticulatedModel::create(bulletSpec, "bulletModel");
 }
 
-void Weapon::onPose(Array<shared_ptr<Surface> >& surface) {
+void Weapon::onPose(Array<shared_ptr<Surface> >& surface, RealTime now) {
 	if (m_camera && (m_config->renderModel || m_config->renderBullets)) { // || m_config->renderMuzzleFlash) {
 		// Update the weapon frame for all of these cases
 		const float yScale = -0.12f;
 		const float zScale = -yScale * 0.5f;
 		float kick = 0.f;
 		// ratio from start to end of kick from 0 to 1
-		const float kickRatio = cooldownRatio(System::time(), m_config->kickDuration);
+		const float kickRatio = cooldownRatio(now, m_config->kickDuration);
 		kick = m_config->kickAngleDegrees * sinf(kickRatio * pif());
 		const float lookY = m_camera->frame().lookVector().y - 6.f * sin(2 * pif() / 360.0f * kick);
 		m_frame = m_camera->frame() * CFrame::fromXYZYPRDegrees(0.3f, -0.4f + lookY * yScale, -1.1f + lookY * zScale, 10, 5+kick);
@@ -214,6 +216,24 @@ void Weapon::onPose(Array<shared_ptr<Surface> >& surface) {
 	}
 }
 
+shared_ptr<Entity> Weapon::intersectScene(const Ray& ray, float& closest, const Array<shared_ptr<Entity>>& dontHit, Model::HitInfo& info) const {
+	const auto exclude = [&](const shared_ptr<Entity>& entity) {
+		// Targets are tested separately (and idle/unhittable targets can't be hit), neither are projectiles
+		if (notNull(dynamic_cast<TargetEntity*>(entity.get())) || notNull(dynamic_cast<Projectile*>(entity.get()))) return true;
+		for (const shared_ptr<VisibleEntity>& decal : m_currentMissDecals) {
+			if (decal.get() == entity.get()) return true;
+		}
+		return dontHit.contains(entity);
+	};
+	return physicsScene()->intersect(ray, closest, exclude, info);
+}
+
+PhysicsScene* Weapon::physicsScene() const {
+	PhysicsScene* scene = dynamic_cast<PhysicsScene*>(m_scene.get());
+	debugAssertM(notNull(scene), "Weapon scene must be a PhysicsScene");
+	return scene;
+}
+
 void Weapon::simulateProjectiles(SimTime sdt, const Array<shared_ptr<TargetEntity>>& targets, const Array<shared_ptr<Entity>>& dontHit) {
 	// Iterate through projectiles for hit/miss detection here
 	for (int p = 0; p < m_projectiles.size(); p++) {
@@ -222,7 +242,7 @@ void Weapon::simulateProjectiles(SimTime sdt, const Array<shared_ptr<TargetEntit
 		// Remove the projectile for timeout
 		if (projectile->remainingTime() <= 0) {
 			// Expire
-			m_scene->removeEntity(projectile->name());
+			physicsScene()->removeOrQueue(projectile);
 			m_projectiles.remove(p);
 			--p;
 		}
@@ -248,15 +268,10 @@ void Weapon::simulateProjectiles(SimTime sdt, const Array<shared_ptr<TargetEntit
 			}
 			// Handle (miss) decals here
 			else {
-				// Build a list of entities not to hit in the scene
-				Array<shared_ptr<Entity>> dontHitItems = dontHit;
-				dontHitItems.append(m_currentMissDecals);
-				dontHitItems.append(targets);					// This is a miss, don't plan to hit targets here
-				dontHitItems.append(m_projectiles);
 				// Check for closest hit (in scene, otherwise this ray hits the skybox)
 				//closest = finf();
 				const Ray ray = projectile->getDecalRay();
-				m_scene->intersect(ray, closest, false, dontHitItems, info);
+				intersectScene(ray, closest, dontHit, info);		// This is a miss, don't plan to hit targets here
 
 				// If we are within 2 simulation cycles of a wall, create the decal
 				if (closest < hitThreshold) {
@@ -271,7 +286,7 @@ void Weapon::simulateProjectiles(SimTime sdt, const Array<shared_ptr<TargetEntit
 
 	// Handle hit "animation" (i.e. remove when done)
 	if (notNull(m_hitDecal) && m_hitDecalTimeRemainingS <= 0) {
-		m_scene->remove(m_hitDecal);
+		physicsScene()->removeOrQueue(m_hitDecal);
 		m_hitDecal.reset();
 	}
 	else {
@@ -283,7 +298,7 @@ void Weapon::simulateProjectiles(SimTime sdt, const Array<shared_ptr<TargetEntit
 		if (m_missDecalTimesRemaining[i] < 0) continue;					// Skip decals with negative initial timeouts (don't timeout)
 		m_missDecalTimesRemaining[i] -= sdt;
 		if (m_missDecalTimesRemaining[i] <= 0) {
-			m_scene->remove(m_currentMissDecals[i]);
+			physicsScene()->removeOrQueue(m_currentMissDecals[i]);
 			m_missDecalTimesRemaining.remove(i);
 			m_currentMissDecals.remove(i);
 			i--;
@@ -305,20 +320,20 @@ void Weapon::drawDecal(const Point3& point, const Vector3& normal, bool hit) {
 	// If we have the maximum amount of decals remove the oldest one
 	if (!hit) {
 		while (m_currentMissDecals.size() >= m_config->missDecalCount) {
-			m_scene->remove(m_currentMissDecals.pop());
+			physicsScene()->removeOrQueue(m_currentMissDecals.pop());
 			m_missDecalTimesRemaining.pop();
 		}
 	}
 	// Handle hit decal here (only show 1 at a time)
 	else if (hit && notNull(m_hitDecal)) {
-		m_scene->remove(m_hitDecal);
+		physicsScene()->removeOrQueue(m_hitDecal);
 	}
 
 	// Add the new decal to the scene
 	shared_ptr<ArticulatedModel> decalModel = hit ? m_hitDecalModel : m_missDecalModel;
 	const shared_ptr<VisibleEntity>& newDecal = VisibleEntity::create(format("decal%03d", ++m_lastDecalID), &(*m_scene), decalModel, decalFrame);
 	newDecal->setCastsShadows(false);
-	m_scene->insert(newDecal);
+	physicsScene()->insertOrQueue(newDecal);
 	if (!hit) {
 		m_currentMissDecals.insert(0, newDecal);	// Add the new decal to the front of the Array (if a miss)
 		m_missDecalTimesRemaining.insert(0, m_config->missDecalTimeoutS);
@@ -331,12 +346,12 @@ void Weapon::drawDecal(const Point3& point, const Vector3& normal, bool hit) {
 
 void Weapon::clearDecals(bool clearHitDecal) {
 	while (m_currentMissDecals.size() > 0) {				// Remove and clear miss decals
-		m_scene->remove(m_currentMissDecals.pop());
+		physicsScene()->removeOrQueue(m_currentMissDecals.pop());
 	}
 	m_missDecalTimesRemaining.clear();						// Clear miss decal timeouts
 
 	if (clearHitDecal && notNull(m_hitDecal)) {				// Clear hit decal (if one is present)
-		m_scene->remove(m_hitDecal);
+		physicsScene()->removeOrQueue(m_hitDecal);
 	}
 }
 
@@ -345,9 +360,10 @@ shared_ptr<TargetEntity> Weapon::fire(
 	int& targetIdx, 
 	float& hitDist, 
 	Model::HitInfo& hitInfo, 
-	Array<shared_ptr<Entity>>& dontHit,
+	const Array<shared_ptr<Entity>>& dontHit,
 	bool dummyShot)
 {
+	BEGIN_TRACE_EVENT("Weapon::fire");
 	Ray ray = m_camera->frame().lookRay();		// Use the camera lookray for hit detection
 	float spread = m_config->fireSpreadDegrees * 2.f * pif() / 360.f;
 
@@ -358,21 +374,21 @@ shared_ptr<TargetEntity> Weapon::fire(
 	// Apply random rotation (for fire spread)
 	Matrix3 rotMat = Matrix3::fromEulerAnglesXYZ(0.f,0.f,0.f);
 	if (m_config->fireSpreadShape == "uniform") {
-		rotMat = Matrix3::fromEulerAnglesXYZ(m_rand.uniform(-spread / 2, spread / 2), m_rand.uniform(-spread / 2, spread / 2), 0);
+		const float x = m_rand.uniform(-spread / 2, spread / 2);
+		const float y = m_rand.uniform(-spread / 2, spread / 2);
+		rotMat = Matrix3::fromEulerAnglesXYZ(x, y, 0);
 	}
 	else if (m_config->fireSpreadShape == "gaussian") {
-		rotMat = Matrix3::fromEulerAnglesXYZ(m_rand.gaussian(0, spread / 3), m_rand.gaussian(0, spread / 3), 0);
+		const float x = m_rand.gaussian(0, spread / 3);
+		const float y = m_rand.gaussian(0, spread / 3);
+		rotMat = Matrix3::fromEulerAnglesXYZ(x, y, 0);
 	}
 	Vector3 dir = Vector3(0.f, 0.f, -1.f) * rotMat;
 	ray.set(ray.origin(), m_camera->frame().rotation * dir);
 
 	// Check for closest hit (in scene, otherwise this ray hits the skybox)
 	float closest = finf();
-	Array<shared_ptr<Entity>> dontHitItems = dontHit;
-	dontHitItems.append(m_currentMissDecals);
-	dontHitItems.append(targets);
-	dontHitItems.append(m_projectiles);
-	m_scene->intersect(ray, closest, false, dontHitItems, hitInfo);
+	intersectScene(ray, closest, dontHit, hitInfo);
 	if (closest < finf()) { hitDist = closest; }
 
 	// Create the bullet (if we need to draw it or are using non-hitscan behavior)
@@ -401,7 +417,7 @@ shared_ptr<TargetEntity> Weapon::fire(
 
 			const shared_ptr<Projectile> projectile = Projectile::create(bullet, m_config->bulletSpeed, !m_config->hitScan, m_config->bulletGravity, fmin((closest + 1.0f) / m_config->bulletSpeed, 10.0f));
 			m_projectiles.push(projectile);
-			m_scene->insert(projectile);
+			physicsScene()->insertOrQueue(projectile);
 		}
 		// Laser weapon (very hacky for now...)
 		else {
@@ -437,7 +453,7 @@ shared_ptr<TargetEntity> Weapon::fire(
 		}
 	}
 
-	END_PROFILER_EVENT();
+	END_TRACE_EVENT();
 
 	return target;
 }
@@ -2,6 +2,8 @@
 #include <G3D/G3D.h>
 #include "TargetEntity.h"
 
+class PhysicsScene;
+
 class Projectile : public VisibleEntity {
 protected:
 	// Timed mode
@@ -159,7 +161,13 @@ protected:
 	Array<shared_ptr<VisibleEntity>>		m_currentMissDecals;				///< Pointers to miss decals
 	Array<SimTime>							m_missDecalTimesRemaining;				///< Create times for miss decals
 
-	Random									m_rand;
+	RandomStream							m_rand;								///< Stream for fire spread (set per session)
+
+	/** The weapon's scene, projectiles and decals are inserted/removed w/ its insertOrQueue()/removeOrQueue() (they may be simulated on another thread) */
+	PhysicsScene* physicsScene() const;
+
+	/** Scene ray cast that skips all targets, projectiles, miss decals, and anything in dontHit */
+	shared_ptr<Entity> intersectScene(const Ray& ray, float& closest, const Array<shared_ptr<Entity>>& dontHit, Model::HitInfo& info) const;
 
 public:
 	static shared_ptr<Weapon> create(WeaponConfig* config, shared_ptr<Scene> scene, shared_ptr<Camera> cam) {
@@ -196,7 +204,7 @@ public:
 
 	/**
 		targets is the list of targets to try to hit
-		Ignore anything in the dontHit list
+		Ignore anything in the dontHit list (targets, projectiles, and miss decals are always ignored by the scene ray cast)
 		dummyShot controls whether it's a shot at the test target (is this true?)
 		targetIdx, hitDist and hitInfo are all returned along with the targetEntity that was hit
 	*/
@@ -204,7 +212,7 @@ public:
 		int& targetIdx,
 		float& hitDist, 
 		Model::HitInfo& hitInfo, 
-		Array<shared_ptr<Entity>>& dontHit,
+		const Array<shared_ptr<Entity>>& dontHit,
 		bool dummyShot);
 
 	// Records provided lastFireTime 
@@ -214,7 +222,8 @@ public:
 	// Computes an integer number of shots that can happen until given currentTime
 	int numShotsUntil(RealTime currentTime);
 
-	void onPose(Array<shared_ptr<Surface> >& surface);
+	/** Pose the view model (kicking as of the time provided) */
+	void onPose(Array<shared_ptr<Surface> >& surface, RealTime now = System::time());
 
 	void loadSounds() {
 		// Check for play mode specific parameters
@@ -229,6 +238,8 @@ public:
 	void setMissCallback(std::function<void(void)> callback) { m_missCallback = callback; }
 	
 	void setConfig(WeaponConfig* config) { m_config = config; }
+	/** Set the stream fire spread is drawn from */
+	void setRandomStream(const RandomStream& rng) { m_rand = rng; }
 	void setCamera(const shared_ptr<Camera>& cam) { m_camera = cam; }
 	void setScene(const shared_ptr<Scene>& scene) { m_scene = scene; }
 	void setScoped(bool state = true) { m_scoped = state; }
@@ -240,4 +251,8 @@ public:
 	void loadModels();
 
 	bool scoped() { return m_scoped;  }
+
+	const Array<shared_ptr<Projectile>>& projectiles() const { return m_projectiles; }
+	int projectileCount() const { return m_projectiles.size(); }
+	int decalCount() const { return m_currentMissDecals.size() + (notNull(m_hitDecal) ? 1 : 0); }
 };
\ No newline at end of file
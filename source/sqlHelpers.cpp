@@ -1,4 +1,5 @@
 #include "sqlHelpers.h"
+#include "TextLogSink.h"
 
 
 bool createTableInDB(sqlite3* db, String tableName, Array<Array<String>> columns) {
@@ -17,18 +18,18 @@ bool createTableInDB(sqlite3* db, String tableName, Array<Array<String>> columns
 			createTableC += ");";
 		}
 	}
-	logPrintf("Creating table %s w/ SQL query:%s\n\n", tableName.c_str(), createTableC.c_str());
+	logPrintfAsync("Creating table %s w/ SQL query:%s\n\n", tableName.c_str(), createTableC.c_str());
 	char* errmsg;
 	int ret = sqlite3_exec(db, createTableC.c_str(), 0, 0, &errmsg);
 	if (ret != SQLITE_OK) {
-		logPrintf("Error in CREATE TABLE statement (%s): %s\n", createTableC, errmsg);
+		logPrintfAsync("Error in CREATE TABLE statement (%s): %s\n", createTableC, errmsg);
 	}
 	return ret == SQLITE_OK;
 }
 
 bool insertRowIntoDB(sqlite3* db, String tableName, Array<String> values, String colNames) {
 	if (values.length() == 0) {
-		logPrintf("Warning insert row with empty values ignored!\n");
+		logPrintfAsync("Warning insert row with empty values ignored!\n");
 		return false;	// Don't attempt to insert for empty values
 	}
 	// Quotes must be added around text-type values (eg. "addQuotes(expVersion)")
@@ -39,18 +40,18 @@ bool insertRowIntoDB(sqlite3* db, String tableName, Array<String> values, String
 		if(i < values.size() - 1) insertC += ",";
 	}
 	insertC += ");";
-	//logPrintf("Inserting row into %s table w/ SQL query:%s\n\n", tableName.c_str(), insertC.c_str());
+	//logPrintfAsync("Inserting row into %s table w/ SQL query:%s\n\n", tableName.c_str(), insertC.c_str());
 	char* errmsg;
 	int ret = sqlite3_exec(db, insertC.c_str(), 0, 0, &errmsg);
 	if (ret != SQLITE_OK) {
-		logPrintf("Error in INSERT INTO statement (%s): %s\n", insertC, errmsg);
+		logPrintfAsync("Error in INSERT INTO statement (%s): %s\n", insertC, errmsg);
 	}
 	return ret == SQLITE_OK;
 }
 
 bool insertRowsIntoDB(sqlite3* db, String tableName, Array<Array<String>> value_vector, String colNames) {
 	if (value_vector.length() == 0) {
-		logPrintf("Warning insert rows with empty row value array ignored!\n");
+		logPrintfAsync("Warning insert rows with empty row value array ignored!\n");
 		return false;		// Don't insert for empty value vector (creates an error)
 	}
 	// Quotes must be added around text-type values
@@ -70,11 +71,11 @@ bool insertRowsIntoDB(sqlite3* db, String tableName, Array<Array<String>> value_
 			insertC += ";";
 		}
 	}
-	//logPrintf("Inserting rows into %s table with SQL query:%s\n\n", tableName.c_str(), insertC.c_str());
+	//logPrintfAsync("Inserting rows into %s table with SQL query:%s\n\n", tableName.c_str(), insertC.c_str());
 	char* errmsg;
 	int ret = sqlite3_exec(db, insertC.c_str(), 0, 0, &errmsg);
 	if (ret != SQLITE_OK) {
-		logPrintf("Error in INSERT INTO statement (%s): %s\n", insertC, errmsg);
+		logPrintfAsync("Error in INSERT INTO statement (%s): %s\n", insertC, errmsg);
 	}
 	return ret == SQLITE_OK;
 }
@@ -85,6 +85,7 @@ void FPSciTests::SetUpTestSuiteSafe() {
 	// Set up per-frame fake input
 	s_fakeInput = std::make_shared<TestFakeInput>(s_app, s_app->currentUser()->mouseDPI);
 	s_fakeInput->defocusOriginalWindow();
+	s_fakeInput->setTimedInputQueue(&s_app->timedInput());
 	s_app->addWidget(s_fakeInput);
 
 	// Prime the app and load the scene
@@ -234,7 +235,7 @@ TEST_F(FPSciTests, InitialTestConditions) {
 	ASSERT_TRUE(notNull(player));
 
 	// Default config properties
-	EXPECT_FALSE(s_app->sessConfig->weapon.autoFire);
+	EXPECT_FALSE(s_app->sessConfig->weapon->autoFire);
 }
 
 TEST_F(FPSciTests, UsingFixedTimestep) {
@@ -320,6 +321,42 @@ TEST_F(FPSciTests, KillTargetFrontHoldclick) {
 	s_app->oneFrame();
 }
 
+TEST_F(FPSciTests, KillTargetFrontTimedClick) {
+	EXPECT_EQ(s_app->sess->currentState, PresentationState::trialTask);
+
+	int spawnedTargets = respawnTargets();
+
+	// Kill the front target w/ a timestamped click (press and release both before the next frame)
+	zeroCameraRotation();
+	const RealTime now = System::time();
+	s_fakeInput->injectTimedMouseDown(now - 0.002);
+	s_fakeInput->injectTimedMouseUp(now - 0.001);
+	s_app->oneFrame();
+
+	bool aliveFront, aliveRight;
+	checkTargets(aliveFront, aliveRight);
+	EXPECT_FALSE(aliveFront) << "Front target should not remain (should have been destroyed)!";
+	EXPECT_TRUE(aliveRight) << "Right target should remain (should not have been destroyed)!";
+	EXPECT_EQ(s_app->sess->targetArray().size(), spawnedTargets - 1) << format("We shot once (and hit a target). There should be %d targets left.", spawnedTargets - 1).c_str();
+	EXPECT_TRUE(s_app->timedInput().empty());
+}
+
+TEST_F(FPSciTests, LateLatchMatchesViewRotation) {
+	auto player = getPlayer();
+	zeroCameraRotation();
+	const CFrame before = player->getCameraFrame();
+	EXPECT_TRUE(player->getRotatedCameraFrame(0.f, 0.f).fuzzyEq(before));
+
+	// The late latched camera frame should match the frame the player rotates to once the same motion is simulated
+	const CFrame latched = player->getRotatedCameraFrame(0.1f, 0.05f);
+	EXPECT_EQ(latched.translation, before.translation) << "Late latching should not move the camera!";
+	player->setDesiredAngularVelocity(0.1f, 0.05f);
+	player->applyViewRotation();
+	EXPECT_TRUE(latched.fuzzyEq(player->getCameraFrame()));
+
+	zeroCameraRotation();
+}
+
 TEST_F(FPSciTests, KillTargetRightRotate) {
 	EXPECT_EQ(s_app->sess->currentState, PresentationState::trialTask);
 
@@ -471,9 +508,9 @@ TEST_F(FPSciTests, TestAutoFire) {
 	const float damagePerFrame = 0.1f;
 	const float firePeriod = (float)fixedTestDeltaTime() - 0.001f;
 
-	s_app->sessConfig->weapon.autoFire = true;
-	s_app->sessConfig->weapon.damagePerSecond = damagePerFrame / firePeriod;
-	s_app->sessConfig->weapon.firePeriod = firePeriod;
+	s_app->sessConfig->weapon->autoFire = true;
+	s_app->sessConfig->weapon->damagePerSecond = damagePerFrame / firePeriod;
+	s_app->sessConfig->weapon->firePeriod = firePeriod;
 
 	s_app->oneFrame();
 
@@ -493,7 +530,7 @@ TEST_F(FPSciTests, TestAutoFire) {
 	}
 	EXPECT_TRUE(frontAlive) << "Low damage-per-second with auto-fire but target still died";
 
-	s_app->sessConfig->weapon.autoFire = false;
+	s_app->sessConfig->weapon->autoFire = false;
 }
 
 
@@ -728,3 +765,768 @@ TEST_F(FPSciTests, TestWeapon60Hz16ms) {
 	EXPECT_NEAR(end - start, 1, 0.017) << "Failed to be within a frame of the expected end time!";
 	ASSERT_NEAR(numFrames, 60, 1) << "Wrong number of frames taken.";
 }
+
+TEST(SessionJournalTests, ResumeFromLastTrial) {
+	const String filename = "test_session.journal";
+	SessionJournal::State header;
+	header.sessionId = "journalSession";
+	header.userId = "journalUser";
+	header.seed = 1234;
+	header.dbFilename = "results/journalSession_journalUser";
+	header.startTime = "2021-01-01 12:00:00.000";
+	{
+		SessionJournal journal;
+		journal.begin(filename, header);
+		journal.recordTrial(1, 1, { 0, 1 }, { 2, 1 });
+		journal.recordTrial(0, 1, { 1, 1 }, { 1, 1 });
+	}
+
+	SessionJournal::State state = SessionJournal::load(filename);
+	EXPECT_TRUE(state.resumable());
+	EXPECT_EQ(state.sessionId, header.sessionId);
+	EXPECT_EQ(state.userId, header.userId);
+	EXPECT_EQ(state.seed, header.seed);
+	EXPECT_EQ(state.dbFilename, header.dbFilename);
+	EXPECT_EQ(state.startTime, header.startTime);
+	EXPECT_EQ(state.trialOrder, Array<int>({ 1, 0 }));
+	EXPECT_EQ(state.completedTrials, Array<int>({ 1, 1 }));
+	EXPECT_EQ(state.remainingTrials, Array<int>({ 1, 1 }));
+
+	// A completed session should not be resumed
+	{
+		SessionJournal journal;
+		journal.resume(filename);
+		journal.markComplete();
+	}
+	EXPECT_FALSE(SessionJournal::load(filename).resumable());
+
+	// Neither should a session the user switched away from
+	{
+		SessionJournal journal;
+		journal.begin(filename, header);
+		journal.recordTrial(0, 1, { 1, 0 }, { 1, 2 });
+		journal.markAbandoned();
+	}
+	EXPECT_FALSE(SessionJournal::load(filename).resumable());
+	FileSystem::removeFile(filename);
+}
+
+/** Fake clock for frame pacer tests, sleeps oversleep by a random amount up to maxOversleep */
+class FakePacerClock : public FramePacer::Clock {
+public:
+	RealTime time = 0.0;
+	RealTime maxOversleep = 0.0;
+	RealTime spinStep = 1e-6;
+	Random rand;
+
+	FakePacerClock() : rand(1234, false) {}
+
+	RealTime now() override { return time; }
+	void sleep(RealTime duration) override { time += duration + rand.uniform(0.f, (float)maxOversleep); }
+	void spin() override { time += spinStep; }
+};
+
+TEST(FramePacerTests, SubHundredMicrosecondError240Hz) {
+	shared_ptr<FakePacerClock> clock = std::make_shared<FakePacerClock>();
+	clock->maxOversleep = 0.0015;			// Up to 1.5ms of sleep overshoot (coarse OS timer)
+	FramePacer pacer(clock);
+	pacer.setMinSpinTime(0.002);
+
+	const RealTime period = 1.0 / 240.0;
+	RealTime deadline = 0.0;
+	for (int i = 0; i < 1000; i++) {
+		clock->time += 0.0002;				// Simulated frame work
+		deadline += period;
+		pacer.waitUntil(deadline);
+		EXPECT_LT(G3D::abs(pacer.lastError()), 100e-6) << "Frame " << i << " missed its deadline by more than 100us!";
+	}
+	EXPECT_EQ(pacer.stats().frames, 1000);
+	EXPECT_LT(pacer.stats().maxUs, 100.f);
+}
+
+TEST(FramePacerTests, SpinWindowAdaptsToOversleep) {
+	shared_ptr<FakePacerClock> clock = std::make_shared<FakePacerClock>();
+	clock->maxOversleep = 0.004;			// Oversleep is larger than the minimum spin window
+	FramePacer pacer(clock);
+	pacer.setMinSpinTime(0.001);
+
+	const RealTime period = 1.0 / 60.0;
+	RealTime deadline = 0.0;
+	// Warm up (the pacer may be late while it learns the oversleep)
+	for (int i = 0; i < 100; i++) {
+		clock->time += 0.001;
+		deadline = max(deadline + period, clock->time);
+		pacer.waitUntil(deadline);
+	}
+	EXPECT_GT(pacer.spinTime(), 0.001);
+	pacer.resetStats();
+	for (int i = 0; i < 1000; i++) {
+		clock->time += 0.0002;
+		deadline += period;
+		pacer.waitUntil(deadline);
+	}
+	EXPECT_LT(pacer.stats().maxUs, 100.f);
+}
+
+TEST(FixedTimestepTests, StepsIndependentOfFrameRate) {
+	const float simRate = 120.f;
+	for (float frameRate : { 30.f, 60.f, 144.f, 240.f, 1000.f }) {
+		FixedTimestep timestep;
+		timestep.setRate(simRate);
+		int steps = 0;
+		const int frames = (int)frameRate * 2;		// 2s of frames
+		for (int i = 0; i < frames; i++) {
+			steps += timestep.advance(1.0 / frameRate);
+			EXPECT_GE(timestep.alpha(), 0.f);
+			EXPECT_LT(timestep.alpha(), 1.f);
+		}
+		EXPECT_NEAR(steps, 2 * (int)simRate, 1) << "Wrong step count at " << frameRate << "Hz!";
+	}
+}
+
+TEST(FixedTimestepTests, StepsPerFrameAreBounded) {
+	FixedTimestep timestep;
+	timestep.setRate(60.f);
+	EXPECT_EQ(timestep.advance(1.0), FixedTimestep::DefaultMaxStepsPerFrame);		// Long (1s) frame
+	EXPECT_LT(timestep.alpha(), 1.f);
+	EXPECT_LE(timestep.advance(1.0 / 60.0), 2);									// Dropped time doesn't carry over
+
+	// Disabled (0Hz) steps once per frame
+	timestep.setRate(0.f);
+	EXPECT_FALSE(timestep.enabled());
+	EXPECT_EQ(timestep.advance(1.0 / 60.0), 1);
+}
+
+TEST(SimulationThreadTests, StepsAtFixedRateWithoutRenderLoop) {
+	SimulationThread simThread;
+	int steps = 0;
+	SimTime simulated = 0.0;
+	simThread.start(500.f, [&](SimTime step) { steps++; simulated += step; });
+	ASSERT_TRUE(simThread.running());
+	System::sleep(0.25);
+	simThread.stop();
+	EXPECT_FALSE(simThread.running());
+
+	// Steps happen on their own (no frames are rendered here), at roughly the requested rate
+	EXPECT_GT(steps, 60);
+	EXPECT_LT(steps, 200);
+	EXPECT_NEAR(simulated, steps * 0.002, 1e-9);
+	EXPECT_EQ(simThread.stepCount(), steps);
+}
+
+TEST(QualityControllerTests, StepsThroughLadderWithHysteresis) {
+	const RealTime target = 1.0 / 100.0;			// 10ms budget
+	QualityController::Settings settings;
+	settings.downgradeThreshold = 0.9f;
+	settings.upgradeThreshold = 0.6f;
+	settings.windowFrames = 10;
+	settings.upgradeFrames = 50;
+	QualityController controller;
+	controller.configure(QualityLevel::defaultLadder(), settings, target);
+	ASSERT_TRUE(controller.enabled());
+	EXPECT_EQ(controller.level(), 0);
+
+	// Slow frames (12ms) step down one level per (full) window
+	int changes = 0;
+	for (int i = 0; i < 25; i++) {
+		if (controller.addFrameTime(0.012f)) changes++;
+	}
+	EXPECT_EQ(changes, 2);
+	EXPECT_EQ(controller.level(), 2);
+
+	// Frames in the hysteresis band (7.5ms) hold the current level
+	for (int i = 0; i < 200; i++) {
+		EXPECT_FALSE(controller.addFrameTime(0.0075f));
+	}
+	EXPECT_EQ(controller.level(), 2);
+
+	// Fast frames (4ms) step up only after a full window + the upgrade run
+	int frames = 0;
+	while (!controller.addFrameTime(0.004f)) { frames++; }
+	EXPECT_EQ(frames + 1, settings.windowFrames - 1 + settings.upgradeFrames);
+	EXPECT_EQ(controller.level(), 1);
+
+	// Sustained slow frames bottom out at the lowest level
+	for (int i = 0; i < 1000; i++) controller.addFrameTime(0.05f);
+	EXPECT_EQ(controller.level(), controller.levelCount() - 1);
+	EXPECT_FALSE(controller.current().shadows);
+
+	// A 0 target disables the controller
+	controller.configure(QualityLevel::defaultLadder(), settings, 0.0);
+	EXPECT_FALSE(controller.enabled());
+	EXPECT_FALSE(controller.addFrameTime(1.0f));
+	EXPECT_EQ(controller.level(), 0);
+}
+
+TEST(LatencyTrackerTests, FollowsShotsThroughFrameDelay) {
+	LatencyTracker tracker;
+	tracker.setEnabled(true);
+	tracker.setFrameDelay(2);
+	Array<ShotLatency> shots;
+
+	// A press that doesn't fire is dropped
+	tracker.onInput(0.000);
+	tracker.onSimulated(0.001, false);
+	tracker.onRendered(0.002, 0.004);
+	for (int i = 0; i < 4; i++) tracker.onPresent(0.005 + i * 0.01);
+	tracker.takeCompleted(shots);
+	EXPECT_EQ(shots.size(), 0);
+
+	// A press that fires is presented by the 3rd swap after it is rendered (2 frame delay)
+	tracker.onInput(1.000);
+	tracker.onSimulated(1.001, true);
+	tracker.onRendered(1.0005, 1.004);			// Started rendering before the shot fired (not included)
+	tracker.onPresent(1.005);
+	tracker.onRendered(1.010, 1.013);
+	tracker.onPresent(1.015);
+	tracker.onPresent(1.025);
+	tracker.takeCompleted(shots);
+	EXPECT_EQ(shots.size(), 0);
+	tracker.onPresent(1.035);
+	tracker.takeCompleted(shots);
+	ASSERT_EQ(shots.size(), 1);
+	EXPECT_NEAR(shots[0].inputToFire(), 0.001, 1e-9);
+	EXPECT_NEAR(shots[0].fireToRender(), 0.012, 1e-9);
+	EXPECT_NEAR(shots[0].renderToPresent(), 0.022, 1e-9);
+	EXPECT_NEAR(shots[0].total(), 0.035, 1e-9);
+	EXPECT_EQ(shots[0].frameDelay, 2);
+
+	// Nothing is tracked when disabled
+	tracker.setEnabled(false);
+	tracker.onInput(2.0);
+	tracker.onSimulated(2.001, true);
+	tracker.onRendered(2.002, 2.003);
+	tracker.onPresent(2.004);
+	tracker.takeCompleted(shots);
+	EXPECT_EQ(shots.size(), 0);
+}
+
+TEST(TimedInputQueueTests, PopsEventsReceivedByTime) {
+	TimedInputQueue queue;
+	TimedInputEvent e;
+	EXPECT_TRUE(queue.empty());
+	EXPECT_FALSE(queue.popUntil(10.0, e));
+
+	queue.push(TimedInputEvent(TimedInputEvent::ButtonDown, GKey::LEFT_MOUSE, 1.0));
+	queue.push(TimedInputEvent(TimedInputEvent::ButtonUp, GKey::LEFT_MOUSE, 2.0));
+
+	// Events received after the provided time stay queued
+	EXPECT_FALSE(queue.popUntil(0.5, e));
+	ASSERT_TRUE(queue.popUntil(1.5, e));
+	EXPECT_EQ(e.type, TimedInputEvent::ButtonDown);
+	EXPECT_EQ(e.time, 1.0);
+	EXPECT_FALSE(queue.popUntil(1.5, e));
+	ASSERT_TRUE(queue.popUntil(2.0, e));
+	EXPECT_EQ(e.type, TimedInputEvent::ButtonUp);
+	EXPECT_TRUE(queue.empty());
+
+	// Events are dropped (and counted) once the queue is full
+	for (int i = 0; i < TimedInputQueue::Capacity; i++) {
+		EXPECT_TRUE(queue.push(TimedInputEvent(TimedInputEvent::ButtonDown, GKey::LEFT_MOUSE, 3.0 + i)));
+	}
+	EXPECT_FALSE(queue.push(TimedInputEvent(TimedInputEvent::ButtonDown, GKey::LEFT_MOUSE, 0.0)));
+	EXPECT_EQ(queue.dropped(), 1u);
+	ASSERT_TRUE(queue.popUntil(3.0, e));
+	EXPECT_EQ(e.time, 3.0);
+	EXPECT_TRUE(queue.push(TimedInputEvent(TimedInputEvent::ButtonDown, GKey::LEFT_MOUSE, 0.0)));
+}
+
+TEST(StateDelayQueueTests, DelaysSnapshotsByFrames) {
+	StateDelayQueue queue;
+	queue.setDelay(2);
+
+	// Until the queue fills the oldest captured snapshot is presented, then each snapshot is presented 2 frames later
+	const float expected[] = { 0.f, 0.f, 0.f, 1.f, 2.f, 3.f };
+	const int expectedLag[] = { 0, 1, 2, 2, 2, 2 };
+	for (int frame = 0; frame < 6; frame++) {
+		queue.next().camera = CFrame(Point3((float)frame, 0.f, 0.f));
+		const StateSnapshot& delayed = queue.advance();
+		EXPECT_EQ(delayed.camera.translation.x, expected[frame]) << format("Frame %d", frame).c_str();
+		EXPECT_EQ(queue.currentLag(), expectedLag[frame]);
+		EXPECT_EQ(queue.current().camera.translation.x, (float)frame);
+	}
+
+	// Changing the delay starts over from the next snapshot
+	queue.setDelay(1);
+	queue.next().camera = CFrame(Point3(10.f, 0.f, 0.f));
+	EXPECT_EQ(queue.advance().camera.translation.x, 10.f);
+	queue.next().camera = CFrame(Point3(11.f, 0.f, 0.f));
+	EXPECT_EQ(queue.advance().camera.translation.x, 10.f);
+	queue.next().camera = CFrame(Point3(12.f, 0.f, 0.f));
+	EXPECT_EQ(queue.advance().camera.translation.x, 11.f);
+
+	// Without delay the current snapshot is presented
+	queue.setDelay(0);
+	queue.next().camera = CFrame(Point3(20.f, 0.f, 0.f));
+	EXPECT_EQ(queue.advance().camera.translation.x, 20.f);
+	EXPECT_EQ(queue.currentLag(), 0);
+}
+
+TEST(ExperimentConfigTests, IndexedLookupsScaleTo10kSessions) {
+	const int sessionCount = 10000;
+	const int targetCount = 10000;
+	const FpsConfig defaultConfig = SessionConfig::defaultConfig();		// Loading an experiment replaces the default session config
+
+	// Generate an experiment w/ 10k sessions, each using 3 of 10k target types
+	Any targets(Any::ARRAY);
+	for (int i = 0; i < targetCount; i++) {
+		Any target(Any::TABLE);
+		target["id"] = format("target%d", i);
+		targets.append(target);
+	}
+	Any sessions(Any::ARRAY);
+	for (int i = 0; i < sessionCount; i++) {
+		Any trial(Any::TABLE);
+		trial["ids"] = Array<String>({ format("target%d", i), format("target%d", (i + 1) % targetCount), format("target%d", i) });
+		trial["count"] = 2;
+		Any session(Any::TABLE);
+		session["id"] = format("session%d", i);
+		session["trials"] = Array<Any>({ trial });
+		sessions.append(session);
+	}
+	Any experiment(Any::TABLE);
+	experiment["targets"] = targets;
+	experiment["sessions"] = sessions;
+
+	RealTime start = System::time();
+	const ExperimentConfig config(experiment);
+	const RealTime loadTime = System::time() - start;
+
+	start = System::time();
+	EXPECT_TRUE(config.validate(false));
+	const RealTime validateTime = System::time() - start;
+
+	start = System::time();
+	for (int i = 0; i < sessionCount; i++) {
+		const String id = format("session%d", i);
+		ASSERT_EQ(config.getSessionIndex(id), i);
+		const Array<Array<shared_ptr<const TargetConfig>>> trials = config.getTargetsByTrial(i);
+		ASSERT_EQ(trials.size(), 1);
+		ASSERT_EQ(trials[0].size(), 3);
+		EXPECT_EQ(trials[0][0]->id, format("target%d", i));
+		EXPECT_EQ(config.getSessionTargets(id).size(), 2);
+	}
+	const RealTime lookupTime = System::time() - start;
+
+	// Report the times (in ms) w/ the test results, and catch a return to linear scans (10k^2 lookups take far longer)
+	RecordProperty("loadMs", (int)(loadTime * 1000));
+	RecordProperty("validateMs", (int)(validateTime * 1000));
+	RecordProperty("lookupMs", (int)(lookupTime * 1000));
+	EXPECT_LT(lookupTime, 10.0);
+
+	// Target lookups share a single (immutable) config instead of copying it
+	EXPECT_EQ(config.getTargetConfigById("target42").get(), config.getTargetConfigById("target42").get());
+	EXPECT_EQ(config.getTargetConfigById("missing"), nullptr);
+	EXPECT_EQ(config.getSessionConfigById("missing"), nullptr);
+	EXPECT_EQ(config.getSessionConfigById("session9999")->id, "session9999");
+
+	// A missing target is reported by validate()
+	ExperimentConfig invalid = config;
+	invalid.sessions[sessionCount / 2].trials[0].ids.append("missing");
+	EXPECT_FALSE(invalid.validate(false));
+
+	// As is an unknown variable in a session's feedback message (when the experiment is loaded, not when the session starts)
+	ExperimentConfig badFeedback = config;
+	badFeedback.sessions[sessionCount - 1].feedback.mutate().trialSuccess = "%trialShotHit hits";
+	EXPECT_FALSE(badFeedback.validate(false));
+	EXPECT_THROW(badFeedback.validate(true), String);
+
+	SessionConfig::defaultConfig() = defaultConfig;
+}
+
+TEST(ExperimentConfigTests, SessionsShareUnmodifiedSubConfigs) {
+	const FpsConfig defaultConfig = SessionConfig::defaultConfig();		// Loading an experiment replaces the default session config
+
+	// Every other session overrides the frame rate (a render field), the rest only set session fields
+	Any sessions(Any::ARRAY);
+	for (int i = 0; i < 100; i++) {
+		Any trial(Any::TABLE);
+		trial["ids"] = Array<String>({ "target" });
+		Any session(Any::TABLE);
+		session["id"] = format("session%d", i);
+		session["trials"] = Array<Any>({ trial });
+		if (i % 2 == 1) session["frameRate"] = 60.0f;
+		sessions.append(session);
+	}
+	Any target(Any::TABLE);
+	target["id"] = "target";
+	Any experiment(Any::TABLE);
+	experiment["frameDelay"] = 2;
+	experiment["targets"] = Array<Any>({ target });
+	experiment["sessions"] = sessions;
+	const ExperimentConfig config(experiment);
+
+	const SessionConfig& base = config.sessions[0];
+	for (int i = 0; i < config.sessions.size(); i++) {
+		const SessionConfig& sess = config.sessions[i];
+		EXPECT_TRUE(sess.hud.shares(base.hud));
+		EXPECT_TRUE(sess.weapon.shares(base.weapon));
+		EXPECT_TRUE(sess.logger.shares(base.logger));
+		EXPECT_EQ(sess.render.shares(base.render), i % 2 == 0);
+		// Overridden sub-configs still inherit the experiment's other fields
+		EXPECT_EQ(sess.render->frameDelay, 2);
+		EXPECT_EQ(sess.render->frameRate, (i % 2 == 1) ? 60.0f : RenderConfig().frameRate);
+	}
+
+	// Modifying a (copied) session only copies the modified sub-config
+	shared_ptr<SessionConfig> sess = config.getSessionConfigById("session0");
+	const SessionConfig& copy = *sess;
+	EXPECT_TRUE(copy.render.shares(base.render));
+	sess->render->frameRate = 30.0f;
+	EXPECT_FALSE(copy.render.shares(base.render));
+	EXPECT_TRUE(copy.hud.shares(base.hud));
+	EXPECT_EQ(base.render->frameRate, RenderConfig().frameRate);
+
+	// Round trip is unchanged by sharing
+	const ExperimentConfig reloaded(config.toAny());
+	EXPECT_EQ(reloaded.toAny(), config.toAny());
+	EXPECT_EQ(reloaded.toAny(true), config.toAny(true));
+
+	SessionConfig::defaultConfig() = defaultConfig;
+}
+
+TEST(TrialScheduleTests, SeedReproducesSchedule) {
+	shared_ptr<TargetConfig> world = std::make_shared<TargetConfig>();
+	world->id = "world";
+	world->size = { 0.1f, 0.5f };
+	world->spawnBounds = AABox(Point3(-1, -1, -1), Point3(1, 1, 1));
+	shared_ptr<TargetConfig> player = std::make_shared<TargetConfig>();
+	player->id = "player";
+	player->destSpace = "player";
+	const Array<Array<shared_ptr<const TargetConfig>>> targets = { { world }, { world, player }, { player } };
+	const Array<int> counts = { 3, 2, 1 };
+
+	TrialSchedule a, b, c;
+	a.compile(counts, 2, targets, 1234);
+	b.compile(counts, 2, targets, 1234);
+	c.compile(counts, 2, targets, 4321);
+
+	// Each block runs every trial its count times
+	ASSERT_TRUE(a.complete());
+	ASSERT_EQ(a.size(), 12);
+	Array<int> runs = { 0, 0, 0 };
+	for (int i = 0; i < a.size(); i++) {
+		const ScheduledTrial* trial = a.trial(i);
+		EXPECT_EQ(trial->block, i < 6 ? 1 : 2);
+		EXPECT_EQ(trial->targets.size(), targets[trial->trialIdx].size());
+		runs[trial->trialIdx]++;
+		for (int j = 0; j < trial->targets.size(); j++) {
+			const ScheduledTarget& target = trial->targets[j];
+			const shared_ptr<const TargetConfig>& config = targets[trial->trialIdx][j];
+			EXPECT_GE(target.size, config->size[0]);
+			EXPECT_LE(target.size, config->size[1]);
+			EXPECT_LE(fabs(target.eccH), config->eccH[1]);
+			if (config->destSpace == "world") EXPECT_TRUE(config->spawnBounds.contains(target.position));
+		}
+	}
+	EXPECT_EQ(runs, Array<int>({ 6, 4, 2 }));
+	EXPECT_EQ(a.trial(a.size()), nullptr);
+
+	// The same seed compiles the same schedule, a different seed (almost certainly) doesn't
+	bool differs = false;
+	ASSERT_EQ(b.size(), a.size());
+	for (int i = 0; i < a.size(); i++) {
+		EXPECT_EQ(a.trial(i)->trialIdx, b.trial(i)->trialIdx);
+		for (int j = 0; j < a.trial(i)->targets.size(); j++) {
+			EXPECT_EQ(a.trial(i)->targets[j].eccH, b.trial(i)->targets[j].eccH);
+			EXPECT_EQ(a.trial(i)->targets[j].eccV, b.trial(i)->targets[j].eccV);
+			EXPECT_EQ(a.trial(i)->targets[j].size, b.trial(i)->targets[j].size);
+			EXPECT_EQ(a.trial(i)->targets[j].position, b.trial(i)->targets[j].position);
+		}
+		differs = differs || (a.trial(i)->trialIdx != c.trial(i)->trialIdx) || (a.trial(i)->targets[0].eccH != c.trial(i)->targets[0].eccH);
+	}
+	EXPECT_TRUE(differs);
+
+	// Unlimited trials compile a lookahead up front, then extend (deterministically) as needed
+	TrialSchedule unlimited;
+	unlimited.compile(Array<int>({ 2, 1, -1 }), 1, targets, 99);
+	EXPECT_FALSE(unlimited.complete());
+	EXPECT_EQ(unlimited.size(), TrialSchedule::Lookahead);
+	ASSERT_NE(unlimited.trial(TrialSchedule::Lookahead + 10), nullptr);
+	EXPECT_EQ(unlimited.size(), TrialSchedule::Lookahead + 11);
+}
+
+TEST(RandomStreamTests, StreamsAreIndependentAndReproducible) {
+	RandomStream a(1234, 7), b(1234, 7), other(1234, 8), interleaved(1234, 8);
+	for (int i = 0; i < 100; i++) {
+		EXPECT_EQ(a.bits64(), b.bits64());
+		const uint64 x = other.bits64();
+		// Drawing from another stream doesn't change this stream's sequence
+		a.bits64();
+		EXPECT_EQ(x, interleaved.bits64());
+	}
+	EXPECT_EQ(a.counter(), 200u);
+	EXPECT_NE(RandomStream(1234, 7).bits64(), RandomStream(1234, 8).bits64());
+	EXPECT_NE(RandomStream(1234, 7).bits64(), RandomStream(1235, 7).bits64());
+
+	RandomStream rng(42);
+	const AABox box(Point3(-1, 0, 2), Point3(1, 3, 4));
+	for (int i = 0; i < 1000; i++) {
+		const float u = rng.uniform(2.0f, 5.0f);
+		EXPECT_GE(u, 2.0f);
+		EXPECT_LE(u, 5.0f);
+		const int n = rng.integer(-3, 3);
+		EXPECT_GE(n, -3);
+		EXPECT_LE(n, 3);
+		EXPECT_TRUE(box.contains(rng.interiorPoint(box)));
+		EXPECT_NEAR(rng.direction().length(), 1.0f, 1e-4f);
+		EXPECT_EQ(fabs(rng.sign()), 1.0f);
+	}
+}
+
+TEST(TextTemplateTests, CompilesAndRendersVariables) {
+	int block = 2;
+	float time = 1.5f;
+	TemplateVariables vars;
+	vars.addInt("currBlock", [&]() { return block; });
+	vars.addInt("currBlockCount", [&]() { return 10; });
+	vars.addFloat("totalTimeLeftS", [&]() { return time; });
+	vars.addString("name", [&]() { return String("test"); });
+
+	String out = "previous contents";
+	const TextTemplate message("Block %currBlock of %currBlockCount (%name), %totalTimeLeftSs left", vars);
+	message.render(vars, out);
+	EXPECT_EQ(out, "Block 2 of 10 (test), 1.50s left");
+	EXPECT_TRUE(message.references("currBlock", vars));
+	EXPECT_FALSE(message.references("missing", vars));
+
+	// Rendering reads the current values
+	block = 3;
+	time = 0.25f;
+	message.render(vars, out);
+	EXPECT_EQ(out, "Block 3 of 10 (test), 0.25s left");
+
+	// Other % characters are kept, %% is kept (and doesn't start a variable reference)
+	TextTemplate("50% done, 100%", vars).render(vars, out);
+	EXPECT_EQ(out, "50% done, 100%");
+	TextTemplate("%%name is %name", vars).render(vars, out);
+	EXPECT_EQ(out, "%%name is test");
+	TextTemplate("", vars).render(vars, out);
+	EXPECT_EQ(out, "");
+
+	// Unknown variables are caught when the template is compiled
+	EXPECT_THROW(TextTemplate("Block %curBlock", vars), String);
+
+	// Unless the template isn't strict (e.g. a command w/ environment variables)
+	TextTemplate("echo %PATH% %name %%name>log.txt", vars, false).render(vars, out);
+	EXPECT_EQ(out, "echo %PATH% test %%name>log.txt");
+}
+
+TEST(ProcessRunnerTests, ReportsExitCodesInOrder) {
+#ifdef G3D_WINDOWS
+	const String exit3 = "cmd /c exit 3";
+	const String exit0 = "cmd /c exit 0";
+#else
+	const String exit3 = "exit 3";
+	const String exit0 = "exit 0";
+#endif
+	ProcessRunner runner;
+	const int first = runner.launch(exit3, false, true, "test", "start of session");
+	const int second = runner.launch(exit0, false, false, "test", "start of session", first);		// Waits for first
+
+	Array<CommandProcess> finished;
+	const RealTime timeout = System::time() + 10.0;
+	while (runner.anyRunning({ first, second }) && System::time() < timeout) {
+		System::sleep(0.01);
+	}
+	runner.takeFinished(finished);
+	ASSERT_EQ(finished.size(), 2);
+	EXPECT_EQ(finished[0].id, first);
+	EXPECT_EQ(finished[0].status, CommandProcess::Status::Exited);
+	EXPECT_EQ(finished[0].exitCode, 3);
+	EXPECT_GE(finished[0].duration(), 0.0);
+	EXPECT_EQ(finished[1].id, second);
+	EXPECT_EQ(finished[1].exitCode, 0);
+	EXPECT_GE(finished[1].launchTime, finished[0].endTime);
+
+	// Terminating a finished (or unknown) process is harmless
+	runner.terminate(first);
+	runner.takeFinished(finished);
+	EXPECT_EQ(finished.size(), 2);
+}
+
+TEST(ProcessRunnerTests, SendsLinesToInput) {
+#ifdef G3D_WINDOWS
+	const String findEnd = "findstr trial_end";
+#else
+	const String findEnd = "grep -q trial_end";
+#endif
+	ProcessRunner runner;
+	const int found = runner.launch(findEnd, false, false, "test", "trial events", -1, true);
+	const int missing = runner.launch(findEnd, false, false, "test", "trial events", -1, true);
+	EXPECT_TRUE(runner.send(found, "t0\ttrial_start\n"));
+	EXPECT_TRUE(runner.send(found, "t1\ttrial_end\n"));
+	EXPECT_TRUE(runner.send(missing, "t0\ttrial_start\n"));
+	runner.closeInput(found);			// Both exit once they read EOF
+	runner.closeInput(missing);
+	EXPECT_FALSE(runner.send(found, "t2\ttrial_start\n"));
+
+	const RealTime timeout = System::time() + 10.0;
+	while (runner.anyRunning({ found, missing }) && System::time() < timeout) {
+		System::sleep(0.01);
+	}
+	Array<CommandProcess> finished;
+	runner.takeFinished(finished);
+	ASSERT_EQ(finished.size(), 2);
+	for (const CommandProcess& p : finished) {
+		EXPECT_EQ(p.status, CommandProcess::Status::Exited);
+		EXPECT_EQ(p.exitCode, (p.id == found) ? 0 : 1);
+	}
+}
+
+TEST(ProcessRunnerTests, StalledInputDoesntBlockOtherProcesses) {
+#ifdef G3D_WINDOWS
+	const String findEnd = "findstr trial_end";
+	const String stall = "ping -n 4 127.0.0.1";
+#else
+	const String findEnd = "grep -q trial_end";
+	const String stall = "sleep 3";
+#endif
+	ProcessRunner runner;
+	// Queue far more input than fits in a pipe for a process that never reads it
+	const int stalled = runner.launch(stall, false, false, "test", "trial events", -1, true);
+	const String line = String(std::string(1023, 'x').c_str()) + "\n";
+	for (int i = 0; i < 1024; i++) {
+		EXPECT_TRUE(runner.send(stalled, line));
+	}
+	const int found = runner.launch(findEnd, false, false, "test", "trial events", -1, true);
+	EXPECT_TRUE(runner.send(found, "t1\ttrial_end\n"));
+	runner.closeInput(found);
+
+	const RealTime timeout = System::time() + 10.0;
+	while (runner.running(found) && System::time() < timeout) {
+		System::sleep(0.01);
+	}
+	EXPECT_FALSE(runner.running(found));
+	EXPECT_TRUE(runner.running(stalled));			// Still waiting (w/ its input queued)
+	runner.terminate(stalled);
+}
+
+TEST(TargetPoolTests, SharesPosesAndCountsMisses) {
+	TargetPool pool;
+	EXPECT_EQ(pool.acquire("target"), nullptr);			// Nothing to reuse yet
+	EXPECT_EQ(pool.created(), 1);
+	EXPECT_EQ(pool.reused(), 0);
+
+	// Targets of the same color share a pose
+	const shared_ptr<ArticulatedModel::Pose> red = pool.pose(Color3::red());
+	EXPECT_EQ(pool.pose(Color3::red()), red);
+	EXPECT_NE(pool.pose(Color3::blue()), red);
+	EXPECT_EQ(pool.size(), 0);
+
+	// Targets created to prewarm the pool aren't counted as spawns
+	pool.setPrewarming(true);
+	EXPECT_EQ(pool.acquire("target"), nullptr);
+	pool.setPrewarming(false);
+	EXPECT_EQ(pool.created(), 1);
+	EXPECT_EQ(pool.prewarmed(), 1);
+}
+
+TEST(TargetPoolTests, ReusedTargetsAreReset) {
+	shared_ptr<TargetConfig> config = std::make_shared<TargetConfig>();
+	config->id = "target";
+	config->destinations.append(Destination(Point3(0, 0, 0), 0.0));
+	config->destinations.append(Destination(Point3(1, 0, 0), 1.0));
+	const shared_ptr<TargetEntity> target = TargetEntity::create(config, "target", nullptr, nullptr, Point3::zero(), 0, 0);
+
+	// Change all the per-spawn state
+	target->doDamage(0.5f);
+	target->setCanHit(false);
+	target->setLogName("target_spawn1");
+	target->rng().bits64();
+
+	TargetPool pool;
+	pool.release(target);
+	EXPECT_TRUE(target->frozen());
+	EXPECT_EQ(pool.acquire("target"), target);
+	EXPECT_EQ(pool.reused(), 1);
+	target->formatLogName("%s_%d_%d", "session", 2, 10);
+	EXPECT_EQ(target->logName(), "session_2_10");
+
+	// Respawn from a config w/ a different path (which clears the log name)
+	shared_ptr<TargetConfig> other = std::make_shared<TargetConfig>(*config);
+	other->destinations[1] = Destination(Point3(0, 1, 0), 2.0);
+	target->reuse(other, nullptr, Point3::zero(), 0, 1);
+	EXPECT_EQ(target->health(), 1.0f);
+	EXPECT_TRUE(target->canHit());
+	EXPECT_FALSE(target->frozen());
+	EXPECT_EQ(target->logName(), target->name());
+	EXPECT_EQ(target->destinations().size(), 2);
+	EXPECT_EQ(target->destinations()[1].position, Point3(0, 1, 0));
+	EXPECT_EQ(target->rng().bits64(), RandomStream().bits64());
+}
+
+TEST(TargetRegistryTests, KeepsHandlesStableAcrossRemoval) {
+	TargetRegistry registry;
+	Array<Destination> dests;
+	dests.append(Destination());
+	Array<shared_ptr<TargetEntity>> targets;
+	Array<TargetHandle> handles;
+	for (int i = 0; i < 4; i++) {
+		targets.append(TargetEntity::create(dests, format("target%d", i), nullptr, nullptr, 0, i));
+		handles.append(registry.add(targets[i], TargetRegistry::Visible | TargetRegistry::Hittable));
+	}
+	EXPECT_EQ(registry.hittable().size(), 4);
+	EXPECT_EQ(registry.all()[2], targets[2]);		// Added in order
+
+	// Deactivating a target moves it to the inactive set (and updates the target)
+	registry.setHittable(handles[1], false);
+	EXPECT_EQ(registry.hittable().size(), 3);
+	EXPECT_EQ(registry.inactive().size(), 1);
+	EXPECT_FALSE(targets[1]->canHit());
+
+	// Removal leaves the other handles valid
+	EXPECT_TRUE(registry.remove(targets[0]));
+	EXPECT_FALSE(registry.remove(targets[0]));
+	EXPECT_FALSE(registry.contains(handles[0]));
+	for (int i = 1; i < 4; i++) {
+		EXPECT_EQ(registry.get(handles[i]), targets[i]);
+		EXPECT_EQ(targets[i]->handle(), handles[i]);
+	}
+	EXPECT_EQ(registry.size(), 3);
+	EXPECT_EQ(registry.hittable().size(), 2);
+
+	// A reused slot gets a new handle
+	const TargetHandle reused = registry.add(targets[0], TargetRegistry::Visible);
+	EXPECT_EQ(reused.slot, handles[0].slot);
+	EXPECT_NE(reused, handles[0]);
+	EXPECT_EQ(registry.inactive().size(), 2);
+}
+
+TEST(TargetEntityTests, FrozenTargetsStartMovingWhenResumed) {
+	Array<Destination> dests;
+	dests.append(Destination(Point3(0, 0, 0), 0.0));
+	dests.append(Destination(Point3(1, 0, 0), 1.0));
+	const shared_ptr<TargetEntity> target = TargetEntity::create(dests, "target", nullptr, nullptr, 0, 0);
+
+	// A frozen (e.g. pre-spawned) target doesn't move
+	target->setFrozen(true);
+	target->onSimulation(10.0, 0.5);
+	EXPECT_EQ(target->frame().translation, Point3(0, 0, 0));
+
+	// Its path starts when it's resumed
+	target->setFrozen(false);
+	target->onSimulation(20.5, 0.5);
+	EXPECT_NE(target->frame().translation, Point3(0, 0, 0));
+}
+
+TEST(StateDelayQueueTests, RestoresFramesAndVisibility) {
+	Array<Destination> dests;
+	dests.append(Destination());
+	const shared_ptr<TargetEntity> target = TargetEntity::create(dests, "target", nullptr, nullptr, 0, 0);
+
+	StateSnapshot snapshot;
+	target->setFrame(Point3(1, 2, 3));
+	snapshot.add(target, target->frame(), target.get());
+	EXPECT_EQ(snapshot.indexOf(target), 0);
+
+	// Hiding (e.g. destroying) and moving the target is undone by applying the snapshot
+	target->setVisible(false);
+	target->setFrame(Point3::zero());
+	snapshot.apply(snapshot.indexOf(target));
+	EXPECT_TRUE(target->visible());
+	EXPECT_EQ(target->frame().translation, Point3(1, 2, 3));
+
+	snapshot.fastClear();
+	EXPECT_EQ(snapshot.indexOf(target), -1);
+}
@@ -246,6 +246,16 @@ void TestFakeInput::queueInput(const FakeInputEvent & input)
 	m_frameInputs.pushBack(input);
 }
 
+void TestFakeInput::injectTimedMouseDown(RealTime time, GKey key)
+{
+	m_timedInput->push(TimedInputEvent(TimedInputEvent::ButtonDown, key, time));
+}
+
+void TestFakeInput::injectTimedMouseUp(RealTime time, GKey key)
+{
+	m_timedInput->push(TimedInputEvent(TimedInputEvent::ButtonUp, key, time));
+}
+
 void TestFakeInput::processGEventQueue()
 {
     GEvent event;
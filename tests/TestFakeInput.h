@@ -1,5 +1,6 @@
 #pragma once
 #include <G3D/G3D.h>
+#include "RawInputThread.h"
 
 // This struct holds hard coded per-frame events to be injected into the app
 struct FakeInputEvent {
@@ -84,6 +85,7 @@ protected:
 	std::shared_ptr<FakeWindow> m_fakeWindow;
 	std::shared_ptr<GApp> m_app;
 	std::shared_ptr<UserInput> m_originalUserInput;
+	TimedInputQueue* m_timedInput = nullptr;
 public:
 	// Replaces the given app's userInput with a fake one
 	TestFakeInput(std::shared_ptr<GApp> app, double mouseDPI);
@@ -96,6 +98,12 @@ public:
 
 	void queueInput(const FakeInputEvent& input);
 
+	// Set the queue timestamped button events are injected into (the test thread becomes its producer)
+	void setTimedInputQueue(TimedInputQueue* queue) { m_timedInput = queue; }
+	// Inject timestamped button events (as if read by the raw input thread at the given System::time())
+	void injectTimedMouseDown(RealTime time, GKey key = GKey::LEFT_MOUSE);
+	void injectTimedMouseUp(RealTime time, GKey key = GKey::LEFT_MOUSE);
+
 	void processGEventQueue();
 
 	virtual void onAfterEvents() override;